@@ -45,28 +45,52 @@
 #if defined (__ICCARM__) || defined (__GNUC__) || defined (__CC_ARM)
 	#include <stdint.h>
 	extern uint32_t SystemCoreClock;
+	extern void rt_stats_init( void );
+	extern uint32_t rt_stats_counter( void );
+	extern uint32_t queue_stats_add( const char* name, uint32_t length );
+	extern void queue_stats_send( uint32_t number, uint32_t waiting, int32_t position );
+	extern void queue_stats_send_failed( uint32_t number );
+	extern void queue_stats_blocked( uint32_t number );
+	extern void queue_stats_receive( uint32_t number );
 #endif
 
 #define configUSE_PREEMPTION			1
 #define configUSE_IDLE_HOOK				0
-#define configUSE_TICK_HOOK				0
+#define configUSE_TICK_HOOK				1	/* keeps the run-time counter extension going */
 #define configCPU_CLOCK_HZ				( SystemCoreClock )
 #define configTICK_RATE_HZ				( ( TickType_t ) 1000 )
 #define configMAX_PRIORITIES			( 5 )
 #define configMINIMAL_STACK_SIZE		( ( unsigned short ) 130 )
-#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 75 * 1024 ) )
+/* Kernel objects are static, only run-time allocations. heap_pool.c takes its arena out of the same budget */
+#ifdef FREERTOS_HEAP_POOL
+#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 4 * 1024 ) - configHEAP_POOL_ARENA_SIZE )
+#else
+#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 4 * 1024 ) )
+#endif
+#define configAPPLICATION_ALLOCATED_HEAP	1	/* ucHeap is defined in main.c, in the .noinit section */
+#define configSUPPORT_STATIC_ALLOCATION	1	/* tasks, queues, timers and semaphores use static storage */
+#define configSUPPORT_DYNAMIC_ALLOCATION	1
 #define configMAX_TASK_NAME_LEN			( 10 )
 #define configUSE_TRACE_FACILITY		1
 #define configUSE_16_BIT_TICKS			0
 #define configIDLE_SHOULD_YIELD			1
 #define configUSE_MUTEXES				1
 #define configQUEUE_REGISTRY_SIZE		8
-#define configCHECK_FOR_STACK_OVERFLOW	0
+#define configCHECK_FOR_STACK_OVERFLOW	2	/* the hook records the task and resets, see stack_mon_task.h */
 #define configUSE_RECURSIVE_MUTEXES		1
 #define configUSE_MALLOC_FAILED_HOOK	0
 #define configUSE_APPLICATION_TASK_TAG	0
 #define configUSE_COUNTING_SEMAPHORES	1
-#define configGENERATE_RUN_TIME_STATS	0
+#define configGENERATE_RUN_TIME_STATS	1
+
+/* Run-time statistics counted with the DWT cycle counter, see rt_stats.h. */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	rt_stats_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()			rt_stats_counter()
+
+/* Size classes of heap_pool.c, only used when it is selected instead of heap_4.c (FREERTOS_HEAP_POOL is defined). */
+#define configHEAP_POOL_BLOCK_SIZES		{ 32, 64, 128, 256 }
+#define configHEAP_POOL_BLOCK_COUNTS	{ 8, 8, 8, 4 }
+#define configHEAP_POOL_ARENA_SIZE		( ( size_t ) 2816 )
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 		0
@@ -91,6 +115,7 @@ to exclude the API function. */
 
 #define INCLUDE_xTaskGetIdleTaskHandle  1
 #define INCLUDE_pxTaskGetStackStart     1
+#define INCLUDE_uxTaskGetStackHighWaterMark	1
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
@@ -129,5 +154,71 @@ standard names. */
 
 #include "SEGGER_SYSVIEW_FreeRTOS.h"
 
+/* Statistics of the registered queues, see queue_stats.h. The SEGGER hooks are kept and the statistics are
+added after them. Queues not in the registry have number 0 and are skipped. traceQUEUE_SEND_FROM_ISR is also
+used by xQueueGiveFromISR, which has no copy position, so sends from interrupts are taken as to the back. */
+#undef traceQUEUE_REGISTRY_ADD
+#undef traceQUEUE_SEND
+#undef traceQUEUE_SEND_FAILED
+#undef traceQUEUE_SEND_FROM_ISR
+#undef traceQUEUE_SEND_FROM_ISR_FAILED
+#undef traceQUEUE_RECEIVE
+#undef traceQUEUE_RECEIVE_FROM_ISR
+
+#define traceQUEUE_REGISTRY_ADD( xQueue, pcQueueName )																	\
+	do{																													\
+		SEGGER_SYSVIEW_RecordU32x2(apiID_OFFSET + apiID_VQUEUEADDTOREGISTRY, SEGGER_SYSVIEW_ShrinkId((U32)xQueue), (U32)pcQueueName);	\
+		if( ( xQueue )->uxQueueNumber == 0 ) ( xQueue )->uxQueueNumber = queue_stats_add( pcQueueName, ( xQueue )->uxLength );	\
+	}while( 0 )
+
+#if ( configUSE_QUEUE_SETS != 1 )
+	#define traceQUEUE_SEND( pxQueue )																					\
+		do{																												\
+			SEGGER_SYSVIEW_RecordU32x4(apiID_OFFSET + apiID_XQUEUEGENERICSEND, SEGGER_SYSVIEW_ShrinkId((U32)pxQueue), (U32)pvItemToQueue, xTicksToWait, xCopyPosition);	\
+			if( ( pxQueue )->uxQueueNumber != 0 ) queue_stats_send( ( pxQueue )->uxQueueNumber, ( pxQueue )->uxMessagesWaiting, xCopyPosition );	\
+		}while( 0 )
+#else
+	#define traceQUEUE_SEND( pxQueue )																					\
+		do{																												\
+			SEGGER_SYSVIEW_RecordU32x4(apiID_OFFSET + apiID_XQUEUEGENERICSEND, SEGGER_SYSVIEW_ShrinkId((U32)pxQueue), 0u, 0u, xCopyPosition);	\
+			if( ( pxQueue )->uxQueueNumber != 0 ) queue_stats_send( ( pxQueue )->uxQueueNumber, ( pxQueue )->uxMessagesWaiting, xCopyPosition );	\
+		}while( 0 )
+#endif
+
+#define traceQUEUE_SEND_FAILED( pxQueue )																				\
+	do{																													\
+		SEGGER_SYSVIEW_RecordU32x4(apiID_OFFSET + apiID_XQUEUEGENERICSEND, SEGGER_SYSVIEW_ShrinkId((U32)pxQueue), (U32)pvItemToQueue, xTicksToWait, xCopyPosition);	\
+		if( ( pxQueue )->uxQueueNumber != 0 ) queue_stats_send_failed( ( pxQueue )->uxQueueNumber );					\
+	}while( 0 )
+
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )																				\
+	do{																													\
+		SEGGER_SYSVIEW_RecordU32x2(apiID_OFFSET + apiID_XQUEUEGENERICSENDFROMISR, SEGGER_SYSVIEW_ShrinkId((U32)pxQueue), (U32)pxHigherPriorityTaskWoken);	\
+		if( ( pxQueue )->uxQueueNumber != 0 ) queue_stats_send( ( pxQueue )->uxQueueNumber, ( pxQueue )->uxMessagesWaiting, queueSEND_TO_BACK );	\
+	}while( 0 )
+
+#define traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue )																		\
+	do{																													\
+		SEGGER_SYSVIEW_RecordU32x2(apiID_OFFSET + apiID_XQUEUEGENERICSENDFROMISR, SEGGER_SYSVIEW_ShrinkId((U32)pxQueue), (U32)pxHigherPriorityTaskWoken);	\
+		if( ( pxQueue )->uxQueueNumber != 0 ) queue_stats_send_failed( ( pxQueue )->uxQueueNumber );					\
+	}while( 0 )
+
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue )																			\
+	do{																													\
+		if( ( pxQueue )->uxQueueNumber != 0 ) queue_stats_blocked( ( pxQueue )->uxQueueNumber );						\
+	}while( 0 )
+
+#define traceQUEUE_RECEIVE( pxQueue )																					\
+	do{																													\
+		SEGGER_SYSVIEW_RecordU32x4(apiID_OFFSET + apiID_XQUEUEGENERICRECEIVE, SEGGER_SYSVIEW_ShrinkId((U32)pxQueue), SEGGER_SYSVIEW_ShrinkId((U32)0), xTicksToWait, 1);	\
+		if( ( pxQueue )->uxQueueNumber != 0 ) queue_stats_receive( ( pxQueue )->uxQueueNumber );						\
+	}while( 0 )
+
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )																			\
+	do{																													\
+		SEGGER_SYSVIEW_RecordU32x3(apiID_OFFSET + apiID_XQUEUERECEIVEFROMISR, SEGGER_SYSVIEW_ShrinkId((U32)pxQueue), SEGGER_SYSVIEW_ShrinkId((U32)pvBuffer), (U32)pxHigherPriorityTaskWoken);	\
+		if( ( pxQueue )->uxQueueNumber != 0 ) queue_stats_receive( ( pxQueue )->uxQueueNumber );						\
+	}while( 0 )
+
 #endif /* FREERTOS_CONFIG_H */
 
@@ -0,0 +1,155 @@
+/********************************************************************************************************//**
+* @file clk_config.h
+*
+* @brief Header file containing the clock tree configuration of the operating points. The resulting
+* frequencies are calculated at compile time and checked against the limits of the STM32F446RE.
+*
+* @note
+*       The dividers are given as real division factors (1, 2, 4...), the values to be written in the RCC
+*       registers are obtained with the CLK_xxx_PRESC macros. Include this file only from C sources, the
+*       checks use _Static_assert.
+*/
+
+#ifndef CLK_CONFIG_H
+#define CLK_CONFIG_H
+
+/***********************************************************************************************************/
+/*                                       Oscillators and device limits                                     */
+/***********************************************************************************************************/
+
+#define CLK_HSE_HZ              8000000U    /**< @brief HSE frequency, MCO of the ST-LINK in bypass mode */
+#define CLK_HSI_HZ              16000000U   /**< @brief HSI frequency */
+
+#define CLK_VCO_IN_MIN_HZ       1000000U    /**< @brief Minimum PLL input frequency */
+#define CLK_VCO_IN_MAX_HZ       2000000U    /**< @brief Maximum PLL input frequency */
+#define CLK_VCO_MIN_HZ          100000000U  /**< @brief Minimum VCO output frequency */
+#define CLK_VCO_MAX_HZ          432000000U  /**< @brief Maximum VCO output frequency */
+#define CLK_HCLK_MAX_HZ         180000000U  /**< @brief Maximum HCLK frequency with over-drive */
+#define CLK_HCLK_MAX_NO_OD_HZ   168000000U  /**< @brief Maximum HCLK frequency without over-drive */
+#define CLK_PCLK1_MAX_HZ        45000000U   /**< @brief Maximum APB1 frequency */
+#define CLK_PCLK2_MAX_HZ        90000000U   /**< @brief Maximum APB2 frequency */
+#define CLK_WS_STEP_HZ          30000000U   /**< @brief HCLK range of each flash wait state at 2.7 - 3.6 V */
+
+/***********************************************************************************************************/
+/*                                       Operating point 180 MHz                                           */
+/***********************************************************************************************************/
+
+#define CLK_OPP180_SRC_HZ       CLK_HSE_HZ  /**< @brief PLL input clock */
+#define CLK_OPP180_PLL_M        4           /**< @brief PLL M division factor */
+#define CLK_OPP180_PLL_N        180         /**< @brief PLL N multiplication factor */
+#define CLK_OPP180_PLL_P        2           /**< @brief PLL P division factor */
+#define CLK_OPP180_AHB_DIV      1           /**< @brief AHB division factor */
+#define CLK_OPP180_APB1_DIV     4           /**< @brief APB1 division factor */
+#define CLK_OPP180_APB2_DIV     2           /**< @brief APB2 division factor */
+#define CLK_OPP180_LATENCY      5           /**< @brief Flash wait states */
+#define CLK_OPP180_OVER_DRIVE   1           /**< @brief 1 if over-drive is needed */
+#define CLK_OPP180_SYSCLK       CLK_PLL_SYSCLK(CLK_OPP180)  /**< @brief System clock */
+
+/***********************************************************************************************************/
+/*                                       Operating point 84 MHz                                            */
+/***********************************************************************************************************/
+
+#define CLK_OPP84_SRC_HZ        CLK_HSE_HZ  /**< @brief PLL input clock */
+#define CLK_OPP84_PLL_M         4           /**< @brief PLL M division factor */
+#define CLK_OPP84_PLL_N         168         /**< @brief PLL N multiplication factor */
+#define CLK_OPP84_PLL_P         4           /**< @brief PLL P division factor */
+#define CLK_OPP84_AHB_DIV       1           /**< @brief AHB division factor */
+#define CLK_OPP84_APB1_DIV      2           /**< @brief APB1 division factor */
+#define CLK_OPP84_APB2_DIV      1           /**< @brief APB2 division factor */
+#define CLK_OPP84_LATENCY       2           /**< @brief Flash wait states */
+#define CLK_OPP84_OVER_DRIVE    0           /**< @brief 1 if over-drive is needed */
+#define CLK_OPP84_SYSCLK        CLK_PLL_SYSCLK(CLK_OPP84)   /**< @brief System clock */
+
+/***********************************************************************************************************/
+/*                                       Operating point 16 MHz                                            */
+/***********************************************************************************************************/
+
+#define CLK_OPP16_AHB_DIV       1           /**< @brief AHB division factor */
+#define CLK_OPP16_APB1_DIV      1           /**< @brief APB1 division factor */
+#define CLK_OPP16_APB2_DIV      1           /**< @brief APB2 division factor */
+#define CLK_OPP16_LATENCY       0           /**< @brief Flash wait states */
+#define CLK_OPP16_OVER_DRIVE    0           /**< @brief 1 if over-drive is needed */
+#define CLK_OPP16_SYSCLK        CLK_HSI_HZ  /**< @brief System clock, PLL is not used */
+
+/***********************************************************************************************************/
+/*                                       Derived frequencies                                               */
+/***********************************************************************************************************/
+
+/** @brief PLL input frequency of an operating point */
+#define CLK_VCO_IN(opp)         (opp##_SRC_HZ / opp##_PLL_M)
+/** @brief VCO output frequency of an operating point */
+#define CLK_VCO(opp)            (CLK_VCO_IN(opp) * opp##_PLL_N)
+/** @brief System clock of an operating point using PLL P output */
+#define CLK_PLL_SYSCLK(opp)     (CLK_VCO(opp) / opp##_PLL_P)
+/** @brief AHB clock of an operating point */
+#define CLK_HCLK(opp)           (opp##_SYSCLK / opp##_AHB_DIV)
+/** @brief APB1 clock of an operating point */
+#define CLK_PCLK1(opp)          (CLK_HCLK(opp) / opp##_APB1_DIV)
+/** @brief APB2 clock of an operating point */
+#define CLK_PCLK2(opp)          (CLK_HCLK(opp) / opp##_APB2_DIV)
+/** @brief Clock of the timers on APB1, twice PCLK1 when the APB1 prescaler is not 1 */
+#define CLK_TIMCLK_APB1(opp)    ((opp##_APB1_DIV == 1) ? CLK_PCLK1(opp) : (2 * CLK_PCLK1(opp)))
+/** @brief Clock of the timers on APB2, twice PCLK2 when the APB2 prescaler is not 1 */
+#define CLK_TIMCLK_APB2(opp)    ((opp##_APB2_DIV == 1) ? CLK_PCLK2(opp) : (2 * CLK_PCLK2(opp)))
+/** @brief Minimum flash wait states for an HCLK frequency */
+#define CLK_MIN_LATENCY(hclk)   (((hclk) - 1) / CLK_WS_STEP_HZ)
+
+/** @brief Timer prescaler register value for getting a counter frequency from a timer clock */
+#define CLK_TIM_PSC(timclk, cnt_hz)         (((timclk) / (cnt_hz)) - 1)
+/** @brief USARTDIV multiplied by 100 with oversampling by 16 */
+#define CLK_USART_DIV(pclk, baud)           ((25U * (pclk)) / (4U * (baud)))
+/** @brief USART BRR value with oversampling by 16, same rounding as USART_SetBaudRate */
+#define CLK_USART_BRR(pclk, baud)           (((CLK_USART_DIV(pclk, baud) / 100U) << 4) |                   \
+                                             ((((CLK_USART_DIV(pclk, baud) % 100U) * 16U + 50U) / 100U) & 0x0FU))
+/** @brief Baud rate obtained with a BRR value calculated by CLK_USART_BRR */
+#define CLK_USART_BAUD(pclk, baud)          ((pclk) / CLK_USART_BRR(pclk, baud))
+/** @brief Baud rate error in tenths of percent with oversampling by 16 */
+#define CLK_USART_ERR(pclk, baud)           ((CLK_USART_BAUD(pclk, baud) > (baud)) ?                        \
+                                             ((CLK_USART_BAUD(pclk, baud) - (baud)) * 1000U / (baud)) :     \
+                                             (((baud) - CLK_USART_BAUD(pclk, baud)) * 1000U / (baud)))
+
+/***********************************************************************************************************/
+/*                                       Register values                                                   */
+/***********************************************************************************************************/
+
+/** @brief AHB prescaler register value from the division factor */
+#define CLK_AHB_PRESC(div)      (((div) == 1) ? 0x00 : ((div) == 2) ? 0x08 : ((div) == 4) ? 0x09 :         \
+                                 ((div) == 8) ? 0x0A : ((div) == 16) ? 0x0B : ((div) == 64) ? 0x0C :        \
+                                 ((div) == 128) ? 0x0D : ((div) == 256) ? 0x0E : 0x0F)
+/** @brief APB prescaler register value from the division factor */
+#define CLK_APB_PRESC(div)      (((div) == 1) ? 0x00 : ((div) == 2) ? 0x04 : ((div) == 4) ? 0x05 :         \
+                                 ((div) == 8) ? 0x06 : 0x07)
+/** @brief PLL P register value from the division factor */
+#define CLK_PLL_P_PRESC(div)    (((div) / 2) - 1)
+
+/***********************************************************************************************************/
+/*                                       Compile-time checks                                               */
+/***********************************************************************************************************/
+
+/** @brief Checks of the PLL configuration of an operating point */
+#define CLK_CHECK_PLL(opp)                                                                                  \
+    _Static_assert((opp##_PLL_M >= 2) && (opp##_PLL_M <= 63), #opp ": PLL M out of range");                 \
+    _Static_assert((opp##_PLL_N >= 50) && (opp##_PLL_N <= 432), #opp ": PLL N out of range");               \
+    _Static_assert((opp##_PLL_P == 2) || (opp##_PLL_P == 4) || (opp##_PLL_P == 6) || (opp##_PLL_P == 8),    \
+                   #opp ": PLL P must be 2, 4, 6 or 8");                                                    \
+    _Static_assert((CLK_VCO_IN(opp) >= CLK_VCO_IN_MIN_HZ) && (CLK_VCO_IN(opp) <= CLK_VCO_IN_MAX_HZ),        \
+                   #opp ": PLL input frequency out of range");                                              \
+    _Static_assert((CLK_VCO(opp) >= CLK_VCO_MIN_HZ) && (CLK_VCO(opp) <= CLK_VCO_MAX_HZ),                    \
+                   #opp ": VCO frequency out of range")
+
+/** @brief Checks of the bus frequencies and flash latency of an operating point */
+#define CLK_CHECK_BUSES(opp)                                                                                \
+    _Static_assert(((opp##_AHB_DIV & (opp##_AHB_DIV - 1)) == 0) && (opp##_AHB_DIV <= 512) &&                \
+                   (opp##_AHB_DIV != 32), #opp ": AHB division factor not valid");                          \
+    _Static_assert(((opp##_APB1_DIV & (opp##_APB1_DIV - 1)) == 0) && (opp##_APB1_DIV <= 16),                \
+                   #opp ": APB1 division factor not valid");                                                \
+    _Static_assert(((opp##_APB2_DIV & (opp##_APB2_DIV - 1)) == 0) && (opp##_APB2_DIV <= 16),                \
+                   #opp ": APB2 division factor not valid");                                                \
+    _Static_assert(CLK_HCLK(opp) <= (opp##_OVER_DRIVE ? CLK_HCLK_MAX_HZ : CLK_HCLK_MAX_NO_OD_HZ),           \
+                   #opp ": HCLK too high");                                                                 \
+    _Static_assert(CLK_PCLK1(opp) <= CLK_PCLK1_MAX_HZ, #opp ": PCLK1 too high");                            \
+    _Static_assert(CLK_PCLK2(opp) <= CLK_PCLK2_MAX_HZ, #opp ": PCLK2 too high");                            \
+    _Static_assert((opp##_LATENCY >= CLK_MIN_LATENCY(CLK_HCLK(opp))) && (opp##_LATENCY <= 15),              \
+                   #opp ": flash latency too low for HCLK")
+
+#endif /* CLK_CONFIG_H */
@@ -0,0 +1,164 @@
+/********************************************************************************************************//**
+* @file app_state.c
+*
+* @brief File containing the APIs for keeping the application state in the backup domain, so it survives
+* resets, and in the flash key-value store, so it also survives power downs.
+*
+* Public Functions:
+*       - uint8_t app_state_init(void)
+*       - uint8_t app_state_rtc_configured(void)
+*       - void    app_state_rtc_set_configured(void)
+*       - void    app_state_get(app_state_t* state)
+*       - void    app_state_set_led(uint8_t effect)
+*       - void    app_state_set_report(uint8_t enable)
+*
+* @note
+*       For further information about functions refer to the corresponding header file.
+*/
+
+#include "app_state.h"
+#include "bkp_driver.h"
+#include "kv_store.h"
+#include "kv_flash_internal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include <stdint.h>
+
+/** @brief Backup register used for marking the RTC calendar as configured */
+#define APP_BKP_REG_RTC         0
+/** @brief Value stored in the backup register when the RTC calendar is configured */
+#define APP_RTC_CONFIGURED      (0x52544300U | APP_STATE_VERSION)
+
+/** @brief Key of the flash store for the LED effect */
+#define APP_KV_LED_EFFECT       0
+/** @brief Key of the flash store for the RTC report */
+#define APP_KV_RTC_REPORT       1
+
+/** @brief Copy in RAM of the application state */
+static app_state_t app_state = {0};
+/** @brief Mutex for serializing the accesses to the flash store */
+static SemaphoreHandle_t kv_mutex = NULL;
+/** @brief Control block of the kv_mutex mutex */
+static StaticSemaphore_t kv_mutex_buffer;
+
+/***********************************************************************************************************/
+/*                                       Static Function Prototypes                                        */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for writing the RAM copy of the application state in the backup SRAM.
+ * @return None
+ */
+static void app_state_save(void);
+
+/**
+ * @brief Function for restoring the application state from the flash store.
+ * @return 0 if at least one value was restored, 1 if not.
+ */
+static uint8_t app_state_load_kv(void);
+
+/**
+ * @brief Function for writing a value in the flash store.
+ * @param[in] key is the key of the value.
+ * @param[in] value is the value to be stored.
+ * @return None
+ */
+static void app_state_store_kv(uint8_t key, uint8_t value);
+
+/***********************************************************************************************************/
+/*                                       Public API Definitions                                            */
+/***********************************************************************************************************/
+
+uint8_t app_state_init(void){
+
+    uint8_t ret = 0;
+
+    BKP_Init();
+
+    kv_mutex = xSemaphoreCreateMutexStatic(&kv_mutex_buffer);
+    configASSERT(kv_mutex != NULL);
+    (void)kv_init(&kv_internal_flash);
+
+    /* The backup SRAM is lost on a power down without VBAT, the flash store is used then */
+    if(BKP_ReadRecord(APP_STATE_VERSION, &app_state, sizeof(app_state))){
+        app_state.led_effect = 0;
+        app_state.rtc_report = 0;
+        ret = app_state_load_kv();
+        app_state_save();
+    }
+
+    return ret;
+}
+
+uint8_t app_state_rtc_configured(void){
+
+    return (BKP_ReadReg(APP_BKP_REG_RTC) == APP_RTC_CONFIGURED);
+}
+
+void app_state_rtc_set_configured(void){
+
+    BKP_WriteReg(APP_BKP_REG_RTC, APP_RTC_CONFIGURED);
+}
+
+void app_state_get(app_state_t* state){
+
+    taskENTER_CRITICAL();
+    *state = app_state;
+    taskEXIT_CRITICAL();
+}
+
+void app_state_set_led(uint8_t effect){
+
+    taskENTER_CRITICAL();
+    app_state.led_effect = effect;
+    app_state_save();
+    taskEXIT_CRITICAL();
+    app_state_store_kv(APP_KV_LED_EFFECT, effect);
+}
+
+void app_state_set_report(uint8_t enable){
+
+    taskENTER_CRITICAL();
+    app_state.rtc_report = enable;
+    app_state_save();
+    taskEXIT_CRITICAL();
+    app_state_store_kv(APP_KV_RTC_REPORT, enable);
+}
+
+/***********************************************************************************************************/
+/*                                       Static Function Definitions                                       */
+/***********************************************************************************************************/
+
+static void app_state_save(void){
+
+    (void)BKP_WriteRecord(APP_STATE_VERSION, &app_state, sizeof(app_state));
+}
+
+static uint8_t app_state_load_kv(void){
+
+    uint8_t ret = 1;
+    uint8_t value;
+    uint16_t len = sizeof(value);
+
+    if(!kv_get(APP_KV_LED_EFFECT, &value, &len)){
+        app_state.led_effect = value;
+        ret = 0;
+    }
+
+    len = sizeof(value);
+    if(!kv_get(APP_KV_RTC_REPORT, &value, &len)){
+        app_state.rtc_report = value;
+        ret = 0;
+    }
+
+    return ret;
+}
+
+static void app_state_store_kv(uint8_t key, uint8_t value){
+
+    /* Flash programming can take long when a sector is erased, it is kept out of the critical section */
+    xSemaphoreTake(kv_mutex, portMAX_DELAY);
+    (void)kv_set(key, &value, sizeof(value));
+    xSemaphoreGive(kv_mutex);
+}
@@ -0,0 +1,76 @@
+/********************************************************************************************************//**
+* @file app_state.h
+*
+* @brief Header file containing the prototypes of the APIs for keeping the application state in the backup
+* domain, so it survives resets, and in the flash key-value store, so it also survives power downs.
+*
+* Public Functions:
+*       - uint8_t app_state_init(void)
+*       - uint8_t app_state_rtc_configured(void)
+*       - void    app_state_rtc_set_configured(void)
+*       - void    app_state_get(app_state_t* state)
+*       - void    app_state_set_led(uint8_t effect)
+*       - void    app_state_set_report(uint8_t enable)
+*/
+
+#ifndef APP_STATE_H
+#define APP_STATE_H
+
+#include <stdint.h>
+
+/** @brief Version of the app_state_t layout, increase it when the structure changes */
+#define APP_STATE_VERSION       1
+
+/**
+ * @brief Structure with the application state kept across resets
+ */
+typedef struct{
+    uint8_t led_effect;     /**< Current LED effect, 0 for none or 1 to 4 */
+    uint8_t rtc_report;     /**< 1 if the RTC report over ITM is enabled */
+}app_state_t;
+
+/***********************************************************************************************************/
+/*                                       APIs Supported                                                    */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for enabling the backup domain and restoring the stored application state.
+ * @return 0 if the state was restored from the backup SRAM or the flash store.
+ *         1 if there was no valid state and the default one is used.
+ */
+uint8_t app_state_init(void);
+
+/**
+ * @brief Function for checking if the RTC calendar was already configured before the last reset.
+ * @return 1 if the RTC is configured, 0 if not.
+ */
+uint8_t app_state_rtc_configured(void);
+
+/**
+ * @brief Function for marking the RTC calendar as configured.
+ * @return None
+ */
+void app_state_rtc_set_configured(void);
+
+/**
+ * @brief Function for getting a copy of the current application state.
+ * @param[out] state is a pointer where the state is copied.
+ * @return None
+ */
+void app_state_get(app_state_t* state);
+
+/**
+ * @brief Function for storing the selected LED effect.
+ * @param[in] effect is the effect number, 0 for none or 1 to 4.
+ * @return None
+ */
+void app_state_set_led(uint8_t effect);
+
+/**
+ * @brief Function for storing if the RTC report is enabled.
+ * @param[in] enable is 1 if the report is enabled, 0 if not.
+ * @return None
+ */
+void app_state_set_report(uint8_t enable);
+
+#endif /* APP_STATE_H */
@@ -0,0 +1,186 @@
+/********************************************************************************************************//**
+* @file clk_scaling.c
+*
+* @brief File containing the APIs for switching the system clock between predefined operating points at run
+* time.
+*
+* Public Functions:
+*       - uint8_t     clk_scaling_set(clk_opp_t opp)
+*       - clk_opp_t   clk_scaling_get(void)
+*
+* @note
+*       For further information about functions refer to the corresponding header file.
+*/
+
+#include "clk_scaling.h"
+#include "clk_config.h"
+#include "rcc_driver.h"
+#include "flash_driver.h"
+#include "pwr_driver.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+
+#define SYST_CSR    (*(volatile uint32_t*)0xE000E010)
+#define SYST_RVR    (*(volatile uint32_t*)0xE000E014)
+#define SYST_CVR    (*(volatile uint32_t*)0xE000E018)
+
+/** @brief Offset of the enable bit in SysTick control and status register */
+#define SYST_CSR_ENABLE     0
+
+/**
+ * @brief Structure with the configuration of an operating point
+ */
+typedef struct{
+    RCC_Config_t rcc;       /**< Clock tree configuration */
+    uint8_t latency;        /**< Flash wait states at 2.7 - 3.6 V */
+    uint8_t over_drive;     /**< 1 if the regulator must be in over-drive mode */
+}clk_opp_cfg_t;
+
+/* Reject out of spec operating points at compile time */
+CLK_CHECK_PLL(CLK_OPP180);
+CLK_CHECK_BUSES(CLK_OPP180);
+CLK_CHECK_PLL(CLK_OPP84);
+CLK_CHECK_BUSES(CLK_OPP84);
+CLK_CHECK_BUSES(CLK_OPP16);
+
+/** @brief Configuration of the operating points, in the same order as clk_opp_t */
+static const clk_opp_cfg_t clk_opp_cfg[CLK_OPP_NUM] = {
+    {
+        .rcc = {.clk_source = RCC_CLK_SOURCE_PLL_P, .pll_source = PLL_SOURCE_HSE,
+                .ahb_presc = CLK_AHB_PRESC(CLK_OPP180_AHB_DIV),
+                .apb1_presc = CLK_APB_PRESC(CLK_OPP180_APB1_DIV),
+                .apb2_presc = CLK_APB_PRESC(CLK_OPP180_APB2_DIV),
+                .pll_n = CLK_OPP180_PLL_N, .pll_m = CLK_OPP180_PLL_M,
+                .pll_p = CLK_PLL_P_PRESC(CLK_OPP180_PLL_P)},
+        .latency = CLK_OPP180_LATENCY,
+        .over_drive = CLK_OPP180_OVER_DRIVE,
+    },
+    {
+        .rcc = {.clk_source = RCC_CLK_SOURCE_PLL_P, .pll_source = PLL_SOURCE_HSE,
+                .ahb_presc = CLK_AHB_PRESC(CLK_OPP84_AHB_DIV),
+                .apb1_presc = CLK_APB_PRESC(CLK_OPP84_APB1_DIV),
+                .apb2_presc = CLK_APB_PRESC(CLK_OPP84_APB2_DIV),
+                .pll_n = CLK_OPP84_PLL_N, .pll_m = CLK_OPP84_PLL_M,
+                .pll_p = CLK_PLL_P_PRESC(CLK_OPP84_PLL_P)},
+        .latency = CLK_OPP84_LATENCY,
+        .over_drive = CLK_OPP84_OVER_DRIVE,
+    },
+    {
+        .rcc = {.clk_source = RCC_CLK_SOURCE_HSI,
+                .ahb_presc = CLK_AHB_PRESC(CLK_OPP16_AHB_DIV),
+                .apb1_presc = CLK_APB_PRESC(CLK_OPP16_APB1_DIV),
+                .apb2_presc = CLK_APB_PRESC(CLK_OPP16_APB2_DIV)},
+        .latency = CLK_OPP16_LATENCY,
+        .over_drive = CLK_OPP16_OVER_DRIVE,
+    },
+};
+
+/** @brief Configuration of HSI as system clock used during the transitions */
+static const RCC_Config_t clk_hsi_cfg = {.clk_source = RCC_CLK_SOURCE_HSI, .ahb_presc = AHB_NO_PRESC,
+                                         .apb1_presc = APB1_NO_PRESC, .apb2_presc = APB2_NO_PRESC};
+
+/** @brief Current operating point */
+static clk_opp_t clk_opp = CLK_OPP_NUM;
+
+/** @brief System core clock used by FreeRTOS */
+extern uint32_t SystemCoreClock;
+
+/***********************************************************************************************************/
+/*                                       Static Function Prototypes                                        */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for applying an operating point.
+ * @param[in] cfg is a pointer to the configuration of the operating point.
+ * @return 0 if OK, 1 if the clock could not be configured.
+ */
+static uint8_t clk_scaling_apply(const clk_opp_cfg_t* cfg);
+
+/**
+ * @brief Function for setting the SysTick reload value for the current system core clock.
+ * @return None
+ */
+static void clk_scaling_systick(void);
+
+/***********************************************************************************************************/
+/*                                       Public API Definitions                                            */
+/***********************************************************************************************************/
+
+uint8_t clk_scaling_set(clk_opp_t opp){
+
+    uint8_t ret;
+
+    if(opp >= CLK_OPP_NUM){
+        return 1;
+    }
+
+    if(opp == clk_opp){
+        return 0;
+    }
+
+    if(xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED){
+        /* The port configures SysTick from SystemCoreClock when the scheduler starts */
+        ret = clk_scaling_apply(&clk_opp_cfg[opp]);
+    }
+    else{
+        taskENTER_CRITICAL();
+        ret = clk_scaling_apply(&clk_opp_cfg[opp]);
+        clk_scaling_systick();
+        taskEXIT_CRITICAL();
+    }
+
+    if(!ret){
+        clk_opp = opp;
+    }
+
+    return ret;
+}
+
+clk_opp_t clk_scaling_get(void){
+
+    return clk_opp;
+}
+
+/***********************************************************************************************************/
+/*                                       Static Function Definitions                                       */
+/***********************************************************************************************************/
+
+static uint8_t clk_scaling_apply(const clk_opp_cfg_t* cfg){
+
+    uint8_t ret = 0;
+
+    /* Wait states are increased before raising the frequency, the current latency is kept if it is higher */
+    if(((FLASHINTR->ACR >> FLASH_ACR_LATENCY) & 0x0F) < cfg->latency){
+        (void)Flash_SetLatency(cfg->latency);
+    }
+
+    /* Over-drive can only be switched while HSI or HSE is the system clock */
+    if(cfg->over_drive != ((PWR->CR >> PWR_CR_ODSWEN) & 0x01)){
+        (void)RCC_SetSystemClock(clk_hsi_cfg);
+        PWR_PCLK_EN();
+        if(cfg->over_drive){
+            PWR_SetOverDrive();
+        }
+        else{
+            PWR_ClearOverDrive();
+        }
+    }
+
+    ret = RCC_SetSystemClock(cfg->rcc);
+
+    /* Wait states are reduced once the frequency is lower */
+    (void)Flash_SetLatency(cfg->latency);
+
+    SystemCoreClock = RCC_GetClocks()->hclk;
+
+    return ret;
+}
+
+static void clk_scaling_systick(void){
+
+    SYST_CSR &= ~(1 << SYST_CSR_ENABLE);
+    SYST_RVR = (SystemCoreClock / configTICK_RATE_HZ) - 1;
+    SYST_CVR = 0;
+    SYST_CSR |= (1 << SYST_CSR_ENABLE);
+}
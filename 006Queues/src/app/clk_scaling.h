@@ -0,0 +1,52 @@
+/********************************************************************************************************//**
+* @file clk_scaling.h
+*
+* @brief Header file containing the prototypes of the APIs for switching the system clock between predefined
+* operating points at run time.
+*
+* Public Functions:
+*       - uint8_t     clk_scaling_set(clk_opp_t opp)
+*       - clk_opp_t   clk_scaling_get(void)
+*
+* @note
+*       Flash latency, over-drive, SystemCoreClock and SysTick are handled by this module. USART baud rates
+*       and timers are re-timed by their drivers through the RCC clock change callbacks. The clock tree of
+*       each operating point is defined and checked at compile time in clk_config.h.
+*/
+
+#ifndef CLK_SCALING_H
+#define CLK_SCALING_H
+
+#include <stdint.h>
+
+/**
+ * @brief Enum with the available operating points.
+ */
+typedef enum
+{
+    CLK_OPP_180MHZ,     /**< PLL from HSE, over-drive on, 5 wait states */
+    CLK_OPP_84MHZ,      /**< PLL from HSE, over-drive off, 2 wait states */
+    CLK_OPP_16MHZ,      /**< HSI, PLL off, 0 wait states */
+    CLK_OPP_NUM         /**< Number of operating points */
+}clk_opp_t;
+
+/***********************************************************************************************************/
+/*                                       APIs Supported                                                    */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for switching the system clock to an operating point.
+ * @param[in] opp is the operating point to be set.
+ * @return 0 if the operating point is set.
+ *         1 if the operating point is not valid or the clock could not be configured.
+ * @note It can be called before and after starting the scheduler, the switch is done in a critical section.
+ */
+uint8_t clk_scaling_set(clk_opp_t opp);
+
+/**
+ * @brief Function for getting the current operating point.
+ * @return current operating point, CLK_OPP_NUM if none was set yet.
+ */
+clk_opp_t clk_scaling_get(void);
+
+#endif /* CLK_SCALING_H */
@@ -0,0 +1,107 @@
+/********************************************************************************************************//**
+* @file flash_async.c
+*
+* @brief File containing the APIs for erasing the flash by interrupt, the calling task blocks on a semaphore
+* instead of polling the BSY flag.
+*
+* Public Functions:
+*       - void    flash_async_init(void)
+*       - uint8_t flash_async_erase(uint8_t sector, TickType_t timeout)
+*
+* @note
+*       For further information about functions refer to the corresponding header file.
+*/
+
+#include "flash_async.h"
+#include "flash_driver.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include <stdint.h>
+
+/** @brief Semaphore given from the FLASH interrupt when the operation finishes */
+static SemaphoreHandle_t flash_done = NULL;
+/** @brief Mutex for allowing only one flash operation at a time */
+static SemaphoreHandle_t flash_mutex = NULL;
+/** @brief Control block of the flash_done semaphore */
+static StaticSemaphore_t flash_done_buffer;
+/** @brief Control block of the flash_mutex mutex */
+static StaticSemaphore_t flash_mutex_buffer;
+/** @brief Event which finished the last operation */
+static volatile Flash_Event_t flash_event = FLASH_EVENT_ERROR;
+
+/***********************************************************************************************************/
+/*                                       Static Function Prototypes                                        */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for waiting the end of the flash operation.
+ * @param[in] expected is the event notified when the operation is successful.
+ * @param[in] timeout is the maximum number of ticks waiting.
+ * @return 0 if the expected event was received, 1 if not.
+ * @note On timeout it returns once the flash is not busy any more, so the caller can release the mutex.
+ */
+static uint8_t flash_async_wait(Flash_Event_t expected, TickType_t timeout);
+
+/***********************************************************************************************************/
+/*                                       Public API Definitions                                            */
+/***********************************************************************************************************/
+
+void flash_async_init(void){
+
+    flash_done = xSemaphoreCreateBinaryStatic(&flash_done_buffer);
+    configASSERT(flash_done != NULL);
+    flash_mutex = xSemaphoreCreateMutexStatic(&flash_mutex_buffer);
+    configASSERT(flash_mutex != NULL);
+
+    Flash_IRQPriorityConfig(IRQ_NO_FLASH, FLASH_ASYNC_IRQ_PRIORITY);
+    Flash_IRQConfig(IRQ_NO_FLASH, ENABLE);
+}
+
+uint8_t flash_async_erase(uint8_t sector, TickType_t timeout){
+
+    uint8_t ret;
+
+    /* Nothing else can run before the scheduler is started, so polling costs nothing */
+    if(xTaskGetSchedulerState() != taskSCHEDULER_RUNNING){
+        return Flash_EraseSector(sector);
+    }
+
+    xSemaphoreTake(flash_mutex, portMAX_DELAY);
+    /* An event not taken by a previous operation is not the one of this erase */
+    (void)xSemaphoreTake(flash_done, 0);
+    ret = Flash_EraseSectorIT(sector);
+    if(!ret){
+        ret = flash_async_wait(FLASH_EVENT_ERASE_CMPLT, timeout);
+    }
+    xSemaphoreGive(flash_mutex);
+
+    return ret;
+}
+
+void Flash_ApplicationEventCallback(Flash_Event_t event){
+
+    BaseType_t woken = pdFALSE;
+
+    flash_event = event;
+    xSemaphoreGiveFromISR(flash_done, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/***********************************************************************************************************/
+/*                                       Static Function Definitions                                       */
+/***********************************************************************************************************/
+
+static uint8_t flash_async_wait(Flash_Event_t expected, TickType_t timeout){
+
+    if(xSemaphoreTake(flash_done, timeout) != pdTRUE){
+        /* The operation goes on: keep the mutex until it ends and drop its late event, or the next one takes it */
+        while(Flash_Busy()){
+            vTaskDelay(1);
+        }
+        (void)xSemaphoreTake(flash_done, 0);
+        return 1;
+    }
+
+    return (flash_event != expected);
+}
@@ -0,0 +1,49 @@
+/********************************************************************************************************//**
+* @file flash_async.h
+*
+* @brief Header file containing the prototypes of the APIs for erasing the flash by interrupt, the calling task
+* blocks on a semaphore instead of polling the BSY flag.
+*
+* Public Functions:
+*       - void    flash_async_init(void)
+*       - uint8_t flash_async_erase(uint8_t sector, TickType_t timeout)
+*
+* @note
+*       The STM32F446 has a single flash bank: during an erase every fetch from the flash, by any task or
+*       interrupt, stalls until the erase finishes, so the system is frozen for up to 1-2 s with a 128 KB sector.
+*       Only code and data in RAM (.ramfunc, .data) can run meanwhile. This API just spares the caller the BSY
+*       busy-wait and gives it a timeout. Word programming takes microseconds, so it is done by polling with
+*       Flash_Program.
+*/
+
+#ifndef FLASH_ASYNC_H
+#define FLASH_ASYNC_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+/** @brief Priority of the FLASH interrupt, it must allow calling FreeRTOS APIs from the ISR */
+#define FLASH_ASYNC_IRQ_PRIORITY    6
+
+/***********************************************************************************************************/
+/*                                       APIs Supported                                                    */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for creating the synchronization objects and enabling the FLASH interrupt.
+ * @return None
+ */
+void flash_async_init(void);
+
+/**
+ * @brief Function for erasing a flash sector, the calling task blocks until the end of the erase.
+ * @param[in] sector is the selected sector of the flash to be erased, 0xFF means mass erase.
+ * @param[in] timeout is the maximum number of ticks waiting for the end of the operation.
+ * @return 0 if the sector was erased.
+ *         1 if the operation could not be started, failed or timed out.
+ * @note Before the scheduler is started the erase is done by polling. On timeout the function still waits
+ *       for the end of the erase, without further timeout, so the next operation finds the flash free.
+ */
+uint8_t flash_async_erase(uint8_t sector, TickType_t timeout);
+
+#endif /* FLASH_ASYNC_H */
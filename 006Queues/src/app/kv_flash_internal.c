@@ -0,0 +1,82 @@
+/********************************************************************************************************//**
+* @file kv_flash_internal.c
+*
+* @brief File containing the flash access of the key-value store over the internal flash sectors 6 and 7.
+*
+* Public Variables:
+*       - const kv_flash_t kv_internal_flash
+*
+* @note
+*       For further information refer to the corresponding header file.
+*/
+
+#include "kv_flash_internal.h"
+#include "flash_driver.h"
+#include "flash_async.h"
+#include <stdint.h>
+
+/** @brief First internal flash sector used by the store */
+#define KV_SECTOR_A             6
+/** @brief Second internal flash sector used by the store */
+#define KV_SECTOR_B             7
+/** @brief Base address of the first sector */
+#define KV_SECTOR_A_ADDR        0x08040000U
+/** @brief Base address of the second sector */
+#define KV_SECTOR_B_ADDR        0x08060000U
+/** @brief Size of the sectors 6 and 7 */
+#define KV_SECTOR_SIZE          (128 * 1024)
+
+/***********************************************************************************************************/
+/*                                       Static Function Prototypes                                        */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for erasing a sector of the internal flash.
+ * @param[in] sector is the store sector (0 or 1).
+ * @return 0 if OK, 1 if fail.
+ */
+static uint8_t kv_flash_erase(uint8_t sector);
+
+/**
+ * @brief Function for programming a word in the internal flash.
+ * @param[in] sector is the store sector (0 or 1).
+ * @param[in] offset is the offset in the sector.
+ * @param[in] data is the word to be programmed.
+ * @return 0 if OK, 1 if fail.
+ */
+static uint8_t kv_flash_program(uint8_t sector, uint32_t offset, uint32_t data);
+
+/**
+ * @brief Function for reading a word of the internal flash.
+ * @param[in] sector is the store sector (0 or 1).
+ * @param[in] offset is the offset in the sector.
+ * @return word read.
+ */
+static uint32_t kv_flash_read(uint8_t sector, uint32_t offset);
+
+const kv_flash_t kv_internal_flash = {
+    KV_SECTOR_SIZE,
+    kv_flash_erase,
+    kv_flash_program,
+    kv_flash_read
+};
+
+/***********************************************************************************************************/
+/*                                       Static Function Definitions                                       */
+/***********************************************************************************************************/
+
+static uint8_t kv_flash_erase(uint8_t sector){
+
+    /* A 128 KB sector takes 1-2 s to be erased and the code in flash stalls meanwhile, it only happens at compaction */
+    return flash_async_erase(sector ? KV_SECTOR_B : KV_SECTOR_A, portMAX_DELAY);
+}
+
+static uint8_t kv_flash_program(uint8_t sector, uint32_t offset, uint32_t data){
+
+    return Flash_Program((sector ? KV_SECTOR_B_ADDR : KV_SECTOR_A_ADDR) + offset, &data, sizeof(data));
+}
+
+static uint32_t kv_flash_read(uint8_t sector, uint32_t offset){
+
+    return *(volatile uint32_t*)((sector ? KV_SECTOR_B_ADDR : KV_SECTOR_A_ADDR) + offset);
+}
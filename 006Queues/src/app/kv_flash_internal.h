@@ -0,0 +1,25 @@
+/********************************************************************************************************//**
+* @file kv_flash_internal.h
+*
+* @brief Header file containing the flash access of the key-value store over the internal flash sectors 6 and
+* 7.
+*
+* Public Variables:
+*       - const kv_flash_t kv_internal_flash
+*
+* @note
+*       The sectors are erased through flash_async, so the store must be used once the FLASH interrupt is set up
+*       with flash_async_init. An erase stalls all the code running from flash for 1-2 s, see flash_async.h.
+*       The store itself does not depend on this file and can be built on a host over a RAM-backed emulation of
+*       the flash.
+*/
+
+#ifndef KV_FLASH_INTERNAL_H
+#define KV_FLASH_INTERNAL_H
+
+#include "kv_store.h"
+
+/** @brief Flash access using the sectors 6 and 7 of the internal flash */
+extern const kv_flash_t kv_internal_flash;
+
+#endif /* KV_FLASH_INTERNAL_H */
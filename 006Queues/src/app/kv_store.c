@@ -0,0 +1,332 @@
+/********************************************************************************************************//**
+* @file kv_store.c
+*
+* @brief File containing the APIs for a log-structured key-value store kept in two flash sectors.
+*
+* Public Functions:
+*       - uint8_t kv_init(const kv_flash_t* flash)
+*       - uint8_t kv_get(uint8_t key, void* data, uint16_t* len)
+*       - uint8_t kv_set(uint8_t key, const void* data, uint16_t len)
+*
+* @note
+*       For further information about functions refer to the corresponding header file.
+*
+*       Sector layout: a header with the sector state and a sequence number, followed by the records.
+*       Record layout: a word with the key (16 lsb) and the length (16 msb), the value padded to a word and
+*       the CRC-32 of the key/length word and the value. The CRC is programmed last, so a record interrupted
+*       by a reset is discarded.
+*/
+
+#include "kv_store.h"
+#include "crc_driver.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @defgroup KV_SectorState Sector states, each one only clears bits of the previous one.
+ * @{
+ */
+#define KV_ERASED               0xFFFFFFFFU /**< @brief Sector erased */
+#define KV_COPY                 0xEEEEEEEEU /**< @brief Sector receiving the records during a compaction */
+#define KV_ACTIVE               0xCCCCCCCCU /**< @brief Sector in use */
+#define KV_OLD                  0x00000000U /**< @brief Sector retired, pending to be erased */
+/**@}*/
+
+/** @brief Offset of the state word in the sector header */
+#define KV_HDR_STATE            0
+/** @brief Offset of the sequence number in the sector header */
+#define KV_HDR_SEQ              4
+/** @brief Offset of the first record in the sector */
+#define KV_FIRST_REC            8
+
+/** @brief Length of a value padded to a word */
+#define KV_PAD(len)             (((uint32_t)(len) + 3) & ~3U)
+/** @brief Size in flash of a record */
+#define KV_REC_SIZE(len)        (4 + KV_PAD(len) + 4)
+
+/** @brief Functions for accessing the flash */
+static const kv_flash_t* kv_flash = NULL;
+/** @brief Sector in use (0 or 1) */
+static uint8_t kv_active = 0;
+/** @brief Sequence number of the sector in use, it increases on each compaction */
+static uint32_t kv_seq = 0;
+/** @brief Offset where the next record is appended */
+static uint32_t kv_wr_offset = 0;
+/** @brief Offset of the last record of each key in the active sector, 0 if the key has no value */
+static uint32_t kv_index[KV_MAX_KEYS];
+
+/***********************************************************************************************************/
+/*                                       Static Function Prototypes                                        */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for erasing the first sector and starting an empty store on it.
+ * @return 0 if OK, 1 if the flash operation failed.
+ */
+static uint8_t kv_format(void);
+
+/**
+ * @brief Function for building the index and finding the end of the log in the active sector.
+ * @return None
+ */
+static void kv_scan(void);
+
+/**
+ * @brief Function for reading the value of a record.
+ * @param[in] sector is the sector where the record is.
+ * @param[in] offset is the offset of the record in the sector.
+ * @param[out] buf is the buffer where the value is copied, it must have room for KV_MAX_LEN bytes.
+ * @param[in] check is 1 for verifying the CRC of the record.
+ * @return length of the value, 0 if the record is not valid.
+ */
+static uint16_t kv_read(uint8_t sector, uint32_t offset, uint32_t* buf, uint8_t check);
+
+/**
+ * @brief Function for appending a record at the end of the log.
+ * @param[in] sector is the sector where the record is appended.
+ * @param[in] key is the key of the record.
+ * @param[in] data is a pointer to the value.
+ * @param[in] len is the length of the value.
+ * @return 0 if OK, 1 if the flash operation failed.
+ */
+static uint8_t kv_append(uint8_t sector, uint8_t key, const void* data, uint16_t len);
+
+/**
+ * @brief Function for copying the last value of each key to the other sector and appending a new record.
+ * @param[in] key is the key of the new record.
+ * @param[in] data is a pointer to the new value.
+ * @param[in] len is the length of the new value.
+ * @return 0 if OK, 1 if the flash operation failed.
+ */
+static uint8_t kv_compact(uint8_t key, const void* data, uint16_t len);
+
+/***********************************************************************************************************/
+/*                                       Public API Definitions                                            */
+/***********************************************************************************************************/
+
+uint8_t kv_init(const kv_flash_t* flash){
+
+    uint32_t state[2];
+    uint32_t seq[2];
+
+    kv_flash = flash;
+
+    for(uint8_t i = 0; i < 2; i++){
+        state[i] = kv_flash->read(i, KV_HDR_STATE);
+        seq[i] = kv_flash->read(i, KV_HDR_SEQ);
+    }
+
+    if((state[0] == KV_ACTIVE) && (state[1] == KV_ACTIVE)){
+        /* Reset after a compaction but before retiring the source sector, keep the newest one */
+        kv_active = (seq[1] > seq[0]) ? 1 : 0;
+        (void)kv_flash->program(kv_active ^ 1, KV_HDR_STATE, KV_OLD);
+    }
+    else if(state[0] == KV_ACTIVE){
+        kv_active = 0;
+    }
+    else if(state[1] == KV_ACTIVE){
+        kv_active = 1;
+    }
+    else{
+        /* No store found (a sector in KV_COPY state means an interrupted compaction of an empty store) */
+        return kv_format();
+    }
+
+    kv_seq = seq[kv_active];
+    kv_scan();
+
+    return 0;
+}
+
+uint8_t kv_get(uint8_t key, void* data, uint16_t* len){
+
+    uint32_t buf[KV_MAX_LEN / 4];
+    uint16_t stored;
+
+    if((kv_flash == NULL) || (key >= KV_MAX_KEYS) || (kv_index[key] == 0)){
+        return 1;
+    }
+
+    /* The CRC was already checked when the index was built */
+    stored = kv_read(kv_active, kv_index[key], buf, 0);
+    if((stored == 0) || (stored > *len)){
+        return 1;
+    }
+
+    memcpy(data, buf, stored);
+    *len = stored;
+
+    return 0;
+}
+
+uint8_t kv_set(uint8_t key, const void* data, uint16_t len){
+
+    uint32_t buf[KV_MAX_LEN / 4];
+    uint16_t stored;
+
+    if((kv_flash == NULL) || (key >= KV_MAX_KEYS) || (data == NULL) || (len == 0) || (len > KV_MAX_LEN)){
+        return 1;
+    }
+
+    /* Do not wear the flash if the same value is already stored */
+    if(kv_index[key]){
+        stored = kv_read(kv_active, kv_index[key], buf, 0);
+        if((stored == len) && !memcmp(buf, data, len)){
+            return 0;
+        }
+    }
+
+    if((kv_wr_offset + KV_REC_SIZE(len)) > kv_flash->sector_size){
+        return kv_compact(key, data, len);
+    }
+
+    return kv_append(kv_active, key, data, len);
+}
+
+/***********************************************************************************************************/
+/*                                       Static Function Definitions                                       */
+/***********************************************************************************************************/
+
+static uint8_t kv_format(void){
+
+    uint8_t ret = 0;
+
+    memset(kv_index, 0, sizeof(kv_index));
+    kv_active = 0;
+    kv_seq = 1;
+    kv_wr_offset = KV_FIRST_REC;
+
+    ret |= kv_flash->erase(kv_active);
+    ret |= kv_flash->program(kv_active, KV_HDR_SEQ, kv_seq);
+    ret |= kv_flash->program(kv_active, KV_HDR_STATE, KV_ACTIVE);
+
+    return ret;
+}
+
+static void kv_scan(void){
+
+    uint32_t buf[KV_MAX_LEN / 4];
+    uint32_t offset = KV_FIRST_REC;
+    uint32_t hdr;
+    uint16_t key;
+    uint16_t len;
+
+    memset(kv_index, 0, sizeof(kv_index));
+
+    while((offset + KV_REC_SIZE(0)) <= kv_flash->sector_size){
+        hdr = kv_flash->read(kv_active, offset);
+        if(hdr == KV_ERASED){
+            break;
+        }
+        key = (uint16_t)(hdr & 0xFFFF);
+        len = (uint16_t)(hdr >> 16);
+        if((len == 0) || (len > KV_MAX_LEN) || ((offset + KV_REC_SIZE(len)) > kv_flash->sector_size)){
+            /* Corrupted header, the record size is unknown so the sector is considered full */
+            offset = kv_flash->sector_size;
+            break;
+        }
+        if((key < KV_MAX_KEYS) && kv_read(kv_active, offset, buf, 1)){
+            kv_index[key] = offset;
+        }
+        offset += KV_REC_SIZE(len);
+    }
+
+    kv_wr_offset = offset;
+}
+
+static uint16_t kv_read(uint8_t sector, uint32_t offset, uint32_t* buf, uint8_t check){
+
+    uint32_t hdr = kv_flash->read(sector, offset);
+    uint16_t len = (uint16_t)(hdr >> 16);
+    uint32_t crc;
+
+    if((len == 0) || (len > KV_MAX_LEN)){
+        return 0;
+    }
+
+    for(uint32_t i = 0; i < (KV_PAD(len) / 4); i++){
+        buf[i] = kv_flash->read(sector, offset + 4 + (4 * i));
+    }
+
+    if(check){
+        crc = CRC_Bytes(CRC_INIT_VALUE, &hdr, 4);
+        crc = CRC_Bytes(crc, buf, len);
+        if(crc != kv_flash->read(sector, offset + 4 + KV_PAD(len))){
+            return 0;
+        }
+    }
+
+    return len;
+}
+
+static uint8_t kv_append(uint8_t sector, uint8_t key, const void* data, uint16_t len){
+
+    uint32_t buf[KV_MAX_LEN / 4];
+    uint32_t hdr = (uint32_t)key | ((uint32_t)len << 16);
+    uint32_t offset = kv_wr_offset;
+    uint32_t crc;
+    uint8_t ret = 0;
+
+    memset(buf, 0xFF, sizeof(buf));
+    memcpy(buf, data, len);
+    crc = CRC_Bytes(CRC_INIT_VALUE, &hdr, 4);
+    crc = CRC_Bytes(crc, buf, len);
+
+    /* The space is consumed even if programming fails, a written location can not be programmed again */
+    kv_wr_offset += KV_REC_SIZE(len);
+
+    ret |= kv_flash->program(sector, offset, hdr);
+    for(uint32_t i = 0; i < (KV_PAD(len) / 4); i++){
+        ret |= kv_flash->program(sector, offset + 4 + (4 * i), buf[i]);
+    }
+    ret |= kv_flash->program(sector, offset + 4 + KV_PAD(len), crc);
+
+    if(!ret){
+        kv_index[key] = offset;
+    }
+
+    return ret;
+}
+
+static uint8_t kv_compact(uint8_t key, const void* data, uint16_t len){
+
+    uint32_t buf[KV_MAX_LEN / 4];
+    uint8_t dst = kv_active ^ 1;
+    uint16_t stored;
+    uint8_t ret = 0;
+
+    /* The destination holds an old copy of the store, it is the only erase of the whole compaction */
+    if(kv_flash->erase(dst)){
+        return 1;
+    }
+    ret |= kv_flash->program(dst, KV_HDR_SEQ, kv_seq + 1);
+    ret |= kv_flash->program(dst, KV_HDR_STATE, KV_COPY);
+
+    kv_wr_offset = KV_FIRST_REC;
+    for(uint8_t k = 0; k < KV_MAX_KEYS; k++){
+        if((k == key) || (kv_index[k] == 0)){
+            continue;
+        }
+        stored = kv_read(kv_active, kv_index[k], buf, 0);
+        if(stored){
+            ret |= kv_append(dst, k, buf, stored);
+        }
+    }
+    ret |= kv_append(dst, key, data, len);
+
+    if(ret){
+        /* Keep using the source sector, the index must point to it again */
+        kv_scan();
+        return 1;
+    }
+
+    /* New sector is valid before the old one is retired, kv_init solves a reset in between */
+    ret |= kv_flash->program(dst, KV_HDR_STATE, KV_ACTIVE);
+    (void)kv_flash->program(kv_active, KV_HDR_STATE, KV_OLD);
+    kv_active = dst;
+    kv_seq++;
+
+    return ret;
+}
+
@@ -0,0 +1,74 @@
+/********************************************************************************************************//**
+* @file kv_store.h
+*
+* @brief Header file containing the prototypes of the APIs for a log-structured key-value store kept in two
+* flash sectors.
+*
+* Public Functions:
+*       - uint8_t kv_init(const kv_flash_t* flash)
+*       - uint8_t kv_get(uint8_t key, void* data, uint16_t* len)
+*       - uint8_t kv_set(uint8_t key, const void* data, uint16_t len)
+*
+* @note
+*       Records are appended to the active sector. When it is full the last value of every key is copied to
+*       the other sector, so a sector is only erased once per compaction. The flash is accessed through a
+*       kv_flash_t structure: kv_internal_flash (kv_flash_internal.h) on the target, a RAM-backed emulation
+*       of the flash in the host test.
+*/
+
+#ifndef KV_STORE_H
+#define KV_STORE_H
+
+#include <stdint.h>
+
+/** @brief Maximum number of keys, keys go from 0 to KV_MAX_KEYS - 1 */
+#define KV_MAX_KEYS         16
+/** @brief Maximum length in bytes of a value */
+#define KV_MAX_LEN          64
+
+/**
+ * @brief Structure with the functions for accessing the flash used by the key-value store.
+ * @note Sectors are numbered 0 and 1 and offsets are relative to the beginning of the sector, data is
+ *       always accessed as 32 bits words.
+ */
+typedef struct{
+    uint32_t sector_size;                                               /**< Size in bytes of each sector */
+    uint8_t  (*erase)(uint8_t sector);                                  /**< Erase a sector, 0 if OK */
+    uint8_t  (*program)(uint8_t sector, uint32_t offset, uint32_t data);/**< Program a word, 0 if OK */
+    uint32_t (*read)(uint8_t sector, uint32_t offset);                  /**< Read a word */
+}kv_flash_t;
+
+/***********************************************************************************************************/
+/*                                       APIs Supported                                                    */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for mounting the key-value store, the sectors are formatted if no valid store is found.
+ * @param[in] flash is a pointer to the structure with the flash access functions.
+ * @return 0 if the store is ready.
+ *         1 if the flash could not be formatted.
+ */
+uint8_t kv_init(const kv_flash_t* flash);
+
+/**
+ * @brief Function for getting the value of a key.
+ * @param[in] key is the key to be read.
+ * @param[out] data is a pointer to the buffer where the value is copied.
+ * @param[in,out] len is the size of the buffer as input and the length of the value as output.
+ * @return 0 if the value was copied.
+ *         1 if the key has no value or the buffer is too small.
+ */
+uint8_t kv_get(uint8_t key, void* data, uint16_t* len);
+
+/**
+ * @brief Function for setting the value of a key.
+ * @param[in] key is the key to be written.
+ * @param[in] data is a pointer to the value.
+ * @param[in] len is the length of the value in bytes (1 to KV_MAX_LEN).
+ * @return 0 if the value was stored or it was already stored.
+ *         1 if the parameters are not valid or the flash programming failed.
+ * @note This function can erase a flash sector when the active one is full.
+ */
+uint8_t kv_set(uint8_t key, const void* data, uint16_t len);
+
+#endif /* KV_STORE_H */
@@ -0,0 +1,213 @@
+/********************************************************************************************************//**
+* @file queue_stats.c
+*
+* @brief File containing the APIs for the statistics of the registered queues, fed by the queue trace hooks of
+* the kernel.
+*
+* Public Functions:
+*       - uint32_t queue_stats_add(const char* name, uint32_t length)
+*       - void     queue_stats_send(uint32_t number, uint32_t waiting, int32_t position)
+*       - void     queue_stats_send_failed(uint32_t number)
+*       - void     queue_stats_blocked(uint32_t number)
+*       - void     queue_stats_receive(uint32_t number)
+*       - uint32_t queue_stats_report(char* buf, uint32_t size)
+*
+* @note
+*       For further information about functions refer to the corresponding header file.
+*/
+
+#include "queue_stats.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/** @brief DWT cycle counter, started by rt_stats_init */
+#define DWT_CYCCNT      (*(volatile uint32_t*)0xE0001004U)
+
+/**
+ * @brief Structure with the statistics of a watched queue.
+ */
+typedef struct{
+    const char* name;                   /**< Name of the queue in the registry */
+    uint32_t length;                    /**< Maximum number of items */
+    uint32_t peak;                      /**< Maximum number of items seen in the queue */
+    uint32_t sent;                      /**< Items sent */
+    uint32_t full;                      /**< Sends failed because the queue was full */
+    uint32_t blocked;                   /**< Sends which blocked because the queue was full */
+    uint32_t measured;                  /**< Items received with a measured latency */
+    uint32_t lat_max;                   /**< Maximum latency in cycles */
+    uint64_t lat_sum;                   /**< Sum of the measured latencies in cycles */
+    uint32_t bins[QUEUE_STATS_BINS];    /**< Latency histogram */
+}queue_stats_entry_t;
+
+/**
+ * @brief Structure with the send timestamps of the items of a watched queue, in the same order as the items.
+ */
+typedef struct{
+    uint32_t stamp[QUEUE_STATS_MAX_DEPTH];  /**< CYCCNT at the send of each item */
+    uint8_t head;                           /**< Index of the timestamp of the oldest item */
+}queue_stats_ring_t;
+
+/** @brief Watched queues, entry i has queue number i + 1 */
+static queue_stats_entry_t queue_stats_entries[QUEUE_STATS_MAX_QUEUES];
+/** @brief Send timestamps of the watched queues */
+static queue_stats_ring_t queue_stats_rings[QUEUE_STATS_MAX_QUEUES];
+/** @brief Number of valid entries of queue_stats_entries */
+static uint8_t queue_stats_num = 0;
+
+/***********************************************************************************************************/
+/*                                       Static Function Prototypes                                        */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for getting the histogram bin of a latency.
+ * @param[in] cycles is the latency in cycles.
+ * @return index of the bin.
+ */
+static uint8_t queue_stats_bin(uint32_t cycles);
+
+/***********************************************************************************************************/
+/*                                       Public API Definitions                                            */
+/***********************************************************************************************************/
+
+uint32_t queue_stats_add(const char* name, uint32_t length){
+
+    queue_stats_entry_t* entry;
+    uint8_t index;
+
+    taskENTER_CRITICAL();
+    if(queue_stats_num >= QUEUE_STATS_MAX_QUEUES){
+        taskEXIT_CRITICAL();
+        return 0;
+    }
+    index = queue_stats_num++;
+    taskEXIT_CRITICAL();
+
+    /* The hooks do nothing until the queue number is set, so the entry can be filled outside the critical section */
+    entry = &queue_stats_entries[index];
+    entry->name = name;
+    entry->length = length;
+    queue_stats_rings[index].head = 0;
+
+    return index + 1;
+}
+
+void queue_stats_send(uint32_t number, uint32_t waiting, int32_t position){
+
+    queue_stats_entry_t* entry = &queue_stats_entries[number - 1];
+    queue_stats_ring_t* ring = &queue_stats_rings[number - 1];
+    uint32_t index;
+
+    entry->sent++;
+    /* An overwrite replaces the only item of the queue */
+    if(waiting >= entry->length){
+        waiting = entry->length - 1;
+    }
+    if(waiting + 1 > entry->peak){
+        entry->peak = waiting + 1;
+    }
+
+    if(entry->length > QUEUE_STATS_MAX_DEPTH){
+        return;
+    }
+    if(position == queueSEND_TO_FRONT){
+        ring->head = (ring->head == 0) ? (entry->length - 1) : (ring->head - 1);
+        index = ring->head;
+    }
+    else{
+        index = ring->head + waiting;
+        if(index >= entry->length){
+            index -= entry->length;
+        }
+    }
+    ring->stamp[index] = DWT_CYCCNT;
+}
+
+void queue_stats_send_failed(uint32_t number){
+
+    /* The task hook runs after the critical section is left, an interrupt may fail a send meanwhile */
+    __atomic_fetch_add(&queue_stats_entries[number - 1].full, 1, __ATOMIC_RELAXED);
+}
+
+void queue_stats_blocked(uint32_t number){
+
+    /* The hook runs with the scheduler suspended and only tasks block, no one else updates the counter */
+    queue_stats_entries[number - 1].blocked++;
+}
+
+void queue_stats_receive(uint32_t number){
+
+    queue_stats_entry_t* entry = &queue_stats_entries[number - 1];
+    queue_stats_ring_t* ring = &queue_stats_rings[number - 1];
+    uint32_t cycles;
+
+    if(entry->length > QUEUE_STATS_MAX_DEPTH){
+        return;
+    }
+    cycles = DWT_CYCCNT - ring->stamp[ring->head];
+    ring->head = (ring->head + 1 == entry->length) ? 0 : (ring->head + 1);
+
+    entry->measured++;
+    entry->lat_sum += cycles;
+    if(cycles > entry->lat_max){
+        entry->lat_max = cycles;
+    }
+    entry->bins[queue_stats_bin(cycles)]++;
+}
+
+uint32_t queue_stats_report(char* buf, uint32_t size){
+
+    queue_stats_entry_t entry;
+    uint8_t num;
+    uint32_t len;
+
+    num = __atomic_load_n(&queue_stats_num, __ATOMIC_ACQUIRE);
+
+    len = snprintf(buf, size, "\nQueue       Len  Peak      Sent  Full  Blocked\n");
+    for(uint8_t i = 0; (i < num) && (len < size); i++){
+        /* The hooks update the entry from tasks and interrupts, a copy gives consistent figures */
+        taskENTER_CRITICAL();
+        entry = queue_stats_entries[i];
+        taskEXIT_CRITICAL();
+
+        len += snprintf(&buf[len], size - len, "%-10s %4lu  %4lu %9lu %5lu %8lu\n", entry.name,
+                        (unsigned long)entry.length, (unsigned long)entry.peak, (unsigned long)entry.sent,
+                        (unsigned long)entry.full, (unsigned long)entry.blocked);
+        if((entry.measured == 0) || (len >= size)){
+            continue;
+        }
+        len += snprintf(&buf[len], size - len, "  Latency avg %lu max %lu cycles\n  Bins:",
+                        (unsigned long)(entry.lat_sum / entry.measured), (unsigned long)entry.lat_max);
+        for(uint8_t j = 0; (j < QUEUE_STATS_BINS) && (len < size); j++){
+            len += snprintf(&buf[len], size - len, " %lu", (unsigned long)entry.bins[j]);
+        }
+        if(len < size){
+            len += snprintf(&buf[len], size - len, "\n");
+        }
+    }
+    if(len < size){
+        len += snprintf(&buf[len], size - len, "Bin k counts latencies below 2^(k+%u) cycles, the last one the rest\n",
+                        (unsigned int)QUEUE_STATS_BIN_SHIFT);
+    }
+
+    return (len < size) ? len : (size - 1);
+}
+
+/***********************************************************************************************************/
+/*                                       Static Function Definitions                                       */
+/***********************************************************************************************************/
+
+static uint8_t queue_stats_bin(uint32_t cycles){
+
+    uint32_t scaled = cycles >> QUEUE_STATS_BIN_SHIFT;
+    uint8_t bin;
+
+    if(scaled == 0){
+        return 0;
+    }
+    bin = 32 - __builtin_clz(scaled);
+
+    return (bin < QUEUE_STATS_BINS) ? bin : (QUEUE_STATS_BINS - 1);
+}
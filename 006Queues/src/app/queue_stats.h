@@ -0,0 +1,96 @@
+/********************************************************************************************************//**
+* @file queue_stats.h
+*
+* @brief Header file containing the prototypes of the APIs for the statistics of the registered queues, fed by
+* the queue trace hooks of the kernel.
+*
+* Public Functions:
+*       - uint32_t queue_stats_add(const char* name, uint32_t length)
+*       - void     queue_stats_send(uint32_t number, uint32_t waiting, int32_t position)
+*       - void     queue_stats_send_failed(uint32_t number)
+*       - void     queue_stats_blocked(uint32_t number)
+*       - void     queue_stats_receive(uint32_t number)
+*       - uint32_t queue_stats_report(char* buf, uint32_t size)
+*
+* @note
+*       A queue is watched once it is added to the queue registry with vQueueAddToRegistry, the hook stores the
+*       index of its entry in the queue number. For each queue the peak depth, the sends, the sends failed
+*       because the queue was full and the sends which had to block are counted. The time an item spends in
+*       the queue is measured in CPU cycles with CYCCNT: a timestamp is stored in a ring mirroring the queue
+*       at each send and taken out at each receive. The latency is only measured for queues up to
+*       QUEUE_STATS_MAX_DEPTH items, it wraps after about 23 seconds at 180 MHz and it is wrong after
+*       xQueueReset or xQueueSendToFrontFromISR on a watched queue.
+*/
+
+#ifndef QUEUE_STATS_H
+#define QUEUE_STATS_H
+
+#include "FreeRTOS.h"
+#include <stdint.h>
+
+/** @brief Maximum number of queues watched, one per entry of the queue registry */
+#define QUEUE_STATS_MAX_QUEUES  configQUEUE_REGISTRY_SIZE
+/** @brief Maximum length of a queue for measuring its latency */
+#define QUEUE_STATS_MAX_DEPTH   16
+/** @brief Number of bins of the latency histogram */
+#define QUEUE_STATS_BINS        12
+/** @brief Bin 0 counts latencies below 2^QUEUE_STATS_BIN_SHIFT cycles, each bin doubles the limit */
+#define QUEUE_STATS_BIN_SHIFT   10
+/** @brief Size of a buffer big enough for the report of QUEUE_STATS_MAX_QUEUES queues */
+#define QUEUE_STATS_REPORT_LEN  (192 * (QUEUE_STATS_MAX_QUEUES + 1))
+
+/***********************************************************************************************************/
+/*                                       APIs Supported                                                    */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for adding a queue to the statistics, called by the kernel through traceQUEUE_REGISTRY_ADD.
+ * @param[in] name is the name of the queue in the registry.
+ * @param[in] length is the maximum number of items of the queue.
+ * @return queue number for the hooks, 0 if the table is full and the queue is not watched.
+ */
+uint32_t queue_stats_add(const char* name, uint32_t length);
+
+/**
+ * @brief Function for counting an item sent to a queue, called by the kernel through traceQUEUE_SEND and
+ *        traceQUEUE_SEND_FROM_ISR with the queue locked.
+ * @param[in] number is the queue number.
+ * @param[in] waiting is the number of items in the queue before the send.
+ * @param[in] position is the copy position, queueSEND_TO_BACK, queueSEND_TO_FRONT or queueOVERWRITE.
+ * @return None
+ */
+void queue_stats_send(uint32_t number, uint32_t waiting, int32_t position);
+
+/**
+ * @brief Function for counting a send failed because the queue was full, called by the kernel through
+ *        traceQUEUE_SEND_FAILED and traceQUEUE_SEND_FROM_ISR_FAILED.
+ * @param[in] number is the queue number.
+ * @return None
+ */
+void queue_stats_send_failed(uint32_t number);
+
+/**
+ * @brief Function for counting a task blocked because the queue was full, called by the kernel through
+ *        traceBLOCKING_ON_QUEUE_SEND.
+ * @param[in] number is the queue number.
+ * @return None
+ */
+void queue_stats_blocked(uint32_t number);
+
+/**
+ * @brief Function for adding the latency of the item received to the histogram, called by the kernel through
+ *        traceQUEUE_RECEIVE and traceQUEUE_RECEIVE_FROM_ISR with the queue locked.
+ * @param[in] number is the queue number.
+ * @return None
+ */
+void queue_stats_receive(uint32_t number);
+
+/**
+ * @brief Function for writing the statistics and the latency histogram of each watched queue.
+ * @param[out] buf is the buffer for the text, QUEUE_STATS_REPORT_LEN bytes are enough.
+ * @param[in] size is the size of the buffer.
+ * @return length of the text, without the terminating '\0'.
+ */
+uint32_t queue_stats_report(char* buf, uint32_t size);
+
+#endif /* QUEUE_STATS_H */
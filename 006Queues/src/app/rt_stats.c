@@ -0,0 +1,180 @@
+/********************************************************************************************************//**
+* @file rt_stats.c
+*
+* @brief File containing the APIs for the FreeRTOS run-time statistics, counted with the DWT cycle counter.
+*
+* Public Functions:
+*       - void     rt_stats_init(void)
+*       - uint32_t rt_stats_counter(void)
+*       - uint32_t rt_stats_report(char* buf, uint32_t size)
+*
+* @note
+*       For further information about functions refer to the corresponding header file.
+*/
+
+#include "rt_stats.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/** @brief Debug exception and monitor control register, TRCENA enables the DWT */
+#define DEMCR           (*(volatile uint32_t*)0xE000EDFCU)
+/** @brief DWT control register, bit 0 enables the cycle counter */
+#define DWT_CTRL        (*(volatile uint32_t*)0xE0001000U)
+/** @brief DWT cycle counter */
+#define DWT_CYCCNT      (*(volatile uint32_t*)0xE0001004U)
+
+/**
+ * @brief Structure with the run-time counter of a task at the previous report.
+ */
+typedef struct{
+    UBaseType_t number;     /**< Task number given by the kernel, unique for each task */
+    uint32_t counter;       /**< Run-time counter of the task */
+}rt_stats_prev_t;
+
+/** @brief Cycles counted since rt_stats_init */
+static uint64_t rt_cycles = 0;
+/** @brief Value of CYCCNT at the last update of rt_cycles */
+static uint32_t rt_last = 0;
+/** @brief State of the tasks, kept static as it is too big for the stack of the calling task */
+static TaskStatus_t rt_status[RT_STATS_MAX_TASKS];
+/** @brief Run-time counters at the previous report */
+static rt_stats_prev_t rt_prev[RT_STATS_MAX_TASKS];
+/** @brief Number of valid entries of rt_prev */
+static UBaseType_t rt_prev_num = 0;
+/** @brief Total run-time counter at the previous report */
+static uint32_t rt_prev_total = 0;
+
+/***********************************************************************************************************/
+/*                                       Static Function Prototypes                                        */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for getting the run-time counter of a task at the previous report.
+ * @param[in] number is the task number.
+ * @return run-time counter, 0 if the task was not in the previous report.
+ */
+static uint32_t rt_stats_prev_counter(UBaseType_t number);
+
+/**
+ * @brief Function for getting the letter shown for a task state.
+ * @param[in] state is the task state.
+ * @return letter of the state.
+ */
+static char rt_stats_state_char(eTaskState state);
+
+/***********************************************************************************************************/
+/*                                       Public API Definitions                                            */
+/***********************************************************************************************************/
+
+void rt_stats_init(void){
+
+    /* Reset_Handler already starts CYCCNT, a debugger may have stopped it since */
+    DEMCR |= (1U << 24);
+    DWT_CTRL |= (1U << 0);
+
+    rt_last = DWT_CYCCNT;
+    rt_cycles = 0;
+}
+
+uint32_t rt_stats_counter(void){
+
+    UBaseType_t mask;
+    uint32_t now;
+    uint32_t value;
+
+    /* Called from tasks, the tick and the context switch, the 64-bit update must not be interrupted */
+    mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    now = DWT_CYCCNT;
+    rt_cycles += (uint32_t)(now - rt_last);
+    rt_last = now;
+    value = (uint32_t)(rt_cycles >> RT_STATS_SHIFT);
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+
+    return value;
+}
+
+uint32_t rt_stats_report(char* buf, uint32_t size){
+
+    uint32_t delta[RT_STATS_MAX_TASKS];
+    uint8_t order[RT_STATS_MAX_TASKS];
+    uint32_t total;
+    uint32_t elapsed;
+    uint32_t permille;
+    UBaseType_t num;
+    TaskStatus_t* task;
+    uint32_t len;
+    uint8_t i, j, tmp;
+
+    num = uxTaskGetSystemState(rt_status, RT_STATS_MAX_TASKS, &total);
+    elapsed = total - rt_prev_total;
+
+    for(i = 0; i < num; i++){
+        delta[i] = rt_status[i].ulRunTimeCounter - rt_stats_prev_counter(rt_status[i].xTaskNumber);
+        /* Insertion sort by load, the busiest task first */
+        order[i] = i;
+        for(j = i; (j > 0) && (delta[order[j - 1]] < delta[order[j]]); j--){
+            tmp = order[j];
+            order[j] = order[j - 1];
+            order[j - 1] = tmp;
+        }
+    }
+
+    len = snprintf(buf, size, "\nTask       State Prio   CPU%%  Free stack (words)\n");
+    for(i = 0; (i < num) && (len < size); i++){
+        task = &rt_status[order[i]];
+        permille = (elapsed > 0) ? (uint32_t)(((uint64_t)delta[order[i]] * 1000) / elapsed) : 0;
+        len += snprintf(&buf[len], size - len, "%-10s   %c   %2lu  %3lu.%lu  %5u\n", task->pcTaskName,
+                        rt_stats_state_char(task->eCurrentState), (unsigned long)task->uxCurrentPriority,
+                        (unsigned long)(permille / 10), (unsigned long)(permille % 10),
+                        (unsigned int)task->usStackHighWaterMark);
+    }
+    if(len < size){
+        len += snprintf(&buf[len], size - len, "Window: %lu ms\n",
+                        (unsigned long)((((uint64_t)elapsed << RT_STATS_SHIFT) * 1000) / configCPU_CLOCK_HZ));
+    }
+
+    /* The next report shows the load since this one */
+    for(i = 0; i < num; i++){
+        rt_prev[i].number = rt_status[i].xTaskNumber;
+        rt_prev[i].counter = rt_status[i].ulRunTimeCounter;
+    }
+    rt_prev_num = num;
+    rt_prev_total = total;
+
+    return (len < size) ? len : (size - 1);
+}
+
+/***********************************************************************************************************/
+/*                                       Static Function Definitions                                       */
+/***********************************************************************************************************/
+
+static uint32_t rt_stats_prev_counter(UBaseType_t number){
+
+    for(UBaseType_t i = 0; i < rt_prev_num; i++){
+        if(rt_prev[i].number == number){
+            return rt_prev[i].counter;
+        }
+    }
+
+    return 0;
+}
+
+static char rt_stats_state_char(eTaskState state){
+
+    switch(state){
+        case eRunning:
+            return 'X';
+        case eReady:
+            return 'R';
+        case eBlocked:
+            return 'B';
+        case eSuspended:
+            return 'S';
+        case eDeleted:
+            return 'D';
+        default:
+            return '?';
+    }
+}
@@ -0,0 +1,59 @@
+/********************************************************************************************************//**
+* @file rt_stats.h
+*
+* @brief Header file containing the prototypes of the APIs for the FreeRTOS run-time statistics, counted with
+* the DWT cycle counter.
+*
+* Public Functions:
+*       - void     rt_stats_init(void)
+*       - uint32_t rt_stats_counter(void)
+*       - uint32_t rt_stats_report(char* buf, uint32_t size)
+*
+* @note
+*       The run-time counter is CYCCNT extended to 64 bits and divided by 2^RT_STATS_SHIFT, so it wraps
+*       after about 25 minutes at 180 MHz instead of 24 seconds. The extension needs a call at least once per
+*       CYCCNT wrap, the tick hook does it. The load is measured in CPU cycles, so it stays right when the
+*       operating point changes.
+*/
+
+#ifndef RT_STATS_H
+#define RT_STATS_H
+
+#include <stdint.h>
+
+/** @brief CPU cycles per run-time counter unit, as a power of two */
+#define RT_STATS_SHIFT          6
+/** @brief Maximum number of tasks shown by the report */
+#define RT_STATS_MAX_TASKS      12
+/** @brief Size of a buffer big enough for the report of RT_STATS_MAX_TASKS tasks */
+#define RT_STATS_REPORT_LEN     (48 * (RT_STATS_MAX_TASKS + 2))
+
+/***********************************************************************************************************/
+/*                                       APIs Supported                                                    */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for enabling the cycle counter and starting the run-time counter, called by the kernel
+ * through portCONFIGURE_TIMER_FOR_RUN_TIME_STATS when the scheduler starts.
+ * @return None
+ */
+void rt_stats_init(void);
+
+/**
+ * @brief Function for getting the run-time counter, called by the kernel through
+ * portGET_RUN_TIME_COUNTER_VALUE. It can be called from tasks and interrupts.
+ * @return run-time counter in units of 2^RT_STATS_SHIFT cycles.
+ */
+uint32_t rt_stats_counter(void);
+
+/**
+ * @brief Function for writing a table with the tasks sorted by CPU load, with their state, priority and
+ * stack high-water mark. The load is measured since the previous report, or since boot for the first one.
+ * @param[out] buf is the buffer for the text, RT_STATS_REPORT_LEN bytes are enough.
+ * @param[in] size is the size of the buffer.
+ * @return length of the text, without the terminating '\0'.
+ * @note It is not reentrant, only one task should call it.
+ */
+uint32_t rt_stats_report(char* buf, uint32_t size);
+
+#endif /* RT_STATS_H */
@@ -0,0 +1,109 @@
+/********************************************************************************************************//**
+* @file bkp_driver.c
+*
+* @brief File containing the APIs for using the backup domain (RTC backup registers and backup SRAM) as
+* persistent storage.
+*
+* Public Functions:
+*       - void     BKP_Init(void)
+*       - void     BKP_WriteReg(uint8_t reg, uint32_t value)
+*       - uint32_t BKP_ReadReg(uint8_t reg)
+*       - uint8_t  BKP_WriteRecord(uint16_t version, const void* data, uint16_t len)
+*       - uint8_t  BKP_ReadRecord(uint16_t version, void* data, uint16_t len)
+*       - void     BKP_EraseRecord(void)
+*
+* @note
+*       For further information about functions refer to the corresponding header file.
+*/
+
+#include "bkp_driver.h"
+#include "crc_driver.h"
+#include "stm32f446xx.h"
+#include <stdint.h>
+
+/** @brief Header of the record, placed at the beginning of the backup SRAM */
+#define BKP_HEADER          ((volatile BKP_Header_t*)BKPSRAM_BASEADDR)
+/** @brief Data of the record, placed just after the header */
+#define BKP_DATA            ((volatile uint8_t*)(BKPSRAM_BASEADDR + sizeof(BKP_Header_t)))
+
+/***********************************************************************************************************/
+/*                                       Public API Definitions                                            */
+/***********************************************************************************************************/
+
+void BKP_Init(void){
+
+    /* Disable backup domain write protection */
+    PWR_PCLK_EN();
+    PWR->CR |= (1 << PWR_CR_DBP);
+
+    /* Enable backup SRAM clock and backup regulator */
+    BKPSRAM_PCLK_EN();
+    PWR->CSR |= (1 << PWR_CSR_BRE);
+    while(!(PWR->CSR & (1 << PWR_CSR_BRR)));
+}
+
+void BKP_WriteReg(uint8_t reg, uint32_t value){
+
+    if(reg < BKP_NUM_REG){
+        RTC->BKPxR[reg] = value;
+    }
+}
+
+uint32_t BKP_ReadReg(uint8_t reg){
+
+    uint32_t ret = 0;
+
+    if(reg < BKP_NUM_REG){
+        ret = RTC->BKPxR[reg];
+    }
+
+    return ret;
+}
+
+uint8_t BKP_WriteRecord(uint16_t version, const void* data, uint16_t len){
+
+    const uint8_t* p = (const uint8_t*)data;
+
+    if((len == 0) || (len > BKP_RECORD_MAX_LEN)){
+        return 1;
+    }
+
+    /* Invalidate the record first, so a reset while writing never leaves a valid but partial record */
+    BKP_HEADER->magic = 0;
+
+    for(uint16_t i = 0; i < len; i++){
+        BKP_DATA[i] = p[i];
+    }
+
+    BKP_HEADER->version = version;
+    BKP_HEADER->len = len;
+    BKP_HEADER->crc = CRC_Bytes(CRC_INIT_VALUE, (const void*)BKP_DATA, len);
+    BKP_HEADER->magic = BKP_RECORD_MAGIC;
+
+    return 0;
+}
+
+uint8_t BKP_ReadRecord(uint16_t version, void* data, uint16_t len){
+
+    uint8_t* p = (uint8_t*)data;
+
+    if((BKP_HEADER->magic != BKP_RECORD_MAGIC) || (BKP_HEADER->version != version) ||
+       (BKP_HEADER->len != len)){
+        return 1;
+    }
+
+    if(BKP_HEADER->crc != CRC_Bytes(CRC_INIT_VALUE, (const void*)BKP_DATA, len)){
+        return 1;
+    }
+
+    for(uint16_t i = 0; i < len; i++){
+        p[i] = BKP_DATA[i];
+    }
+
+    return 0;
+}
+
+void BKP_EraseRecord(void){
+
+    BKP_HEADER->magic = 0;
+}
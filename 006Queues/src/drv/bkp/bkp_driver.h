@@ -0,0 +1,91 @@
+/********************************************************************************************************//**
+* @file bkp_driver.h
+*
+* @brief Header file containing the prototypes of the APIs for using the backup domain (RTC backup registers
+* and backup SRAM) as persistent storage.
+*
+* Public Functions:
+*       - void     BKP_Init(void)
+*       - void     BKP_WriteReg(uint8_t reg, uint32_t value)
+*       - uint32_t BKP_ReadReg(uint8_t reg)
+*       - uint8_t  BKP_WriteRecord(uint16_t version, const void* data, uint16_t len)
+*       - uint8_t  BKP_ReadRecord(uint16_t version, void* data, uint16_t len)
+*       - void     BKP_EraseRecord(void)
+*/
+
+#ifndef BKP_DRIVER_H
+#define BKP_DRIVER_H
+
+#include <stdint.h>
+
+/** @brief Number of RTC backup registers */
+#define BKP_NUM_REG         20
+/** @brief Value stored in the record header for identifying a valid record */
+#define BKP_RECORD_MAGIC    0x424B5053U
+/** @brief Maximum size in bytes of the record stored in the backup SRAM (4KB minus the header) */
+#define BKP_RECORD_MAX_LEN  (4096 - sizeof(BKP_Header_t))
+
+/**
+ * @brief Header stored in front of the record in the backup SRAM.
+ */
+typedef struct
+{
+    uint32_t magic;                 /**< @ref BKP_RECORD_MAGIC when the record is valid */
+    uint16_t version;               /**< Version of the record layout */
+    uint16_t len;                   /**< Length of the record in bytes */
+    uint32_t crc;                   /**< CRC-32 of the record data */
+}BKP_Header_t;
+
+/***********************************************************************************************************/
+/*                                       APIs Supported                                                    */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function to enable the access to the backup domain and the backup SRAM.
+ * @return void
+ * @note The backup regulator is enabled, so the backup SRAM content is also kept in VBAT mode.
+ */
+void BKP_Init(void);
+
+/**
+ * @brief Function to write a RTC backup register.
+ * @param[in] reg is the backup register number (0 to 19).
+ * @param[in] value is the value to be written.
+ * @return void
+ */
+void BKP_WriteReg(uint8_t reg, uint32_t value);
+
+/**
+ * @brief Function to read a RTC backup register.
+ * @param[in] reg is the backup register number (0 to 19).
+ * @return value of the register, 0 if the register number is not valid.
+ */
+uint32_t BKP_ReadReg(uint8_t reg);
+
+/**
+ * @brief Function to store a record in the backup SRAM.
+ * @param[in] version is the version of the record layout.
+ * @param[in] data is a pointer to the record.
+ * @param[in] len is the length of the record in bytes.
+ * @return 0 if the record was stored.
+ * @return 1 if the length is not valid.
+ */
+uint8_t BKP_WriteRecord(uint16_t version, const void* data, uint16_t len);
+
+/**
+ * @brief Function to read a record from the backup SRAM.
+ * @param[in] version is the expected version of the record layout.
+ * @param[out] data is a pointer where the record is copied.
+ * @param[in] len is the expected length of the record in bytes.
+ * @return 0 if the record is valid and it was copied.
+ * @return 1 if there is no record, the version or length do not match or the CRC is wrong.
+ */
+uint8_t BKP_ReadRecord(uint16_t version, void* data, uint16_t len);
+
+/**
+ * @brief Function to invalidate the record stored in the backup SRAM.
+ * @return void
+ */
+void BKP_EraseRecord(void);
+
+#endif /* BKP_DRIVER_H */
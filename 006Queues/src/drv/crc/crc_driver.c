@@ -0,0 +1,309 @@
+/********************************************************************************************************//**
+* @file crc_driver.c
+*
+* @brief File containing the APIs for calculating CRC-32 with the CRC peripheral.
+*
+* Public Functions:
+*       - void     CRC_Init(void)
+*       - uint32_t CRC_Words(uint32_t crc, const uint32_t* data, uint32_t len)
+*       - uint32_t CRC_Bytes(uint32_t crc, const void* data, uint32_t len)
+*       - uint8_t  CRC_WordsDMA(uint32_t crc, const uint32_t* data, uint16_t len)
+*       - void     CRC_IRQConfig(uint8_t en_or_di)
+*       - void     CRC_IRQPriorityConfig(uint32_t IRQPriority)
+*       - void     CRC_ApplicationEventCallback(CRC_Event_t crc_event, uint32_t crc)
+*
+* @note
+*       For further information about functions refer to the corresponding header file.
+*/
+
+#include "crc_driver.h"
+#include "stm32f446xx.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef CRC_SOFTWARE
+#include "dma_driver.h"
+
+/** @brief 1 while the peripheral is in use, claimed with an atomic exchange so no critical section is needed */
+static uint8_t CRC_Busy = 0;
+
+/** @brief DMA stream feeding the data register, in memory-to-memory mode the peripheral port is the source */
+static DMA_Handle_t CRC_DMAHandle = {
+    .DMA_Config = {
+        .DMA_Request = DMA_REQ_MEM2MEM,
+        .DMA_Direction = DMA_DIR_M2M,
+        .DMA_Mode = DMA_MODE_NORMAL,
+        .DMA_PeriphSize = DMA_SIZE_WORD,
+        .DMA_MemSize = DMA_SIZE_WORD,
+        .DMA_PeriphInc = ENABLE,
+        .DMA_MemInc = DISABLE,
+        .DMA_Priority = DMA_PRIORITY_MEDIUM,
+        .DMA_FIFOThreshold = DMA_FIFO_FULL,
+        .DMA_PeriphBurst = DMA_BURST_SINGLE,
+        .DMA_MemBurst = DMA_BURST_SINGLE,
+        .DMA_HalfIT = DISABLE
+    }
+};
+#endif
+
+/***********************************************************************************************************/
+/*                                       Static Function Prototypes                                        */
+/***********************************************************************************************************/
+
+#ifndef CRC_SOFTWARE
+/**
+ * @brief Function to take the peripheral if it is free and its clock is enabled.
+ * @return 1 if the peripheral was taken, 0 if it is in use or not enabled.
+ */
+static uint8_t CRC_Claim(void);
+
+/**
+ * @brief Function to free the peripheral.
+ * @return void
+ */
+static void CRC_Release(void);
+
+/**
+ * @brief Function to reset the peripheral and load a CRC value in it, so the next words continue that CRC.
+ * @param[in] crc is the value to be loaded.
+ * @return void
+ */
+static void CRC_Seed(uint32_t crc);
+
+/**
+ * @brief Function to manage the events of the DMA stream.
+ * @param[in] pDMAHandle handle structure of the stream.
+ * @param[in] app_event is the DMA event.
+ * @return void
+ */
+static void CRC_DMAEventCallback(DMA_Handle_t* pDMAHandle, uint8_t app_event);
+#endif
+
+/**
+ * @brief Function to add a 32-bit word to a CRC in software, most significant bit first as the peripheral.
+ * @param[in] crc is the current CRC value.
+ * @param[in] word is the word to be added.
+ * @return CRC value.
+ */
+static uint32_t CRC_SoftWord(uint32_t crc, uint32_t word);
+
+/**
+ * @brief Function to add a byte to a CRC in software.
+ * @param[in] crc is the current CRC value.
+ * @param[in] byte is the byte to be added.
+ * @return CRC value.
+ */
+static uint32_t CRC_SoftByte(uint32_t crc, uint8_t byte);
+
+/**
+ * @brief Function to read four bytes as a big-endian word, so the peripheral processes them in stream order.
+ * @param[in] p is a pointer to the bytes, it does not need to be aligned.
+ * @return word value.
+ */
+static uint32_t CRC_LoadBE(const uint8_t* p);
+
+/***********************************************************************************************************/
+/*                                       Public API Definitions                                            */
+/***********************************************************************************************************/
+
+void CRC_Init(void){
+
+#ifndef CRC_SOFTWARE
+    CRC_PCLK_EN();
+    /* If no stream is free CRC_WordsDMA always fails, the other functions do not need it */
+    CRC_DMAHandle.Callback = CRC_DMAEventCallback;
+    DMA_Alloc(&CRC_DMAHandle);
+#endif
+}
+
+uint32_t CRC_Words(uint32_t crc, const uint32_t* data, uint32_t len){
+
+    uint32_t i = 0;
+
+#ifndef CRC_SOFTWARE
+    if((len > 0) && CRC_Claim()){
+        CRC_Seed(crc);
+        for(; i < len; i++){
+            CRC->DR = data[i];
+        }
+        crc = CRC->DR;
+        CRC_Release();
+    }
+#endif
+
+    /* Software fallback, only when the peripheral is in use or not available */
+    for(; i < len; i++){
+        crc = CRC_SoftWord(crc, data[i]);
+    }
+
+    return crc;
+}
+
+uint32_t CRC_Bytes(uint32_t crc, const void* data, uint32_t len){
+
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t i = 0;
+
+#ifndef CRC_SOFTWARE
+    if((len >= 4) && CRC_Claim()){
+        CRC_Seed(crc);
+        for(; (i + 4) <= len; i += 4){
+            CRC->DR = CRC_LoadBE(&p[i]);
+        }
+        crc = CRC->DR;
+        CRC_Release();
+    }
+#endif
+
+    for(; (i + 4) <= len; i += 4){
+        crc = CRC_SoftWord(crc, CRC_LoadBE(&p[i]));
+    }
+    /* The peripheral only takes words, the last bytes are always added in software */
+    for(; i < len; i++){
+        crc = CRC_SoftByte(crc, p[i]);
+    }
+
+    return crc;
+}
+
+uint8_t CRC_WordsDMA(uint32_t crc, const uint32_t* data, uint16_t len){
+
+#ifdef CRC_SOFTWARE
+    if(len == 0){
+        return 1;
+    }
+    CRC_ApplicationEventCallback(CRC_EVENT_DMA_CMPLT, CRC_Words(crc, data, len));
+#else
+    if((len == 0) || !CRC_Claim()){
+        return 1;
+    }
+
+    CRC_Seed(crc);
+
+    if(DMA_Start(&CRC_DMAHandle, (uint32_t)data, (void*)&CRC->DR, NULL, len)){
+        CRC_Release();
+        return 1;
+    }
+#endif
+
+    return 0;
+}
+
+void CRC_IRQConfig(uint8_t en_or_di){
+
+#ifndef CRC_SOFTWARE
+    if(CRC_DMAHandle.pStream != NULL){
+        DMA_IRQConfig(DMA_GetIRQNumber(&CRC_DMAHandle), en_or_di);
+    }
+#endif
+}
+
+void CRC_IRQPriorityConfig(uint32_t IRQPriority){
+
+#ifndef CRC_SOFTWARE
+    if(CRC_DMAHandle.pStream != NULL){
+        DMA_IRQPriorityConfig(DMA_GetIRQNumber(&CRC_DMAHandle), IRQPriority);
+    }
+#endif
+}
+
+__attribute__((weak)) void CRC_ApplicationEventCallback(CRC_Event_t crc_event, uint32_t crc){
+
+    /* This is a weak implementation. The application may override this function */
+}
+
+/***********************************************************************************************************/
+/*                                       Static Function Definitions                                       */
+/***********************************************************************************************************/
+
+#ifndef CRC_SOFTWARE
+static uint8_t CRC_Claim(void){
+
+    /* Before CRC_Init the data register reads as 0, the software path keeps the results right */
+    if(!(RCC->AHB1ENR & (1 << 12))){
+        return 0;
+    }
+
+    return !__atomic_exchange_n(&CRC_Busy, 1, __ATOMIC_ACQUIRE);
+}
+
+static void CRC_Release(void){
+
+    __atomic_store_n(&CRC_Busy, 0, __ATOMIC_RELEASE);
+}
+
+static void CRC_Seed(uint32_t crc){
+
+    uint32_t word = crc;
+
+    CRC->CR = (1 << CRC_CR_RESET);
+    if(crc == CRC_INIT_VALUE){
+        return;
+    }
+
+    /* Undo the 32 shifts of a word, so writing it after the reset leaves crc in the data register */
+    for(uint8_t i = 0; i < 32; i++){
+        if(word & 1){
+            word = ((word ^ CRC_POLY) >> 1) | 0x80000000;
+        }
+        else{
+            word >>= 1;
+        }
+    }
+    CRC->DR = word ^ CRC_INIT_VALUE;
+}
+
+static void CRC_DMAEventCallback(DMA_Handle_t* pDMAHandle, uint8_t app_event){
+
+    uint32_t crc;
+
+    if(app_event == DMA_EVENT_CMPLT){
+        crc = CRC->DR;
+        CRC_Release();
+        CRC_ApplicationEventCallback(CRC_EVENT_DMA_CMPLT, crc);
+    }
+    else if(app_event == DMA_ERROR_TRANSFER){
+        DMA_Stop(pDMAHandle);
+        CRC_Release();
+        CRC_ApplicationEventCallback(CRC_EVENT_DMA_ERROR, 0);
+    }
+    else{
+        /* FIFO flags are not errors with the FIFO threshold used, the transfer goes on */
+    }
+}
+#endif
+
+static uint32_t CRC_SoftWord(uint32_t crc, uint32_t word){
+
+    crc ^= word;
+    for(uint8_t i = 0; i < 32; i++){
+        if(crc & 0x80000000){
+            crc = (crc << 1) ^ CRC_POLY;
+        }
+        else{
+            crc <<= 1;
+        }
+    }
+
+    return crc;
+}
+
+static uint32_t CRC_SoftByte(uint32_t crc, uint8_t byte){
+
+    crc ^= ((uint32_t)byte << 24);
+    for(uint8_t i = 0; i < 8; i++){
+        if(crc & 0x80000000){
+            crc = (crc << 1) ^ CRC_POLY;
+        }
+        else{
+            crc <<= 1;
+        }
+    }
+
+    return crc;
+}
+
+static uint32_t CRC_LoadBE(const uint8_t* p){
+
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
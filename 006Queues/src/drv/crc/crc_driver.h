@@ -0,0 +1,104 @@
+/********************************************************************************************************//**
+* @file crc_driver.h
+*
+* @brief Header file containing the prototypes of the APIs for calculating CRC-32 with the CRC peripheral.
+*
+* Public Functions:
+*       - void     CRC_Init(void)
+*       - uint32_t CRC_Words(uint32_t crc, const uint32_t* data, uint32_t len)
+*       - uint32_t CRC_Bytes(uint32_t crc, const void* data, uint32_t len)
+*       - uint8_t  CRC_WordsDMA(uint32_t crc, const uint32_t* data, uint16_t len)
+*       - void     CRC_IRQConfig(uint8_t en_or_di)
+*       - void     CRC_IRQPriorityConfig(uint32_t IRQPriority)
+*       - void     CRC_ApplicationEventCallback(CRC_Event_t crc_event, uint32_t crc)
+*
+* @note
+*       The CRC is CRC-32/MPEG-2: polynomial 0x04C11DB7, initial value 0xFFFFFFFF, no reflection nor final
+*       xor. CRC_Bytes processes a byte stream, so it gives the same result as the usual byte-wise loop.
+*       CRC_Words and CRC_WordsDMA feed each word as the peripheral does, most significant bit first, which
+*       for a little-endian buffer is not the same as CRC_Bytes over the same memory.
+*       The peripheral is used only if it is free, otherwise the result is calculated in software, so the
+*       functions can be called from any task. Defining CRC_SOFTWARE calculates everything in software, for
+*       building the users of the driver on a host.
+*/
+
+#ifndef CRC_DRIVER_H
+#define CRC_DRIVER_H
+
+#include <stdint.h>
+
+/** @brief Initial value of a CRC calculation */
+#define CRC_INIT_VALUE      0xFFFFFFFFU
+/** @brief Polynomial of the CRC peripheral */
+#define CRC_POLY            0x04C11DB7U
+
+/**
+ * @brief Possible events notified by the DMA interrupt.
+ */
+typedef enum{
+    CRC_EVENT_DMA_CMPLT,        /**< All the words were processed, the CRC is valid */
+    CRC_EVENT_DMA_ERROR         /**< The transfer was aborted due to an error */
+}CRC_Event_t;
+
+/***********************************************************************************************************/
+/*                                       APIs Supported                                                    */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function to enable the clock of the CRC peripheral and allocate a memory-to-memory DMA stream.
+ * @return void
+ */
+void CRC_Init(void);
+
+/**
+ * @brief Function to calculate the CRC of 32-bit words.
+ * @param[in] crc is the initial value, CRC_INIT_VALUE or the result of a previous call for continuing it.
+ * @param[in] data is a pointer to the words.
+ * @param[in] len is the number of words.
+ * @return CRC value.
+ */
+uint32_t CRC_Words(uint32_t crc, const uint32_t* data, uint32_t len);
+
+/**
+ * @brief Function to calculate the CRC of a byte stream, the buffer does not need to be aligned.
+ * @param[in] crc is the initial value, CRC_INIT_VALUE or the result of a previous call for continuing it.
+ * @param[in] data is a pointer to the bytes.
+ * @param[in] len is the number of bytes.
+ * @return CRC value.
+ */
+uint32_t CRC_Bytes(uint32_t crc, const void* data, uint32_t len);
+
+/**
+ * @brief Function to start the calculation of the CRC of 32-bit words fed by DMA, the CPU is free meanwhile.
+ * @param[in] crc is the initial value, CRC_INIT_VALUE or the result of a previous call for continuing it.
+ * @param[in] data is a pointer to the words, it must be valid until the operation finishes.
+ * @param[in] len is the number of words, from 1 to 65535.
+ * @return 0 if the operation was started.
+ * @return 1 if the peripheral is in use or the length is not valid.
+ * @note CRC_ApplicationEventCallback is called with CRC_EVENT_DMA_CMPLT or CRC_EVENT_DMA_ERROR.
+ */
+uint8_t CRC_WordsDMA(uint32_t crc, const uint32_t* data, uint16_t len);
+
+/**
+ * @brief Function to enable or disable the interrupt of the DMA stream allocated by CRC_Init.
+ * @param[in] en_or_di for enable or disable.
+ * @return void.
+ */
+void CRC_IRQConfig(uint8_t en_or_di);
+
+/**
+ * @brief Function to configure the IRQ priority of the DMA stream allocated by CRC_Init.
+ * @param[in] IRQPriority priority of the interrupt.
+ * @return void.
+ */
+void CRC_IRQPriorityConfig(uint32_t IRQPriority);
+
+/**
+ * @brief Function for the application to manage the end of a DMA calculation, it runs in interrupt context.
+ * @param[in] crc_event is the event which finished the operation.
+ * @param[in] crc is the CRC value, only valid with CRC_EVENT_DMA_CMPLT.
+ * @return void.
+ */
+void CRC_ApplicationEventCallback(CRC_Event_t crc_event, uint32_t crc);
+
+#endif /* CRC_DRIVER_H */
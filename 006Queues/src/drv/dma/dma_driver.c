@@ -0,0 +1,435 @@
+/********************************************************************************************************//**
+* @file dma_driver.c
+*
+* @brief File containing the APIs for configuring the DMA1 and DMA2 streams.
+*
+* Public Functions:
+*       - uint8_t  DMA_Alloc(DMA_Handle_t* pDMAHandle)
+*       - void     DMA_Free(DMA_Handle_t* pDMAHandle)
+*       - uint8_t  DMA_Start(DMA_Handle_t* pDMAHandle, uint32_t periph_addr, void* mem0, void* mem1, uint16_t len)
+*       - void     DMA_Stop(DMA_Handle_t* pDMAHandle)
+*       - uint16_t DMA_GetCount(DMA_Handle_t* pDMAHandle)
+*       - uint8_t  DMA_GetCurrentTarget(DMA_Handle_t* pDMAHandle)
+*       - uint8_t  DMA_SetMemory(DMA_Handle_t* pDMAHandle, uint8_t target, void* mem)
+*       - uint8_t  DMA_GetIRQNumber(DMA_Handle_t* pDMAHandle)
+*       - void     DMA_IRQConfig(uint8_t IRQNumber, uint8_t en_or_di)
+*       - void     DMA_IRQPriorityConfig(uint8_t IRQNumber, uint32_t IRQPriority)
+*       - void     DMA_IRQHandling(uint8_t controller, uint8_t stream)
+*       - void     DMA_ApplicationEventCallback(DMA_Handle_t* pDMAHandle, uint8_t app_event)
+*
+* @note
+*       For further information about functions refer to the corresponding header file.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include "dma_driver.h"
+
+/** @brief Number of streams of both controllers */
+#define DMA_NUM_ALL_STREAMS     (2 * DMA_NUM_STREAMS)
+/** @brief Maximum number of streams a request is mapped to */
+#define DMA_MAX_ROUTES          2
+/** @brief Flags of a stream in the interrupt status registers, relative to the first flag of the stream */
+#define DMA_STREAM_FLAGS        ((1 << DMA_LISR_FEIF0) | (1 << DMA_LISR_DMEIF0) | (1 << DMA_LISR_TEIF0) |   \
+                                 (1 << DMA_LISR_HTIF0) | (1 << DMA_LISR_TCIF0))
+
+/**
+ * @brief Structure with a stream and channel which can serve a request.
+ */
+typedef struct{
+    uint8_t controller;     /**< DMA controller, 1 or 2, 0 for an unused entry */
+    uint8_t stream;         /**< Stream number */
+    uint8_t channel;        /**< Channel selection of the stream */
+}DMA_Route_t;
+
+/** @brief Streams and channels of each request, from the request mapping tables of RM0390 */
+static const DMA_Route_t DMA_Routes[DMA_REQ_NUM][DMA_MAX_ROUTES] = {
+    [DMA_REQ_USART1_RX] = {{2, 2, 4}, {2, 5, 4}},
+    [DMA_REQ_USART1_TX] = {{2, 7, 4}},
+    [DMA_REQ_USART2_RX] = {{1, 5, 4}},
+    [DMA_REQ_USART2_TX] = {{1, 6, 4}},
+    [DMA_REQ_USART3_RX] = {{1, 1, 4}},
+    [DMA_REQ_USART3_TX] = {{1, 3, 4}, {1, 4, 7}},
+    [DMA_REQ_UART4_RX]  = {{1, 2, 4}},
+    [DMA_REQ_UART4_TX]  = {{1, 4, 4}},
+    [DMA_REQ_UART5_RX]  = {{1, 0, 4}},
+    [DMA_REQ_UART5_TX]  = {{1, 7, 4}},
+    [DMA_REQ_USART6_RX] = {{2, 1, 5}, {2, 2, 5}},
+    [DMA_REQ_USART6_TX] = {{2, 6, 5}, {2, 7, 5}},
+    [DMA_REQ_SPI1_RX]   = {{2, 0, 3}, {2, 2, 3}},
+    [DMA_REQ_SPI1_TX]   = {{2, 3, 3}, {2, 5, 3}},
+    [DMA_REQ_SPI2_RX]   = {{1, 3, 0}},
+    [DMA_REQ_SPI2_TX]   = {{1, 4, 0}},
+    [DMA_REQ_SPI3_RX]   = {{1, 0, 0}, {1, 2, 0}},
+    [DMA_REQ_SPI3_TX]   = {{1, 5, 0}, {1, 7, 0}},
+    [DMA_REQ_I2C1_RX]   = {{1, 0, 1}, {1, 5, 1}},
+    [DMA_REQ_I2C1_TX]   = {{1, 6, 1}, {1, 7, 1}},
+    [DMA_REQ_I2C2_RX]   = {{1, 2, 7}, {1, 3, 7}},
+    [DMA_REQ_I2C2_TX]   = {{1, 7, 7}},
+    [DMA_REQ_I2C3_RX]   = {{1, 2, 3}},
+    [DMA_REQ_I2C3_TX]   = {{1, 4, 3}},
+    [DMA_REQ_ADC1]      = {{2, 0, 0}, {2, 4, 0}},
+};
+
+/** @brief Streams of both controllers, indexed as DMA_Owner */
+static DMA_Stream_RegDef_t* const DMA_Streams[DMA_NUM_ALL_STREAMS] = {
+    DMA1_STR0, DMA1_STR1, DMA1_STR2, DMA1_STR3, DMA1_STR4, DMA1_STR5, DMA1_STR6, DMA1_STR7,
+    DMA2_STR0, DMA2_STR1, DMA2_STR2, DMA2_STR3, DMA2_STR4, DMA2_STR5, DMA2_STR6, DMA2_STR7
+};
+
+/** @brief Interrupt numbers of the streams, indexed as DMA_Owner */
+static const uint8_t DMA_IRQNumbers[DMA_NUM_ALL_STREAMS] = {
+    IRQ_NO_DMA1_STREAM0, IRQ_NO_DMA1_STREAM1, IRQ_NO_DMA1_STREAM2, IRQ_NO_DMA1_STREAM3,
+    IRQ_NO_DMA1_STREAM4, IRQ_NO_DMA1_STREAM5, IRQ_NO_DMA1_STREAM6, IRQ_DMA1_STREAM7,
+    IRQ_DMA2_STREAM0, IRQ_DMA2_STREAM1, IRQ_DMA2_STREAM2, IRQ_DMA2_STREAM3,
+    IRQ_DMA2_STREAM4, IRQ_DMA2_STREAM5, IRQ_DMA2_STREAM6, IRQ_DMA2_STREAM7
+};
+
+/** @brief Offset of the first flag of each stream in the LISR/HISR and LIFCR/HIFCR registers */
+static const uint8_t DMA_FlagShift[4] = {DMA_LISR_FEIF0, DMA_LISR_FEIF1, DMA_LISR_FEIF2, DMA_LISR_FEIF3};
+
+/** @brief Handle owning each stream, DMA1 streams first, NULL if the stream is free */
+static DMA_Handle_t* DMA_Owner[DMA_NUM_ALL_STREAMS] = {NULL};
+/** @brief One bit per stream in use, claimed atomically so streams can be allocated from any context */
+static uint16_t DMA_InUse = 0;
+
+/***********************************************************************************************************/
+/*                                       Static Function Prototypes                                        */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function to take a stream if it is free.
+ * @param[in] pDMAHandle handle structure to own the stream.
+ * @param[in] controller is the DMA controller, 1 or 2.
+ * @param[in] stream is the stream number.
+ * @param[in] channel is the channel selected for the request.
+ * @return 1 if the stream was taken, 0 if it is in use.
+ */
+static uint8_t DMA_Claim(DMA_Handle_t* pDMAHandle, uint8_t controller, uint8_t stream, uint8_t channel);
+
+/**
+ * @brief Function to clear all the interrupt flags of a stream.
+ * @param[in] pDMAHandle handle structure with an allocated stream.
+ * @return void
+ */
+static void DMA_ClearFlags(DMA_Handle_t* pDMAHandle);
+
+/**
+ * @brief Function to notify an event to the callback of the handle or to the application.
+ * @param[in] pDMAHandle handle structure of the stream.
+ * @param[in] app_event possible values from @ref DMA_AppEvent.
+ * @return void
+ */
+static void DMA_Notify(DMA_Handle_t* pDMAHandle, uint8_t app_event);
+
+/***********************************************************************************************************/
+/*                                       Public API Definitions                                            */
+/***********************************************************************************************************/
+
+uint8_t DMA_Alloc(DMA_Handle_t* pDMAHandle){
+
+    const DMA_Route_t* route;
+
+    if(pDMAHandle->DMA_Config.DMA_Request >= DMA_REQ_NUM){
+        return 1;
+    }
+
+    if(pDMAHandle->DMA_Config.DMA_Request == DMA_REQ_MEM2MEM){
+        /* Any DMA2 stream can do it, the last ones are the least used by the peripherals */
+        for(int8_t stream = DMA_NUM_STREAMS - 1; stream >= 0; stream--){
+            if(DMA_Claim(pDMAHandle, 2, stream, 0)){
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    for(uint8_t i = 0; i < DMA_MAX_ROUTES; i++){
+        route = &DMA_Routes[pDMAHandle->DMA_Config.DMA_Request][i];
+        if((route->controller != 0) && DMA_Claim(pDMAHandle, route->controller, route->stream, route->channel)){
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+void DMA_Free(DMA_Handle_t* pDMAHandle){
+
+    uint8_t index;
+
+    if(pDMAHandle->pStream == NULL){
+        return;
+    }
+
+    DMA_Stop(pDMAHandle);
+
+    index = ((pDMAHandle->Controller - 1) * DMA_NUM_STREAMS) + pDMAHandle->Stream;
+    DMA_Owner[index] = NULL;
+    pDMAHandle->pStream = NULL;
+    __atomic_fetch_and(&DMA_InUse, (uint16_t)~(1 << index), __ATOMIC_RELEASE);
+}
+
+uint8_t DMA_Start(DMA_Handle_t* pDMAHandle, uint32_t periph_addr, void* mem0, void* mem1, uint16_t len){
+
+    DMA_Stream_RegDef_t* pStream = pDMAHandle->pStream;
+    DMA_Config_t* cfg = &pDMAHandle->DMA_Config;
+    uint8_t direct = (cfg->DMA_FIFOThreshold == DMA_FIFO_DIRECT);
+    uint32_t cr;
+
+    if((pStream == NULL) || (len == 0) || (pStream->CR & (1 << DMA_SCR_EN))){
+        return 1;
+    }
+    /* Memory-to-memory needs the FIFO and stops after the last data */
+    if((cfg->DMA_Direction == DMA_DIR_M2M) && (direct || (cfg->DMA_Mode != DMA_MODE_NORMAL) ||
+                                               (pDMAHandle->Controller != 2))){
+        return 1;
+    }
+    /* Bursts are only possible through the FIFO */
+    if(direct && ((cfg->DMA_PeriphBurst != DMA_BURST_SINGLE) || (cfg->DMA_MemBurst != DMA_BURST_SINGLE))){
+        return 1;
+    }
+    if((cfg->DMA_Mode == DMA_MODE_DBL_BUFFER) && (mem1 == NULL)){
+        return 1;
+    }
+
+    DMA_ClearFlags(pDMAHandle);
+
+    pStream->PAR = periph_addr;
+    pStream->M0AR = (uint32_t)mem0;
+    pStream->M1AR = (uint32_t)mem1;
+    pStream->NDTR = len;
+
+    if(direct){
+        pStream->FCR = 0;
+    }
+    else{
+        pStream->FCR = (1 << DMA_SFCR_DMDIS) | (cfg->DMA_FIFOThreshold << DMA_SFCR_FTH) | (1 << DMA_SFCR_FEIE);
+    }
+
+    cr = (pDMAHandle->Channel << DMA_SCR_CHSEL) | (cfg->DMA_MemBurst << DMA_SCR_MBURST) |
+         (cfg->DMA_PeriphBurst << DMA_SCR_PBURST) | (cfg->DMA_Priority << DMA_SCR_PL) |
+         (cfg->DMA_MemSize << DMA_SCR_MSIZE) | (cfg->DMA_PeriphSize << DMA_SCR_PSIZE) |
+         (cfg->DMA_Direction << DMA_SCR_DIR) | (1 << DMA_SCR_TCIE) | (1 << DMA_SCR_TEIE);
+    if(cfg->DMA_MemInc == ENABLE){
+        cr |= (1 << DMA_SCR_MINC);
+    }
+    if(cfg->DMA_PeriphInc == ENABLE){
+        cr |= (1 << DMA_SCR_PINC);
+    }
+    if(cfg->DMA_Mode == DMA_MODE_CIRCULAR){
+        cr |= (1 << DMA_SCR_CIRC);
+    }
+    else if(cfg->DMA_Mode == DMA_MODE_DBL_BUFFER){
+        /* The stream starts with mem0 */
+        cr |= (1 << DMA_SCR_DBM) | (1 << DMA_SCR_CIRC);
+    }
+    else{
+        /* do nothing */
+    }
+    if(cfg->DMA_HalfIT == ENABLE){
+        cr |= (1 << DMA_SCR_HTIE);
+    }
+    if(direct){
+        cr |= (1 << DMA_SCR_DMEIE);
+    }
+
+    pStream->CR = cr;
+    pStream->CR |= (1 << DMA_SCR_EN);
+
+    return 0;
+}
+
+void DMA_Stop(DMA_Handle_t* pDMAHandle){
+
+    DMA_Stream_RegDef_t* pStream = pDMAHandle->pStream;
+
+    if(pStream == NULL){
+        return;
+    }
+
+    pStream->CR &= ~((1 << DMA_SCR_TCIE) | (1 << DMA_SCR_HTIE) | (1 << DMA_SCR_TEIE) | (1 << DMA_SCR_DMEIE));
+    pStream->CR &= ~(1 << DMA_SCR_EN);
+    /* EN reads as 1 until the current data item is finished */
+    while(pStream->CR & (1 << DMA_SCR_EN));
+    DMA_ClearFlags(pDMAHandle);
+}
+
+uint16_t DMA_GetCount(DMA_Handle_t* pDMAHandle){
+
+    return (uint16_t)pDMAHandle->pStream->NDTR;
+}
+
+uint8_t DMA_GetCurrentTarget(DMA_Handle_t* pDMAHandle){
+
+    return (pDMAHandle->pStream->CR >> DMA_SCR_CT) & 0x1;
+}
+
+uint8_t DMA_SetMemory(DMA_Handle_t* pDMAHandle, uint8_t target, void* mem){
+
+    DMA_Stream_RegDef_t* pStream = pDMAHandle->pStream;
+
+    /* Writing the address in use while the stream is enabled is not allowed */
+    if((pStream->CR & (1 << DMA_SCR_EN)) && (DMA_GetCurrentTarget(pDMAHandle) == target)){
+        return 1;
+    }
+
+    if(target == 0){
+        pStream->M0AR = (uint32_t)mem;
+    }
+    else{
+        pStream->M1AR = (uint32_t)mem;
+    }
+
+    return 0;
+}
+
+uint8_t DMA_GetIRQNumber(DMA_Handle_t* pDMAHandle){
+
+    return DMA_IRQNumbers[((pDMAHandle->Controller - 1) * DMA_NUM_STREAMS) + pDMAHandle->Stream];
+}
+
+void DMA_IRQConfig(uint8_t IRQNumber, uint8_t en_or_di){
+
+    if(en_or_di == ENABLE){
+        if(IRQNumber <= 31){
+            /* Program ISER0 register */
+            *NVIC_ISER0 |= (1 << IRQNumber);
+        }
+        else if(IRQNumber > 31 && IRQNumber < 64){
+            /* Program ISER1 register */
+            *NVIC_ISER1 |= (1 << (IRQNumber % 32));
+        }
+        else if(IRQNumber >= 64 && IRQNumber < 96){
+            /* Program ISER2 register */
+            *NVIC_ISER2 |= (1 << (IRQNumber % 64));
+        }
+        else{
+            /* do nothing */
+        }
+    }
+    else{
+        if(IRQNumber <= 31){
+            /* Program ICER0 register */
+            *NVIC_ICER0 |= (1 << IRQNumber);
+        }
+        else if(IRQNumber > 31 && IRQNumber < 64){
+            /* Program ICER1 register */
+            *NVIC_ICER1 |= (1 << (IRQNumber % 32));
+        }
+        else if(IRQNumber >= 64 && IRQNumber < 96){
+            /* Program ICER2 register */
+            *NVIC_ICER2 |= (1 << (IRQNumber % 64));
+        }
+        else{
+            /* do nothing */
+        }
+    }
+}
+
+void DMA_IRQPriorityConfig(uint8_t IRQNumber, uint32_t IRQPriority){
+
+    /* Find out the IPR register */
+    uint8_t iprx = IRQNumber / 4;
+    uint8_t iprx_section = IRQNumber % 4;
+    uint8_t shift = (8*iprx_section) + (8 - NO_PR_BITS_IMPLEMENTED);
+
+    *(NVIC_PR_BASEADDR + iprx) |= (IRQPriority << shift);
+}
+
+void DMA_IRQHandling(uint8_t controller, uint8_t stream){
+
+    DMA_RegDef_t* pDMAx = (controller == 1) ? DMA1 : DMA2;
+    DMA_Handle_t* pDMAHandle = DMA_Owner[((controller - 1) * DMA_NUM_STREAMS) + stream];
+    uint8_t shift = DMA_FlagShift[stream % 4];
+    uint32_t status;
+    uint32_t cr;
+
+    if(stream < 4){
+        status = (pDMAx->LISR >> shift) & DMA_STREAM_FLAGS;
+        pDMAx->LIFCR = status << shift;
+    }
+    else{
+        status = (pDMAx->HISR >> shift) & DMA_STREAM_FLAGS;
+        pDMAx->HIFCR = status << shift;
+    }
+
+    if(pDMAHandle == NULL){
+        return;
+    }
+
+    /* The flags are set even with the interrupt disabled, only the enabled ones are notified */
+    cr = pDMAHandle->pStream->CR;
+    if((status & (1 << DMA_LISR_TEIF0)) && (cr & (1 << DMA_SCR_TEIE))){
+        DMA_Notify(pDMAHandle, DMA_ERROR_TRANSFER);
+    }
+    if((status & (1 << DMA_LISR_DMEIF0)) && (cr & (1 << DMA_SCR_DMEIE))){
+        DMA_Notify(pDMAHandle, DMA_ERROR_DIRECT);
+    }
+    if((status & (1 << DMA_LISR_FEIF0)) && (pDMAHandle->pStream->FCR & (1 << DMA_SFCR_FEIE))){
+        DMA_Notify(pDMAHandle, DMA_ERROR_FIFO);
+    }
+    if((status & (1 << DMA_LISR_HTIF0)) && (cr & (1 << DMA_SCR_HTIE))){
+        DMA_Notify(pDMAHandle, DMA_EVENT_HALF);
+    }
+    if((status & (1 << DMA_LISR_TCIF0)) && (cr & (1 << DMA_SCR_TCIE))){
+        DMA_Notify(pDMAHandle, DMA_EVENT_CMPLT);
+    }
+}
+
+__attribute__((weak)) void DMA_ApplicationEventCallback(DMA_Handle_t* pDMAHandle, uint8_t app_event){
+
+    /* This is a weak implementation. The application may override this function */
+}
+
+/***********************************************************************************************************/
+/*                                       Static Function Definitions                                       */
+/***********************************************************************************************************/
+
+static uint8_t DMA_Claim(DMA_Handle_t* pDMAHandle, uint8_t controller, uint8_t stream, uint8_t channel){
+
+    uint8_t index = ((controller - 1) * DMA_NUM_STREAMS) + stream;
+    uint16_t bit = (uint16_t)(1 << index);
+
+    if(__atomic_fetch_or(&DMA_InUse, bit, __ATOMIC_ACQUIRE) & bit){
+        return 0;
+    }
+
+    if(controller == 1){
+        DMA1_PCLK_EN();
+    }
+    else{
+        DMA2_PCLK_EN();
+    }
+
+    pDMAHandle->pStream = DMA_Streams[index];
+    pDMAHandle->Controller = controller;
+    pDMAHandle->Stream = stream;
+    pDMAHandle->Channel = channel;
+    DMA_Owner[index] = pDMAHandle;
+
+    return 1;
+}
+
+static void DMA_ClearFlags(DMA_Handle_t* pDMAHandle){
+
+    DMA_RegDef_t* pDMAx = (pDMAHandle->Controller == 1) ? DMA1 : DMA2;
+    uint32_t flags = DMA_STREAM_FLAGS << DMA_FlagShift[pDMAHandle->Stream % 4];
+
+    if(pDMAHandle->Stream < 4){
+        pDMAx->LIFCR = flags;
+    }
+    else{
+        pDMAx->HIFCR = flags;
+    }
+}
+
+static void DMA_Notify(DMA_Handle_t* pDMAHandle, uint8_t app_event){
+
+    if(pDMAHandle->Callback != NULL){
+        pDMAHandle->Callback(pDMAHandle, app_event);
+    }
+    else{
+        DMA_ApplicationEventCallback(pDMAHandle, app_event);
+    }
+}
@@ -0,0 +1,274 @@
+/********************************************************************************************************//**
+* @file dma_driver.h
+*
+* @brief Header file containing the prototypes of the APIs for configuring the DMA1 and DMA2 streams.
+*
+* Public Functions:
+*       - uint8_t  DMA_Alloc(DMA_Handle_t* pDMAHandle)
+*       - void     DMA_Free(DMA_Handle_t* pDMAHandle)
+*       - uint8_t  DMA_Start(DMA_Handle_t* pDMAHandle, uint32_t periph_addr, void* mem0, void* mem1, uint16_t len)
+*       - void     DMA_Stop(DMA_Handle_t* pDMAHandle)
+*       - uint16_t DMA_GetCount(DMA_Handle_t* pDMAHandle)
+*       - uint8_t  DMA_GetCurrentTarget(DMA_Handle_t* pDMAHandle)
+*       - uint8_t  DMA_SetMemory(DMA_Handle_t* pDMAHandle, uint8_t target, void* mem)
+*       - uint8_t  DMA_GetIRQNumber(DMA_Handle_t* pDMAHandle)
+*       - void     DMA_IRQConfig(uint8_t IRQNumber, uint8_t en_or_di)
+*       - void     DMA_IRQPriorityConfig(uint8_t IRQNumber, uint32_t IRQPriority)
+*       - void     DMA_IRQHandling(uint8_t controller, uint8_t stream)
+*       - void     DMA_ApplicationEventCallback(DMA_Handle_t* pDMAHandle, uint8_t app_event)
+*
+* @note
+*       A stream is not chosen by the user but allocated from the peripheral request of the handle, looking
+*       for a free stream among the ones mapped to that request. The interrupt handler of every stream must
+*       call DMA_IRQHandling, which finds the handle owning the stream.
+*       As several drivers may share the streams, a handle can have its own callback. If it has none,
+*       DMA_ApplicationEventCallback is called.
+*/
+
+#ifndef DMA_DRIVER_H
+#define DMA_DRIVER_H
+
+#include <stdint.h>
+#include "stm32f446xx.h"
+
+/** @brief Number of streams of each DMA controller */
+#define DMA_NUM_STREAMS     8
+
+/**
+ * @brief Peripheral requests which can be served by a stream.
+ */
+typedef enum{
+    DMA_REQ_MEM2MEM,    /**< Memory-to-memory transfer, only DMA2 */
+    DMA_REQ_USART1_RX,  /**< USART1 reception */
+    DMA_REQ_USART1_TX,  /**< USART1 transmission */
+    DMA_REQ_USART2_RX,  /**< USART2 reception */
+    DMA_REQ_USART2_TX,  /**< USART2 transmission */
+    DMA_REQ_USART3_RX,  /**< USART3 reception */
+    DMA_REQ_USART3_TX,  /**< USART3 transmission */
+    DMA_REQ_UART4_RX,   /**< UART4 reception */
+    DMA_REQ_UART4_TX,   /**< UART4 transmission */
+    DMA_REQ_UART5_RX,   /**< UART5 reception */
+    DMA_REQ_UART5_TX,   /**< UART5 transmission */
+    DMA_REQ_USART6_RX,  /**< USART6 reception */
+    DMA_REQ_USART6_TX,  /**< USART6 transmission */
+    DMA_REQ_SPI1_RX,    /**< SPI1 reception */
+    DMA_REQ_SPI1_TX,    /**< SPI1 transmission */
+    DMA_REQ_SPI2_RX,    /**< SPI2 reception */
+    DMA_REQ_SPI2_TX,    /**< SPI2 transmission */
+    DMA_REQ_SPI3_RX,    /**< SPI3 reception */
+    DMA_REQ_SPI3_TX,    /**< SPI3 transmission */
+    DMA_REQ_I2C1_RX,    /**< I2C1 reception */
+    DMA_REQ_I2C1_TX,    /**< I2C1 transmission */
+    DMA_REQ_I2C2_RX,    /**< I2C2 reception */
+    DMA_REQ_I2C2_TX,    /**< I2C2 transmission */
+    DMA_REQ_I2C3_RX,    /**< I2C3 reception */
+    DMA_REQ_I2C3_TX,    /**< I2C3 transmission */
+    DMA_REQ_ADC1,       /**< ADC1 conversions */
+    DMA_REQ_NUM         /**< Number of requests, not a valid request */
+}DMA_Request_t;
+
+/**
+ * @defgroup DMA_Direction DMA possible transfer directions.
+ * @{
+ */
+#define DMA_DIR_P2M         0   /**< @brief Peripheral to memory */
+#define DMA_DIR_M2P         1   /**< @brief Memory to peripheral */
+#define DMA_DIR_M2M         2   /**< @brief Memory to memory, the peripheral port is the source */
+/** @} */
+
+/**
+ * @defgroup DMA_Mode DMA possible transfer modes.
+ * @{
+ */
+#define DMA_MODE_NORMAL     0   /**< @brief The stream stops after the last data */
+#define DMA_MODE_CIRCULAR   1   /**< @brief The stream reloads and goes on after the last data */
+#define DMA_MODE_DBL_BUFFER 2   /**< @brief Circular mode switching between two memory buffers */
+/** @} */
+
+/**
+ * @defgroup DMA_Size DMA possible data sizes.
+ * @{
+ */
+#define DMA_SIZE_BYTE       0   /**< @brief 8-bit data */
+#define DMA_SIZE_HALFWORD   1   /**< @brief 16-bit data */
+#define DMA_SIZE_WORD       2   /**< @brief 32-bit data */
+/** @} */
+
+/**
+ * @defgroup DMA_Priority DMA possible stream priorities.
+ * @{
+ */
+#define DMA_PRIORITY_LOW    0   /**< @brief Low priority */
+#define DMA_PRIORITY_MEDIUM 1   /**< @brief Medium priority */
+#define DMA_PRIORITY_HIGH   2   /**< @brief High priority */
+#define DMA_PRIORITY_VHIGH  3   /**< @brief Very high priority */
+/** @} */
+
+/**
+ * @defgroup DMA_FIFO DMA possible FIFO thresholds.
+ * @{
+ */
+#define DMA_FIFO_1_4        0   /**< @brief FIFO drained at 1/4 full */
+#define DMA_FIFO_1_2        1   /**< @brief FIFO drained at 1/2 full */
+#define DMA_FIFO_3_4        2   /**< @brief FIFO drained at 3/4 full */
+#define DMA_FIFO_FULL       3   /**< @brief FIFO drained when full */
+#define DMA_FIFO_DIRECT     4   /**< @brief FIFO not used, direct mode */
+/** @} */
+
+/**
+ * @defgroup DMA_Burst DMA possible burst sizes.
+ * @{
+ */
+#define DMA_BURST_SINGLE    0   /**< @brief Single transfer */
+#define DMA_BURST_INC4      1   /**< @brief Burst of 4 beats */
+#define DMA_BURST_INC8      2   /**< @brief Burst of 8 beats */
+#define DMA_BURST_INC16     3   /**< @brief Burst of 16 beats */
+/** @} */
+
+/**
+ * @defgroup DMA_AppEvent DMA possible application events
+ * @{
+ */
+#define DMA_EVENT_HALF          0   /**< @brief Half of the data transferred */
+#define DMA_EVENT_CMPLT         1   /**< @brief All the data transferred, or a buffer in double-buffer mode */
+#define DMA_ERROR_TRANSFER      2   /**< @brief Bus error, the stream was disabled */
+#define DMA_ERROR_DIRECT        3   /**< @brief Direct mode error */
+#define DMA_ERROR_FIFO          4   /**< @brief FIFO overrun or underrun, the transfer goes on */
+/** @} */
+
+/**
+ * @brief Configuration structure for a DMA stream.
+ */
+typedef struct
+{
+    DMA_Request_t DMA_Request;      /**< Peripheral request served by the stream */
+    uint8_t DMA_Direction;          /**< Possible values from @ref DMA_Direction */
+    uint8_t DMA_Mode;               /**< Possible values from @ref DMA_Mode */
+    uint8_t DMA_PeriphSize;         /**< Possible values from @ref DMA_Size */
+    uint8_t DMA_MemSize;            /**< Possible values from @ref DMA_Size */
+    uint8_t DMA_PeriphInc;          /**< ENABLE for incrementing the peripheral address */
+    uint8_t DMA_MemInc;             /**< ENABLE for incrementing the memory address */
+    uint8_t DMA_Priority;           /**< Possible values from @ref DMA_Priority */
+    uint8_t DMA_FIFOThreshold;      /**< Possible values from @ref DMA_FIFO */
+    uint8_t DMA_PeriphBurst;        /**< Possible values from @ref DMA_Burst, not allowed in direct mode */
+    uint8_t DMA_MemBurst;           /**< Possible values from @ref DMA_Burst, not allowed in direct mode */
+    uint8_t DMA_HalfIT;             /**< ENABLE for getting DMA_EVENT_HALF */
+}DMA_Config_t;
+
+/**
+ * @brief Handle structure for a DMA stream.
+ */
+typedef struct DMA_Handle
+{
+    DMA_Config_t DMA_Config;        /**< DMA stream configuration */
+    void (*Callback)(struct DMA_Handle* pDMAHandle, uint8_t app_event);  /**< Event callback, may be NULL */
+    void* pContext;                 /**< Pointer for the owner of the handle, not used by the driver */
+    DMA_Stream_RegDef_t* pStream;   /**< Stream allocated by DMA_Alloc, NULL if none */
+    uint8_t Controller;             /**< Controller of the stream, 1 or 2 */
+    uint8_t Stream;                 /**< Stream number, 0 to 7 */
+    uint8_t Channel;                /**< Channel selected for the request, 0 to 7 */
+}DMA_Handle_t;
+
+/***********************************************************************************************************/
+/*                                       APIs Supported                                                    */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function to allocate a free stream for the request of the handle and enable its controller clock.
+ * @param[in] pDMAHandle handle structure with the configuration, the stream fields are filled.
+ * @return 0 if a stream was allocated.
+ * @return 1 if all the streams of the request are in use.
+ */
+uint8_t DMA_Alloc(DMA_Handle_t* pDMAHandle);
+
+/**
+ * @brief Function to stop the stream of the handle and make it available again.
+ * @param[in] pDMAHandle handle structure with an allocated stream.
+ * @return void
+ */
+void DMA_Free(DMA_Handle_t* pDMAHandle);
+
+/**
+ * @brief Function to configure the stream with the handle configuration and enable it.
+ * @param[in] pDMAHandle handle structure with an allocated stream.
+ * @param[in] periph_addr is the peripheral address, or the source address in memory-to-memory mode.
+ * @param[in] mem0 is the memory buffer, or the destination in memory-to-memory mode.
+ * @param[in] mem1 is the second memory buffer in double-buffer mode, otherwise it is not used.
+ * @param[in] len is the number of data items of peripheral size, from 1 to 65535.
+ * @return 0 if the stream was started.
+ * @return 1 if the stream is not allocated, it is still enabled or the configuration is not valid.
+ */
+uint8_t DMA_Start(DMA_Handle_t* pDMAHandle, uint32_t periph_addr, void* mem0, void* mem1, uint16_t len);
+
+/**
+ * @brief Function to disable the stream, it waits until the current transfer is finished.
+ * @param[in] pDMAHandle handle structure with an allocated stream.
+ * @return void
+ */
+void DMA_Stop(DMA_Handle_t* pDMAHandle);
+
+/**
+ * @brief Function to get the number of data items still to be transferred.
+ * @param[in] pDMAHandle handle structure with an allocated stream.
+ * @return remaining data items.
+ */
+uint16_t DMA_GetCount(DMA_Handle_t* pDMAHandle);
+
+/**
+ * @brief Function to get the memory buffer being used in double-buffer mode.
+ * @param[in] pDMAHandle handle structure with an allocated stream.
+ * @return 0 if the stream is using mem0, 1 if it is using mem1.
+ */
+uint8_t DMA_GetCurrentTarget(DMA_Handle_t* pDMAHandle);
+
+/**
+ * @brief Function to change a memory buffer in double-buffer mode while the stream is running.
+ * @param[in] pDMAHandle handle structure with an allocated stream.
+ * @param[in] target is 0 for mem0 or 1 for mem1.
+ * @param[in] mem is the new buffer.
+ * @return 0 if the buffer was changed.
+ * @return 1 if the buffer is the one being used by the stream.
+ */
+uint8_t DMA_SetMemory(DMA_Handle_t* pDMAHandle, uint8_t target, void* mem);
+
+/**
+ * @brief Function to get the interrupt number of the allocated stream.
+ * @param[in] pDMAHandle handle structure with an allocated stream.
+ * @return interrupt number.
+ */
+uint8_t DMA_GetIRQNumber(DMA_Handle_t* pDMAHandle);
+
+/**
+ * @brief Function to configure the IRQ number of a DMA stream.
+ * @param[in] IRQNumber number of the interrupt, see DMA_GetIRQNumber.
+ * @param[in] en_or_di for enable or disable.
+ * @return void.
+ */
+void DMA_IRQConfig(uint8_t IRQNumber, uint8_t en_or_di);
+
+/**
+ * @brief Function to configure the IRQ priority of a DMA stream.
+ * @param[in] IRQNumber number of the interrupt, see DMA_GetIRQNumber.
+ * @param[in] IRQPriority priority of the interrupt.
+ * @return void.
+ */
+void DMA_IRQPriorityConfig(uint8_t IRQNumber, uint32_t IRQPriority);
+
+/**
+ * @brief Function to handle the interrupt of a DMA stream.
+ * @param[in] controller is the DMA controller, 1 or 2.
+ * @param[in] stream is the stream number, 0 to 7.
+ * @return void.
+ */
+void DMA_IRQHandling(uint8_t controller, uint8_t stream);
+
+/**
+ * @brief Function for the application to manage the events of the handles without callback, it runs in
+ * interrupt context.
+ * @param[in] pDMAHandle handle structure of the stream.
+ * @param[in] app_event possible values from @ref DMA_AppEvent.
+ * @return void.
+ */
+void DMA_ApplicationEventCallback(DMA_Handle_t* pDMAHandle, uint8_t app_event);
+
+#endif /* DMA_DRIVER_H */
@@ -9,6 +9,7 @@
 *       - uint8_t Flash_WriteMemoryHalfWord(uint32_t address, uint16_t data)
 *       - uint8_t Flash_WriteMemoryWord(uint32_t address, uint32_t data)
 *       - uint8_t Flash_WriteMemoryDoubleWord(uint32_t address, uint64_t data)
+*       - uint8_t Flash_Program(uint32_t address, const void* src, size_t len)
 *       - uint8_t Flash_EnRWProtection(uint8_t sectors, uint8_t protection_mode)
 *       - uint8_t Flash_DisRWProtection(void)
 *       - void    Flash_Unlock(void)
@@ -19,14 +20,60 @@
 *       - uint8_t Flash_Busy(void)
 *       - void    Flash_GetOBCfg(OPT_Cfg_t* OPTCfg)
 *       - uint8_t Flash_SetLatency(uint8_t latency)
+*       - void    Flash_ConfigAccelerator(uint8_t icache, uint8_t dcache, uint8_t prefetch)
+*       - uint8_t Flash_EraseSectorIT(uint8_t sector)
+*       - void    Flash_IRQConfig(uint8_t IRQNumber, uint8_t en_or_di)
+*       - void    Flash_IRQPriorityConfig(uint8_t IRQNumber, uint32_t IRQPriority)
+*       - void    Flash_IRQHandling(void)
+*       - void    Flash_ApplicationEventCallback(Flash_Event_t flash_event)
 *
 * @note
 *       For further information about functions refer to the corresponding header file.
 **/
 
 #include <stdint.h>
+#include <string.h>
 #include "flash_driver.h"
 
+/** @brief Mask with all the error flags of the Flash Status Register */
+#define FLASH_SR_ERRORS     ((1 << FLASH_SR_OPERR) | (1 << FLASH_SR_WRPERR) | (1 << FLASH_SR_PGAERR) | \
+                             (1 << FLASH_SR_PGPERR) | (1 << FLASH_SR_PGSERR) | (1 << FLASH_SR_RDERR))
+
+/**
+ * @brief Possible states of the flash operation handled by interrupt.
+ */
+typedef enum{
+    FLASH_IT_READY,         /**< No operation ongoing */
+    FLASH_IT_ERASE          /**< Erase ongoing */
+}Flash_ITState_t;
+
+/** @brief State of the flash operation handled by interrupt */
+static volatile Flash_ITState_t flash_it_state = FLASH_IT_READY;
+
+/***********************************************************************************************************/
+/*                                       Static Function Prototypes                                        */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for finishing the flash operation handled by interrupt.
+ * @return void.
+ */
+static void Flash_EndOperationIT(void);
+
+/**
+ * @brief Function for waiting the end of a programming operation.
+ * @return 0 if the operation was successful.
+ * @return 1 if any error flag is set.
+ */
+static uint8_t Flash_WaitProgram(void);
+
+/**
+ * @brief Function for invalidating the data cache of the flash, if it is enabled.
+ * @return void.
+ * @note Erased sectors can still be held in the data cache, the cache must be invalidated after an erase.
+ */
+static void Flash_FlushDCache(void);
+
 /***********************************************************************************************************/
 /*                                       Public API Definitions                                            */
 /***********************************************************************************************************/
@@ -58,9 +105,14 @@ uint8_t Flash_EraseSector(uint8_t sector){
     /* Wait for flash memory operation is finished */
     while(FLASHINTR->SR & (1 << FLASH_SR_BSY));
 
+    /* Clear erase bits, otherwise next programming operation fails */
+    FLASHINTR->CR &= ~((1 << FLASH_CR_SER) | (1 << FLASH_CR_MER));
+
     /* Lock Flash Control Register */
     Flash_Lock();
 
+    Flash_FlushDCache();
+
     return 0;
 }
 
@@ -83,6 +135,9 @@ uint8_t Flash_WriteMemoryByte(uint32_t address, uint8_t data){
     /* Wait for flash memory operation is finished */
     while(FLASHINTR->SR & (1 << FLASH_SR_BSY));
 
+    /* Clear Programming bit in the Flash Control Register */
+    FLASHINTR->CR &= ~(1 << FLASH_CR_PG);
+
     /*Check for any error */
     if(FLASHINTR->SR & ((1 << FLASH_SR_PGSERR) | (1 << FLASH_SR_PGPERR) | 
       (1 << FLASH_SR_PGAERR) | (1 << FLASH_SR_WRPERR))){
@@ -111,6 +166,9 @@ uint8_t Flash_WriteMemoryHalfWord(uint32_t address, uint16_t data){
     /* Wait for flash memory operation is finished */
     while(FLASHINTR->SR & (1 << FLASH_SR_BSY));
 
+    /* Clear Programming bit in the Flash Control Register */
+    FLASHINTR->CR &= ~(1 << FLASH_CR_PG);
+
     /*Check for any error */
     if(FLASHINTR->SR & ((1 << FLASH_SR_PGSERR) | (1 << FLASH_SR_PGPERR) | 
       (1 << FLASH_SR_PGAERR) | (1 << FLASH_SR_WRPERR))){
@@ -139,6 +197,9 @@ uint8_t Flash_WriteMemoryWord(uint32_t address, uint32_t data){
     /* Wait for flash memory operation is finished */
     while(FLASHINTR->SR & (1 << FLASH_SR_BSY));
 
+    /* Clear Programming bit in the Flash Control Register */
+    FLASHINTR->CR &= ~(1 << FLASH_CR_PG);
+
     /*Check for any error */
     if(FLASHINTR->SR & ((1 << FLASH_SR_PGSERR) | (1 << FLASH_SR_PGPERR) | 
       (1 << FLASH_SR_PGAERR) | (1 << FLASH_SR_WRPERR))){
@@ -168,6 +229,9 @@ uint8_t Flash_WriteMemoryDoubleWord(uint32_t address, uint64_t data){
     /* Wait for flash memory operation is finished */
     while(FLASHINTR->SR & (1 << FLASH_SR_BSY));
 
+    /* Clear Programming bit in the Flash Control Register */
+    FLASHINTR->CR &= ~(1 << FLASH_CR_PG);
+
     /*Check for any error */
     if(FLASHINTR->SR & ((1 << FLASH_SR_PGSERR) | (1 << FLASH_SR_PGPERR) | 
       (1 << FLASH_SR_PGAERR) | (1 << FLASH_SR_WRPERR))){
@@ -177,6 +241,77 @@ uint8_t Flash_WriteMemoryDoubleWord(uint32_t address, uint64_t data){
     return 0;
 }
 
+uint8_t Flash_Program(uint32_t address, const void* src, size_t len){
+
+    const uint8_t* p = (const uint8_t*)src;
+    uint32_t width = (1 << FLASH_PROGRAM_PSIZE);
+    uint32_t word[2];
+    uint8_t ret = 0;
+
+    /* Check no flash memory operation is ongoing */
+    if(FLASHINTR->SR & (1 << FLASH_SR_BSY)){
+        return 1;
+    }
+
+    Flash_Unlock();
+
+    /* Clear error flags from previous operations (write 1 to clear) */
+    FLASHINTR->SR = FLASH_SR_ERRORS;
+
+    /* Head, byte parallelism is allowed for every supply voltage */
+    Flash_SetPSIZE(FLASH_PSIZE_BYTE);
+    FLASHINTR->CR |= (1 << FLASH_CR_PG);
+    while((len > 0) && (address & (width - 1)) && !ret){
+        *(volatile uint8_t*)address = *p;
+        ret = Flash_WaitProgram();
+        address++;
+        p++;
+        len--;
+    }
+
+    /* Body, one write access of the configured width per programming operation */
+    Flash_SetPSIZE(FLASH_PROGRAM_PSIZE);
+    while((len >= width) && !ret){
+        /* The source can be unaligned, copy it before the write access */
+        memcpy(word, p, width);
+        switch(width){
+            case 2:
+                *(volatile uint16_t*)address = (uint16_t)word[0];
+                break;
+            case 4:
+                *(volatile uint32_t*)address = word[0];
+                break;
+            case 8:
+                *(volatile uint32_t*)address = word[0];
+                *(volatile uint32_t*)(address + 4) = word[1];
+                break;
+            default:
+                *(volatile uint8_t*)address = (uint8_t)word[0];
+                break;
+        }
+        ret = Flash_WaitProgram();
+        address += width;
+        p += width;
+        len -= width;
+    }
+
+    /* Tail */
+    Flash_SetPSIZE(FLASH_PSIZE_BYTE);
+    while((len > 0) && !ret){
+        *(volatile uint8_t*)address = *p;
+        ret = Flash_WaitProgram();
+        address++;
+        p++;
+        len--;
+    }
+
+    /* Clear Programming bit and lock Flash Control Register */
+    FLASHINTR->CR &= ~(1 << FLASH_CR_PG);
+    Flash_Lock();
+
+    return ret;
+}
+
 uint8_t Flash_EnRWProtection(uint8_t sectors, uint8_t protection_mode){
 
     if(protection_mode == 1){
@@ -266,6 +401,11 @@ uint8_t Flash_DisRWProtection(void){
 
 void Flash_Unlock(void){
 
+    /* A key sequence written while unlocked locks the Flash Control Register until next reset */
+    if(!(FLASHINTR->CR & (1 << FLASH_CR_LOCK))){
+        return;
+    }
+
     /* Write KEY1 and KEY2 in Flash Key Register */
     FLASHINTR->KEYR = 0x45670123;
     FLASHINTR->KEYR = 0xCDEF89AB;
@@ -293,7 +433,7 @@ void Flash_OPTLock(void){
 void Flash_SetPSIZE(flash_psize_t psize){
 
     /* Set PSIZE bits in the Flash Control Register */
-    FLASHINTR->CR &= (0x07 << FLASH_CR_PSIZE);
+    FLASHINTR->CR &= ~(0x03 << FLASH_CR_PSIZE);
     FLASHINTR->CR |= (psize << FLASH_CR_PSIZE);
 }
 
@@ -338,3 +478,164 @@ uint8_t Flash_SetLatency(uint8_t latency){
 
     return 0;
 }
+
+void Flash_ConfigAccelerator(uint8_t icache, uint8_t dcache, uint8_t prefetch){
+
+    /* Caches can only be reset while they are disabled */
+    FLASHINTR->ACR &= ~((1 << FLASH_ACR_ICEN) | (1 << FLASH_ACR_DCEN) | (1 << FLASH_ACR_PRFTEN));
+    FLASHINTR->ACR |= ((1 << FLASH_ACR_ICRST) | (1 << FLASH_ACR_DCRST));
+    FLASHINTR->ACR &= ~((1 << FLASH_ACR_ICRST) | (1 << FLASH_ACR_DCRST));
+
+    if(icache == ENABLE){
+        FLASHINTR->ACR |= (1 << FLASH_ACR_ICEN);
+    }
+    if(dcache == ENABLE){
+        FLASHINTR->ACR |= (1 << FLASH_ACR_DCEN);
+    }
+    if(prefetch == ENABLE){
+        FLASHINTR->ACR |= (1 << FLASH_ACR_PRFTEN);
+    }
+}
+
+uint8_t Flash_EraseSectorIT(uint8_t sector){
+
+    /* Check no flash memory operation is ongoing */
+    if((FLASHINTR->SR & (1 << FLASH_SR_BSY)) || (flash_it_state != FLASH_IT_READY)){
+        return 1;
+    }
+
+    /* Unlock Flash to perform erase operation */
+    Flash_Unlock();
+
+    /* Clear end of operation and error flags from previous operations (write 1 to clear) */
+    FLASHINTR->SR = ((1 << FLASH_SR_EOP) | FLASH_SR_ERRORS);
+    flash_it_state = FLASH_IT_ERASE;
+
+    if(sector != 0xFF){
+        /* Set Sector Erase bit and select the sector in Flash Control Register */
+        FLASHINTR->CR |= (1 << FLASH_CR_SER);
+        FLASHINTR->CR &= ~(0x0F << FLASH_CR_SNB);
+        FLASHINTR->CR |= ((0x07 & sector) << FLASH_CR_SNB);
+    }
+    else{
+        /* Set Mass Erase bit in Flash Control Register */
+        FLASHINTR->CR |= (1 << FLASH_CR_MER);
+    }
+
+    /* Enable end of operation and error interrupts and start */
+    FLASHINTR->CR |= ((1 << FLASH_CR_EOPIE) | (1 << FLASH_CR_ERRIE));
+    FLASHINTR->CR |= (1 << FLASH_CR_STRT);
+
+    return 0;
+}
+
+void Flash_IRQConfig(uint8_t IRQNumber, uint8_t en_or_di){
+
+    if(en_or_di == ENABLE){
+        if(IRQNumber <= 31){
+            /* Program ISER0 register */
+            *NVIC_ISER0 |= (1 << IRQNumber);
+        }
+        else if(IRQNumber > 31 && IRQNumber < 64){
+            /* Program ISER1 register */
+            *NVIC_ISER1 |= (1 << (IRQNumber % 32));
+        }
+        else if(IRQNumber >= 64 && IRQNumber < 96){
+            /* Program ISER2 register */
+            *NVIC_ISER2 |= (1 << (IRQNumber % 64));
+        }
+        else{
+            /* do nothing */
+        }
+    }
+    else{
+        if(IRQNumber <= 31){
+            /* Program ICER0 register */
+            *NVIC_ICER0 |= (1 << IRQNumber);
+        }
+        else if(IRQNumber > 31 && IRQNumber < 64){
+            /* Program ICER1 register */
+            *NVIC_ICER1 |= (1 << (IRQNumber % 32));
+        }
+        else if(IRQNumber >= 64 && IRQNumber < 96){
+            /* Program ICER2 register */
+            *NVIC_ICER2 |= (1 << (IRQNumber % 64));
+        }
+        else{
+            /* do nothing */
+        }
+    }
+}
+
+void Flash_IRQPriorityConfig(uint8_t IRQNumber, uint32_t IRQPriority){
+    /* Find out the IPR register */
+    uint8_t iprx = IRQNumber / 4;
+    uint8_t iprx_section = IRQNumber % 4;
+    uint8_t shift = (8*iprx_section) + (8 - NO_PR_BITS_IMPLEMENTED);
+
+    *(NVIC_PR_BASEADDR + iprx) |= (IRQPriority << shift);
+}
+
+void Flash_IRQHandling(void){
+
+    uint32_t status = FLASHINTR->SR;
+
+    if(status & FLASH_SR_ERRORS){
+        /* Clear flags and abort the operation */
+        FLASHINTR->SR = ((1 << FLASH_SR_EOP) | FLASH_SR_ERRORS);
+        Flash_EndOperationIT();
+        Flash_ApplicationEventCallback(FLASH_EVENT_ERROR);
+    }
+    else if(status & (1 << FLASH_SR_EOP)){
+        /* Clear end of operation flag */
+        FLASHINTR->SR = (1 << FLASH_SR_EOP);
+
+        Flash_EndOperationIT();
+        Flash_FlushDCache();
+        Flash_ApplicationEventCallback(FLASH_EVENT_ERASE_CMPLT);
+    }
+    else{
+        /* do nothing */
+    }
+}
+
+__attribute__((weak)) void Flash_ApplicationEventCallback(Flash_Event_t flash_event){
+
+    /* This is a weak implementation. The application may override this function */
+}
+
+/***********************************************************************************************************/
+/*                                       Static Function Definitions                                       */
+/***********************************************************************************************************/
+
+static void Flash_EndOperationIT(void){
+
+    /* Clear operation bits and disable interrupts */
+    FLASHINTR->CR &= ~((1 << FLASH_CR_SER) | (1 << FLASH_CR_MER) | (1 << FLASH_CR_EOPIE) | (1 << FLASH_CR_ERRIE));
+    /* Lock Flash Control Register */
+    Flash_Lock();
+    flash_it_state = FLASH_IT_READY;
+}
+
+static uint8_t Flash_WaitProgram(void){
+
+    /* Wait for flash memory operation is finished */
+    while(FLASHINTR->SR & (1 << FLASH_SR_BSY));
+
+    /*Check for any error */
+    if(FLASHINTR->SR & FLASH_SR_ERRORS){
+        return 1;
+    }
+
+    return 0;
+}
+
+static void Flash_FlushDCache(void){
+
+    if(FLASHINTR->ACR & (1 << FLASH_ACR_DCEN)){
+        FLASHINTR->ACR &= ~(1 << FLASH_ACR_DCEN);
+        FLASHINTR->ACR |= (1 << FLASH_ACR_DCRST);
+        FLASHINTR->ACR &= ~(1 << FLASH_ACR_DCRST);
+        FLASHINTR->ACR |= (1 << FLASH_ACR_DCEN);
+    }
+}
@@ -9,6 +9,7 @@
 *       - uint8_t Flash_WriteMemoryHalfWord(uint32_t address, uint16_t data)
 *       - uint8_t Flash_WriteMemoryWord(uint32_t address, uint32_t data)
 *       - uint8_t Flash_WriteMemoryDoubleWord(uint32_t address, uint64_t data)
+*       - uint8_t Flash_Program(uint32_t address, const void* src, size_t len)
 *       - uint8_t Flash_EnRWProtection(uint8_t sectors, uint8_t protection_mode)
 *       - uint8_t Flash_DisRWProtection(void)
 *       - void    Flash_Unlock(void)
@@ -19,12 +20,19 @@
 *       - uint8_t Flash_Busy(void)
 *       - void    Flash_GetOBCfg(OPT_Cfg_t* OPTCfg)
 *       - uint8_t Flash_SetLatency(uint8_t latency)
+*       - void    Flash_ConfigAccelerator(uint8_t icache, uint8_t dcache, uint8_t prefetch)
+*       - uint8_t Flash_EraseSectorIT(uint8_t sector)
+*       - void    Flash_IRQConfig(uint8_t IRQNumber, uint8_t en_or_di)
+*       - void    Flash_IRQPriorityConfig(uint8_t IRQNumber, uint32_t IRQPriority)
+*       - void    Flash_IRQHandling(void)
+*       - void    Flash_ApplicationEventCallback(Flash_Event_t flash_event)
 */
 
 #ifndef FLASH_DRIVER_H
 #define FLASH_DRIVER_H
 
 #include <stdint.h>
+#include <stddef.h>
 #include "stm32f446xx.h"
 
 /** @brief Maximum number of sectors of the Flash memory */
@@ -40,6 +48,22 @@ typedef enum{
     FLASH_PSIZE_DOUBLEWORD  = 0x03  /**< Supply voltage from 2.7V to 3.6V with external Vpp 8V to 9V */
 }flash_psize_t;
 
+/**
+ * @brief Widest parallelism allowed by the supply voltage of the board, used by Flash_Program.
+ * @note The NUCLEO-F446RE is supplied at 3.3V without external Vpp, so x32 is the widest option.
+ */
+#ifndef FLASH_PROGRAM_PSIZE
+#define FLASH_PROGRAM_PSIZE     FLASH_PSIZE_WORD
+#endif
+
+/**
+ * @brief Possible events notified by the flash interrupt.
+ */
+typedef enum{
+    FLASH_EVENT_ERASE_CMPLT,    /**< Sector or mass erase finished */
+    FLASH_EVENT_ERROR           /**< The operation was aborted due to an error */
+}Flash_Event_t;
+
 /**
  * @brief Configuration Option structure.
  */
@@ -103,6 +127,18 @@ uint8_t Flash_WriteMemoryWord(uint32_t address, uint32_t data);
  */
 uint8_t Flash_WriteMemoryDoubleWord(uint32_t address, uint64_t data);
 
+/**
+ * @brief Function to program a buffer in the flash memory.
+ * @param[in] address is the first memory address to be programmed, it can have any alignment.
+ * @param[in] src is a pointer to the data to be stored, it can have any alignment.
+ * @param[in] len is the number of bytes to be programmed.
+ * @return 0 if success.
+ * @return 1 if fail.
+ * @note The unaligned head and tail are programmed by bytes and the rest using FLASH_PROGRAM_PSIZE. The
+ *       flash is unlocked during the whole operation and PG is kept set until the last write.
+ */
+uint8_t Flash_Program(uint32_t address, const void* src, size_t len);
+
 /**
  * @brief Function to enable the read/write protection of flash sectors.
  * @param[in] sectors is the value of the nWRP byte to set in the OPTCR register.
@@ -173,4 +209,53 @@ void Flash_GetOBCfg(OPT_Cfg_t* OPTCfg);
  */
 uint8_t Flash_SetLatency(uint8_t latency);
 
+/**
+ * @brief Function for configuring the adaptive real-time memory accelerator (ART) of the flash.
+ * @param[in] icache is ENABLE or DISABLE macro for the instruction cache.
+ * @param[in] dcache is ENABLE or DISABLE macro for the data cache.
+ * @param[in] prefetch is ENABLE or DISABLE macro for the prefetch buffer.
+ * @return None.
+ * @note The caches are disabled and reset before being enabled, so no stale lines are kept from a previous
+ *       configuration. Set the latency for the new clock frequency before calling this function.
+ */
+void Flash_ConfigAccelerator(uint8_t icache, uint8_t dcache, uint8_t prefetch);
+
+/**
+ * @brief Function to start the erase of a sector of the FLASH, the end is notified by interrupt.
+ * @param[in] sector is the selected sector of the flash to be erased, 0xFF means mass erase.
+ * @return 0 if the operation was started.
+ * @return 1 if another flash operation is ongoing.
+ * @note Flash_ApplicationEventCallback is called with FLASH_EVENT_ERASE_CMPLT or FLASH_EVENT_ERROR.
+ */
+uint8_t Flash_EraseSectorIT(uint8_t sector);
+
+/**
+ * @brief Function to configure the IRQ number of the FLASH peripheral.
+ * @param[in] IRQNumber number of the interrupt.
+ * @param[in] en_or_di for enable or disable.
+ * @return void.
+ */
+void Flash_IRQConfig(uint8_t IRQNumber, uint8_t en_or_di);
+
+/**
+ * @brief Function to configure the IRQ priority of the FLASH peripheral.
+ * @param[in] IRQNumber number of the interrupt.
+ * @param[in] IRQPriority priority of the interrupt.
+ * @return void
+ */
+void Flash_IRQPriorityConfig(uint8_t IRQNumber, uint32_t IRQPriority);
+
+/**
+ * @brief Function to handle the interrupt of the FLASH peripheral.
+ * @return void.
+ */
+void Flash_IRQHandling(void);
+
+/**
+ * @brief Function for application callback.
+ * @param[in] flash_event is the event which finished the operation.
+ * @return void.
+ */
+void Flash_ApplicationEventCallback(Flash_Event_t flash_event);
+
 #endif
@@ -5,6 +5,7 @@
 *
 * Public Functions:
 *       - void PWR_SetOverDrive(void)
+*       - void PWR_ClearOverDrive(void)
 *
 * @note
 *       For further information about functions refer to the corresponding header file.
@@ -28,3 +29,10 @@ void PWR_SetOverDrive(void){
     /* Wait for the ODSWRDY flag to be set */
     while(!(PWR->CSR & (1 << PWR_CSR_ODSWRDY)));
 }
+
+void PWR_ClearOverDrive(void){
+    /* Clear ODEN and ODSWEN bits at the same time to go back to normal mode */
+    PWR->CR &= ~((1 << PWR_CR_ODEN) | (1 << PWR_CR_ODSWEN));
+    /* Wait for the ODSWRDY flag to be cleared */
+    while(PWR->CSR & (1 << PWR_CSR_ODSWRDY));
+}
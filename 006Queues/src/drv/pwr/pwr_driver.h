@@ -5,6 +5,7 @@
 *
 * Public Functions:
 *       - void PWR_SetOverDrive(void)
+*       - void PWR_ClearOverDrive(void)
 */
 
 #ifndef PWR_DRIVER_H
@@ -22,4 +23,10 @@
  */
 void PWR_SetOverDrive(void);
 
+/**
+ * @brief Function to leave the over drive power mode
+ * @note HSI or HSE must be the system clock when this function is called
+ */
+void PWR_ClearOverDrive(void);
+
 #endif
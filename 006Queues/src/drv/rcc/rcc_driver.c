@@ -10,12 +10,16 @@
 *       - uint8_t  RCC_SetSystemClock(RCC_Config_t RCC_Config)
 *       - uint8_t RCC_SetMCO1Clk(RCC_Config_t RCC_Config)
 *       - uint8_t RCC_SetMCO2Clk(RCC_Config_t RCC_Config)
+*       - const RCC_Clocks_t* RCC_GetClocks(void)
+*       - void    RCC_UpdateClocks(void)
+*       - uint8_t RCC_RegisterClockCallback(RCC_ClockCallback_t callback)
 *
 * @note
 *       For further information about functions refer to the corresponding header file.
 */
 
 #include <stdint.h>
+#include <stddef.h>
 #include "stm32f446xx.h"
 #include "rcc_driver.h"
 
@@ -31,6 +35,11 @@ static uint8_t APB_PreScaler[4] = {2, 4, 8, 16};
 /** @brief Possible PLLP prescaler values */
 static uint8_t PLLP_PreScaler[4] = {2, 4, 6, 8};
 
+/** @brief Frequencies of the clock tree, after reset the system runs from HSI without prescalers */
+static RCC_Clocks_t RCC_Clocks = {FREQ_16MHZ, FREQ_16MHZ, FREQ_16MHZ, FREQ_16MHZ, FREQ_16MHZ, FREQ_16MHZ};
+/** @brief Functions notified when the clock tree changes */
+static RCC_ClockCallback_t RCC_ClockCallbacks[RCC_MAX_CLOCK_CALLBACKS] = {0};
+
 /***********************************************************************************************************/
 /*                                       Static Function Prototypes                                        */
 /***********************************************************************************************************/
@@ -49,108 +58,24 @@ static void RCC_PLLConfig(RCC_Config_t RCC_Config);
  */
 static void RCC_PLLI2SConfig(RCC_Config_t RCC_Config);
 
+/**
+ * @brief Function for calculating the system clock from the RCC registers.
+ * @return system clock value.
+ */
+static uint32_t RCC_GetSysClk(void);
+
 /***********************************************************************************************************/
 /*                                       Public API Definitions                                            */
 /***********************************************************************************************************/
 
 uint32_t RCC_GetPCLK1Value(void){
 
-    uint32_t pclk1, systemclk, clksrc;
-    uint8_t temp;
-    uint8_t ahbp, apb1p;
-
-    /* Check for SWS */
-    clksrc = ((RCC->CFGR >> RCC_CFGR_SWS) & 0x3);
-
-    if(clksrc == 0){
-        /* clk is HSI */
-        systemclk = FREQ_16MHZ;
-    }
-    else if(clksrc == 1){
-        /* clk is HSE */
-        systemclk = FREQ_8MHZ;
-    }
-    else if(clksrc == 2){
-        /* clk is PLL */
-        systemclk = RCC_GetPLLOutputClock();
-    }
-    else{
-        /* do nothing */
-    }
-
-    /* AHB prescaler */
-    temp = ((RCC->CFGR >> RCC_CFGR_HPRE) & 0xF);
-
-    if(temp < 8){
-        ahbp = 1;
-    }
-    else{
-        ahbp = AHB_PreScaler[temp-8];
-    }
-
-    /* APB1 prescaler */
-    temp = ((RCC->CFGR >> RCC_CFGR_PPRE1) & 0x7);
-
-    if(temp < 4){
-        apb1p = 1;
-    }
-    else{
-        apb1p = APB_PreScaler[temp-4];
-    }
-
-    pclk1 = (systemclk/ahbp)/apb1p;
-
-    return pclk1;
+    return RCC_Clocks.pclk1;
 }
 
 uint32_t RCC_GetPCLK2Value(void){
 
-    uint32_t pclk2, systemclk, clksrc;
-    uint8_t temp;
-    uint8_t ahbp, apb2p;
-
-    /* Check for SWS */
-    clksrc = ((RCC->CFGR >> RCC_CFGR_SWS) & 0x3);
-
-    if(clksrc == 0){
-        /* clk is HSI */
-        systemclk = FREQ_16MHZ;
-    }
-    else if(clksrc == 1){
-        /* clk is HSE */
-        systemclk = FREQ_8MHZ;
-    }
-    else if(clksrc == 2){
-        /* clk is PLL */
-        systemclk = RCC_GetPLLOutputClock();
-    }
-    else{
-        /* do nothing */
-    }
-
-    /* AHB prescaler */
-    temp = ((RCC->CFGR >> RCC_CFGR_HPRE) & 0xF);
-
-    if(temp < 8){
-        ahbp = 1;
-    }
-    else{
-        ahbp = AHB_PreScaler[temp-8];
-    }
-
-    /* APB2 prescaler */
-    temp = ((RCC->CFGR >> RCC_CFGR_PPRE2) & 0x7);
-
-    if(temp < 4){
-        apb2p = 1;
-    }
-    else{
-        apb2p = APB_PreScaler[temp-4];
-    }
-
-    pclk2 = (systemclk/ahbp)/apb2p;
-
-    return pclk2;
+    return RCC_Clocks.pclk2;
 }
 
 uint32_t RCC_GetPLLOutputClock(void){
@@ -183,7 +108,16 @@ uint8_t RCC_SetSystemClock(RCC_Config_t RCC_Config){
         return 1;
     }
 
-    /* Set prescaler values */
+    /* Enable HSI source, it is used as system clock while the new configuration is applied */
+    RCC->CR |= (1 << RCC_CR_HSION);
+    /* Wait unitl source is ready */
+    while(!(RCC->CR & (1 << RCC_CR_HSIRDY)));
+
+    /* Clear the RCC_CFGR_SW bits before setting, HSI is selected */
+    RCC->CFGR &= ~(0x03 << RCC_CFGR_SW);
+    while(((RCC->CFGR >> RCC_CFGR_SWS) & 0x03) != 0);
+
+    /* Set prescaler values, once the system clock is HSI so buses never exceed their maximum frequency */
     /* Clear and set AHB prescaler */
     RCC->CFGR &= ~(0x0F << RCC_CFGR_HPRE);
     RCC->CFGR |= (RCC_Config.ahb_presc << RCC_CFGR_HPRE);
@@ -194,14 +128,11 @@ uint8_t RCC_SetSystemClock(RCC_Config_t RCC_Config){
     RCC->CFGR &= ~(0x07 << RCC_CFGR_PPRE2);
     RCC->CFGR |= (RCC_Config.apb2_presc << RCC_CFGR_PPRE2);
 
-    /* Clear the RCC_CFGR_SW bits before setting */
-    RCC->CFGR &= ~(0x03 << RCC_CFGR_SW);
+    /* PLL can only be configured while it is disabled, and it is not needed for HSI or HSE */
+    RCC->CR &= ~(1 << RCC_CR_PLLON);
+    while(RCC->CR & (1 << RCC_CR_PLLRDY));
 
     if(RCC_Config.clk_source == RCC_CLK_SOURCE_HSI){
-        /* Enable HSI source */
-        RCC->CR |= (1 << RCC_CR_HSION);
-        /* Wait unitl source is ready */
-        while(!(RCC->CR & (1 << RCC_CR_HSIRDY)));
         /* Disable HSE source */
         RCC->CR &= ~(1 << RCC_CR_HSEON);
     }
@@ -242,6 +173,11 @@ uint8_t RCC_SetSystemClock(RCC_Config_t RCC_Config){
         }
     }
 
+    /* Wait until the switch is done, so the frequencies are calculated from the clock actually in use */
+    while(((RCC->CFGR >> RCC_CFGR_SWS) & 0x03) != ((RCC->CFGR >> RCC_CFGR_SW) & 0x03));
+
+    RCC_UpdateClocks();
+
     return 0;
 }
 
@@ -342,6 +278,57 @@ uint8_t RCC_SetMCO2Clk(RCC_Config_t RCC_Config){
     return 0;
 }
 
+const RCC_Clocks_t* RCC_GetClocks(void){
+
+    return &RCC_Clocks;
+}
+
+void RCC_UpdateClocks(void){
+
+    uint8_t temp;
+    uint16_t ahbp;
+    uint8_t apb1p, apb2p;
+
+    RCC_Clocks.sysclk = RCC_GetSysClk();
+
+    /* AHB prescaler */
+    temp = ((RCC->CFGR >> RCC_CFGR_HPRE) & 0xF);
+    ahbp = (temp < 8) ? 1 : AHB_PreScaler[temp-8];
+
+    /* APB1 prescaler */
+    temp = ((RCC->CFGR >> RCC_CFGR_PPRE1) & 0x7);
+    apb1p = (temp < 4) ? 1 : APB_PreScaler[temp-4];
+
+    /* APB2 prescaler */
+    temp = ((RCC->CFGR >> RCC_CFGR_PPRE2) & 0x7);
+    apb2p = (temp < 4) ? 1 : APB_PreScaler[temp-4];
+
+    RCC_Clocks.hclk = RCC_Clocks.sysclk/ahbp;
+    RCC_Clocks.pclk1 = RCC_Clocks.hclk/apb1p;
+    RCC_Clocks.pclk2 = RCC_Clocks.hclk/apb2p;
+    /* Timers run at twice the APB clock when the APB prescaler is not 1 */
+    RCC_Clocks.timclk_apb1 = (apb1p == 1) ? RCC_Clocks.pclk1 : (RCC_Clocks.pclk1 * 2);
+    RCC_Clocks.timclk_apb2 = (apb2p == 1) ? RCC_Clocks.pclk2 : (RCC_Clocks.pclk2 * 2);
+
+    for(uint8_t i = 0; i < RCC_MAX_CLOCK_CALLBACKS; i++){
+        if(RCC_ClockCallbacks[i] != NULL){
+            RCC_ClockCallbacks[i](&RCC_Clocks);
+        }
+    }
+}
+
+uint8_t RCC_RegisterClockCallback(RCC_ClockCallback_t callback){
+
+    for(uint8_t i = 0; i < RCC_MAX_CLOCK_CALLBACKS; i++){
+        if((RCC_ClockCallbacks[i] == NULL) || (RCC_ClockCallbacks[i] == callback)){
+            RCC_ClockCallbacks[i] = callback;
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
 /***********************************************************************************************************/
 /*                                       Static Function Definitions                                       */
 /***********************************************************************************************************/
@@ -429,3 +416,36 @@ static void RCC_PLLI2SConfig(RCC_Config_t RCC_Config){
         /* do nothing */
     }
 }
+
+static uint32_t RCC_GetSysClk(void){
+
+    uint32_t systemclk = FREQ_16MHZ;
+    uint32_t pllin;
+    uint8_t pllm, pllr;
+    uint16_t plln;
+
+    /* Check for SWS */
+    switch((RCC->CFGR >> RCC_CFGR_SWS) & 0x3){
+        case 1:
+            /* clk is HSE */
+            systemclk = FREQ_8MHZ;
+            break;
+        case 2:
+            /* clk is PLL_P */
+            systemclk = RCC_GetPLLOutputClock();
+            break;
+        case 3:
+            /* clk is PLL_R */
+            pllm = ((RCC->PLLCFGR >> RCC_PLLCFGR_PLLM) & 0x3F);
+            plln = ((RCC->PLLCFGR >> RCC_PLLCFGR_PLLN) & 0x01FF);
+            pllr = ((RCC->PLLCFGR >> RCC_PLLCFGR_PLLR) & 0x07);
+            pllin = ((RCC->PLLCFGR >> RCC_PLLCFGR_PLLSRC) & 0x01) ? FREQ_8MHZ : FREQ_16MHZ;
+            systemclk = ((pllin/pllm)*plln)/pllr;
+            break;
+        default:
+            /* clk is HSI */
+            break;
+    }
+
+    return systemclk;
+}
@@ -10,6 +10,9 @@
 *       - uint8_t  RCC_SetSystemClock(RCC_Config_t RCC_Config)
 *       - uint8_t RCC_SetMCO1Clk(RCC_Config_t RCC_Config)
 *       - uint8_t RCC_SetMCO2Clk(RCC_Config_t RCC_Config)
+*       - const RCC_Clocks_t* RCC_GetClocks(void)
+*       - void    RCC_UpdateClocks(void)
+*       - uint8_t RCC_RegisterClockCallback(RCC_ClockCallback_t callback)
 */
 
 #ifndef RCC_DRIVER_H
@@ -157,19 +160,41 @@ typedef struct
     uint16_t plli2s_n;      /**< Multiplication factor of PLL (50 <= plli2s_n <= 432) */
 }RCC_Config_t;
 
+/** @brief Maximum number of callbacks notified when the clock tree changes */
+#define RCC_MAX_CLOCK_CALLBACKS     4
+
+/**
+ * @brief Structure with the frequencies in Hz of the clock tree.
+ */
+typedef struct
+{
+    uint32_t sysclk;        /**< System clock */
+    uint32_t hclk;          /**< AHB clock, also used by the CPU core */
+    uint32_t pclk1;         /**< APB1 peripheral clock */
+    uint32_t pclk2;         /**< APB2 peripheral clock */
+    uint32_t timclk_apb1;   /**< Clock of the timers on APB1 */
+    uint32_t timclk_apb2;   /**< Clock of the timers on APB2 */
+}RCC_Clocks_t;
+
+/**
+ * @brief Type of the functions notified when the clock tree changes.
+ * @param[in] clocks is a pointer to the new frequencies of the clock tree.
+ */
+typedef void (*RCC_ClockCallback_t)(const RCC_Clocks_t* clocks);
+
 /***********************************************************************************************************/
 /*                                       APIs Supported                                                    */
 /***********************************************************************************************************/
 
 /**
- * @brief Function to calculate the PCLK1 clock value.
+ * @brief Function to get the PCLK1 clock value.
  * @return PCLK1 clock value.
  */
 uint32_t RCC_GetPCLK1Value(void);
 
 /**
- * @brief Function to calculate the PCLK2 clock value.
- * @return PCLK1 clock value.
+ * @brief Function to get the PCLK2 clock value.
+ * @return PCLK2 clock value.
  */
 uint32_t RCC_GetPCLK2Value(void);
 
@@ -184,6 +209,9 @@ uint32_t RCC_GetPLLOutputClock(void);
  * @param[in] RCC_Config is the configuration struct.
  * @return 0 is OK.
  * @return 1 is fail.
+ * @note HSI is used as system clock while the new configuration is applied, so the function can be called
+ *       with the PLL running. The flash latency must be valid for both the old and the new frequencies. The
+ *       clock frequencies are updated and the registered callbacks are notified.
  */
 uint8_t RCC_SetSystemClock(RCC_Config_t RCC_Config);
 
@@ -203,4 +231,25 @@ uint8_t RCC_SetMCO1Clk(RCC_Config_t RCC_Config);
  */
 uint8_t RCC_SetMCO2Clk(RCC_Config_t RCC_Config);
 
+/**
+ * @brief Function to get the frequencies of the clock tree.
+ * @return pointer to the structure with the frequencies, it is updated when the clock changes.
+ */
+const RCC_Clocks_t* RCC_GetClocks(void);
+
+/**
+ * @brief Function to calculate the frequencies of the clock tree from the RCC registers.
+ * @return None.
+ * @note Only needed when the clock is changed without RCC_SetSystemClock, registered callbacks are notified.
+ */
+void RCC_UpdateClocks(void);
+
+/**
+ * @brief Function to register a callback notified every time the clock tree changes.
+ * @param[in] callback is the function to be notified.
+ * @return 0 is OK.
+ * @return 1 is fail, there is no room for more callbacks.
+ */
+uint8_t RCC_RegisterClockCallback(RCC_ClockCallback_t callback);
+
 #endif /* RCC_DRIVER_H */
@@ -13,6 +13,9 @@
 *       - void RTC_GetDate(RTC_Date_t* date)
 *       - void RTC_ClearRSF(void)
 *       - uint8_t RTC_GetRSF(void)
+*       - uint8_t RTC_WaitSync(uint32_t timeout, void (*wait_cb)(void))
+*       - void RTC_BypassShadow(uint8_t en_or_di)
+*       - uint8_t RTC_Calibrate(RTC_Calib_t* calib)
 *       - void RTC_SetAlarm(RTC_Alarm_t alarm)
 *       - void RTC_GetAlarm(RTC_Alarm_t* alarm)
 *       - uint8_t RTC_CheckAlarm(RTC_AlarmSel_t alarm)
@@ -28,9 +31,24 @@
 */
 
 #include "rtc_driver.h"
+#include "rcc_driver.h"
 #include "stm32f446xx.h"
 #include <stdint.h>
 
+/** @brief Number of LSI periods measured by each input capture (IC prescaler is 8) */
+#define RTC_CALIB_IC_DIV        8
+/** @brief Number of input captures averaged for measuring the LSI frequency */
+#define RTC_CALIB_CAPTURES      100
+/** @brief Asynchronous prescaler used when calibrating, it keeps the synchronous prescaler resolution fine */
+#define RTC_CALIB_PREDIV_A      3
+/** @brief Number of RTCCLK cycles in the smooth calibration window (32 seconds at 32768 Hz) */
+#define RTC_CALIB_WINDOW        (1UL << 20)
+/** @brief Maximum number of polls of RECALPF, a recalibration takes 3 RTCCLK periods so this is far beyond it */
+#define RTC_CALIB_RECALPF_POLLS 100000
+
+/** @brief Flag for tracking if the RTC write protection has been already disabled since last reset */
+static uint8_t rtc_wp_unlocked = 0;
+
 /***********************************************************************************************************/
 /*                                       Static Function Prototypes                                        */
 /***********************************************************************************************************/
@@ -53,6 +71,14 @@ static void RTC_EnterConfig(void);
  */
 static void RTC_ExitConfig(void);
 
+/**
+ * @brief Function for measuring the LSI frequency using the TIM5 channel 4 input capture.
+ * @param[out] ticks number of timer clock cycles elapsed during the measurement.
+ * @return 0 if the measurement was completed.
+ * @return 1 if the LSI edges were not captured on time.
+ */
+static uint8_t RTC_MeasureLSI(uint32_t* ticks);
+
 /***********************************************************************************************************/
 /*                                       Public API Definitions                                            */
 /***********************************************************************************************************/
@@ -140,13 +166,16 @@ void RTC_SetTime(RTC_Time_t time){
 
 void RTC_GetTime(RTC_Time_t* time){
 
-    time->SecondUnits = (RTC->TR >> RTC_TR_SU) & 0xF;
-    time->SecondTens = (RTC->TR >> RTC_TR_ST) & 0x7;
-    time->MinuteUnits = (RTC->TR >> RTC_TR_MNU) & 0xF;
-    time->MinuteTens = (RTC->TR >> RTC_TR_MNT) & 0x7;
-    time->HourUnits = (RTC->TR >> RTC_TR_HU) & 0xF;
-    time->HourTens = (RTC->TR >> RTC_TR_HT) & 0x3;
-    time->PM = (RTC->TR >> RTC_TR_PM) & 0x1;
+    /* Read the register only once so all the fields belong to the same second */
+    uint32_t temp = RTC->TR;
+
+    time->SecondUnits = (temp >> RTC_TR_SU) & 0xF;
+    time->SecondTens = (temp >> RTC_TR_ST) & 0x7;
+    time->MinuteUnits = (temp >> RTC_TR_MNU) & 0xF;
+    time->MinuteTens = (temp >> RTC_TR_MNT) & 0x7;
+    time->HourUnits = (temp >> RTC_TR_HU) & 0xF;
+    time->HourTens = (temp >> RTC_TR_HT) & 0x3;
+    time->PM = (temp >> RTC_TR_PM) & 0x1;
 }
 
 void RTC_SetDate(RTC_Date_t date){
@@ -173,13 +202,16 @@ void RTC_SetDate(RTC_Date_t date){
 
 void RTC_GetDate(RTC_Date_t* date){
 
-    date->DateUnits = (RTC->DR >> RTC_DR_DU) & 0xF;
-    date->DateTens = (RTC->DR >> RTC_DR_DT) & 0x3;
-    date->WeekDayUnits = (RTC->DR >> RTC_DR_WDU) & 0x7;
-    date->MonthUnits = (RTC->DR >> RTC_DR_MU) & 0xF;
-    date->MonthTens = (RTC->DR >> RTC_DR_MT) & 0x1;
-    date->YearUnits = (RTC->DR >> RTC_DR_YU) & 0xF;
-    date->YearTens = (RTC->DR >> RTC_DR_YT) & 0xF;
+    /* Read the register only once, this also unlocks the shadow registers after reading RTC_TR */
+    uint32_t temp = RTC->DR;
+
+    date->DateUnits = (temp >> RTC_DR_DU) & 0xF;
+    date->DateTens = (temp >> RTC_DR_DT) & 0x3;
+    date->WeekDayUnits = (temp >> RTC_DR_WDU) & 0x7;
+    date->MonthUnits = (temp >> RTC_DR_MU) & 0xF;
+    date->MonthTens = (temp >> RTC_DR_MT) & 0x1;
+    date->YearUnits = (temp >> RTC_DR_YU) & 0xF;
+    date->YearTens = (temp >> RTC_DR_YT) & 0xF;
 }
 
 void RTC_ClearRSF(void){
@@ -199,6 +231,102 @@ uint8_t RTC_GetRSF(void){
     return ret;
 }
 
+uint8_t RTC_WaitSync(uint32_t timeout, void (*wait_cb)(void)){
+
+    uint8_t ret = 0;
+
+    /* Calendar registers are read directly from the counters, no synchronization is needed */
+    if(RTC->CR & (1 << RTC_CR_BYPSHAD)){
+        return ret;
+    }
+
+    RTC_ClearRSF();
+
+    /* RSF is set by hardware each time the shadow registers are copied, every two RTCCLK periods */
+    while(!(RTC->ISR & (1 << RTC_ISR_RSF))){
+        if(timeout == 0){
+            ret = 1;
+            break;
+        }
+        timeout--;
+        if(wait_cb){
+            wait_cb();
+        }
+    }
+
+    return ret;
+}
+
+void RTC_BypassShadow(uint8_t en_or_di){
+
+    RTC_Unlock();
+
+    if(en_or_di == ENABLE){
+        RTC->CR |= (1 << RTC_CR_BYPSHAD);
+    }
+    else{
+        RTC->CR &= ~(1 << RTC_CR_BYPSHAD);
+    }
+}
+
+uint8_t RTC_Calibrate(RTC_Calib_t* calib){
+
+    uint32_t ticks = 0;
+    uint32_t lsi_hz = 0;
+    uint32_t prediv_s = 0;
+    uint64_t lsi_mhz = 0;
+    uint64_t calm = 0;
+    uint32_t polls = RTC_CALIB_RECALPF_POLLS;
+
+    if(RTC_MeasureLSI(&ticks)){
+        return 1;
+    }
+
+    /* f_LSI = f_TIM * (LSI periods measured) / (timer ticks elapsed), in mHz for keeping the precision */
+    lsi_mhz = ((uint64_t)RCC_GetClocks()->timclk_apb1 * RTC_CALIB_IC_DIV * RTC_CALIB_CAPTURES * 1000) / ticks;
+    lsi_hz = (uint32_t)(lsi_mhz / 1000);
+
+    /* (PREDIV_A + 1) * (PREDIV_S + 1) rounded down to the LSI frequency, so only pulses must be masked */
+    prediv_s = (lsi_hz / (RTC_CALIB_PREDIV_A + 1)) - 1;
+    if((prediv_s == 0) || (prediv_s > 0x7FFF)){
+        return 1;
+    }
+
+    /* Pulses to be masked in the calibration window for compensating the prescaler rounding */
+    calm = lsi_mhz - ((uint64_t)(prediv_s + 1) * (RTC_CALIB_PREDIV_A + 1) * 1000);
+    calm = ((calm * RTC_CALIB_WINDOW) + (lsi_mhz / 2)) / lsi_mhz;
+    if(calm > 0x1FF){
+        calm = 0x1FF;
+    }
+
+    /* A previous recalibration must finish before CALR is written, checked first so nothing changes on timeout */
+    while(RTC->ISR & (1 << RTC_ISR_RECALPF)){
+        if(polls == 0){
+            return 1;
+        }
+        polls--;
+    }
+
+    RTC_Unlock();
+
+    /* Prescaler can only be written in initialization mode, using two separate write accesses */
+    RTC_EnterConfig();
+    RTC->PRER = (prediv_s << RTC_PRER_PREDIV_S);
+    RTC->PRER |= (RTC_CALIB_PREDIV_A << RTC_PRER_PREDIV_A);
+    RTC_ExitConfig();
+
+    RTC->CALR = ((uint32_t)calm << RTC_CALR_CALM);
+
+    if(calib){
+        calib->LSIFreq = (uint32_t)lsi_mhz;
+        calib->AsynchPrediv = RTC_CALIB_PREDIV_A;
+        calib->SynchPrediv = (uint16_t)prediv_s;
+        calib->CalMinus = (uint16_t)calm;
+    }
+
+    return 0;
+}
+
 void RTC_SetAlarm(RTC_Alarm_t alarm){
 
     uint32_t temp = 0;
@@ -433,8 +561,14 @@ __attribute__((weak)) void RTC_AlarmEventCallback(RTC_AlarmSel_t alarm){
 
 static void RTC_Unlock(void){
 
+    /* The write protection is only enabled again by a reset, so the key sequence is written once */
+    if(rtc_wp_unlocked){
+        return;
+    }
+
     RTC->WPR |= 0xCA;
     RTC->WPR |= 0x53;
+    rtc_wp_unlocked = 1;
 }
 
 static void RTC_EnterConfig(void){
@@ -450,3 +584,65 @@ static void RTC_ExitConfig(void){
     /* Exit the initialization mode by clearing the INIT bit */
     RTC->ISR &= ~(1 << RTC_ISR_INIT);
 }
+
+static uint8_t RTC_MeasureLSI(uint32_t* ticks){
+
+    uint8_t ret = 0;
+    uint32_t first = 0;
+    uint32_t start = 0;
+    uint32_t timeout = RCC_GetClocks()->timclk_apb1 / 100;
+
+    TIM5_PCLK_EN();
+    TIM5->CR1 &= ~(1 << TIM_CR1_CEN);
+
+    /* Free running 32 bits counter at the timer clock frequency */
+    TIM5->PSC = 0;
+    TIM5->ARR = 0xFFFFFFFF;
+    TIM5->EGR |= (1 << TIM_EGR_UG);
+
+    /* Connect the LSI to the TIM5 channel 4 input */
+    TIM5->OR &= ~(0x3 << TIM_OR_TI4_RMP);
+    TIM5->OR |= (0x1 << TIM_OR_TI4_RMP);
+
+    /* IC4 mapped on TI4, capture every 8 rising edges, no filter */
+    TIM5->CCER &= ~((1 << TIM_CCER_CC4E) | (0x5 << TIM_CCER_CC4P));
+    TIM5->CCMR2 &= ~((0x3 << TIM_CCMR2_CC4S) | (0x3 << TIM_CCMR2_IC4PSC) | (0xF << TIM_CCMR2_IC4F));
+    TIM5->CCMR2 |= ((0x1 << TIM_CCMR2_CC4S) | (0x3 << TIM_CCMR2_IC4PSC));
+    TIM5->CCER |= (1 << TIM_CCER_CC4E);
+
+    TIM5->SR &= ~(1 << TIM_SR_CC4IF);
+    TIM5->CR1 |= (1 << TIM_CR1_CEN);
+
+    /* The first capture is the reference, the rest are accumulated from it */
+    for(uint32_t i = 0; i <= RTC_CALIB_CAPTURES; i++){
+        start = TIM5->CNT;
+        while(!(TIM5->SR & (1 << TIM_SR_CC4IF))){
+            /* Each capture takes 8 LSI periods, so 10 ms is far beyond the expected time */
+            if((TIM5->CNT - start) > timeout){
+                ret = 1;
+                break;
+            }
+        }
+        if(ret){
+            break;
+        }
+        /* Reading CCR4 clears the CC4IF flag */
+        if(i == 0){
+            first = TIM5->CCR4;
+        }
+        else{
+            *ticks = TIM5->CCR4 - first;
+        }
+    }
+
+    TIM5->CR1 &= ~(1 << TIM_CR1_CEN);
+    TIM5->CCER &= ~(1 << TIM_CCER_CC4E);
+    TIM5->OR &= ~(0x3 << TIM_OR_TI4_RMP);
+    TIM5_PCLK_DI();
+
+    if(*ticks == 0){
+        ret = 1;
+    }
+
+    return ret;
+}
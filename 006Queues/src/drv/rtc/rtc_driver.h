@@ -13,6 +13,9 @@
 *       - void RTC_GetDate(RTC_Date_t* date)
 *       - void RTC_ClearRSF(void)
 *       - uint8_t RTC_GetRSF(void)
+*       - uint8_t RTC_WaitSync(uint32_t timeout, void (*wait_cb)(void))
+*       - void RTC_BypassShadow(uint8_t en_or_di)
+*       - uint8_t RTC_Calibrate(RTC_Calib_t* calib)
 *       - void RTC_SetAlarm(RTC_Alarm_t alarm)
 *       - void RTC_GetAlarm(RTC_Alarm_t* alarm)
 *       - uint8_t RTC_CheckAlarm(RTC_AlarmSel_t alarm)
@@ -125,6 +128,17 @@ typedef struct
     RTC_Date_t RTC_Date;            /**< Struct with date configuration */
 }RTC_Config_t;
 
+/**
+ * @brief Structure with the result of the LSI calibration of the RTC peripheral.
+ */
+typedef struct
+{
+    uint32_t LSIFreq;               /**< Measured LSI frequency in mHz */
+    uint8_t AsynchPrediv;           /**< Asynchronous prescaler factor applied */
+    uint16_t SynchPrediv;           /**< Synchronous prescaler factor applied */
+    uint16_t CalMinus;              /**< Pulses masked every 2^20 RTCCLK cycles (CALM field) */
+}RTC_Calib_t;
+
 /**
  * @brief Configuration structure regarding the alarm for RTC peripheral.
  */
@@ -213,6 +227,36 @@ void RTC_ClearRSF(void);
  */
 uint8_t RTC_GetRSF(void);
 
+/**
+ * @brief Function to wait until the calendar shadow registers of the RTC peripheral are synchronized.
+ * @param[in] timeout maximum number of times wait_cb is called before giving up.
+ * @param[in] wait_cb function called between polls of the RSF bit (e.g. a task delay), it can be NULL.
+ * @return 0 if the shadow registers are synchronized or the shadow registers are bypassed.
+ * @return 1 if timeout expired.
+ * @note The RSF bit is cleared before waiting, so a new copy of the calendar registers is guaranteed.
+ */
+uint8_t RTC_WaitSync(uint32_t timeout, void (*wait_cb)(void));
+
+/**
+ * @brief Function to bypass the shadow registers of the RTC peripheral.
+ * @param[in] en_or_di ENABLE to read calendar values directly from the counters, DISABLE to use shadows.
+ * @return void
+ * @note When enabled the values must be read twice and compared, as the counters can change while reading.
+ */
+void RTC_BypassShadow(uint8_t en_or_di);
+
+/**
+ * @brief Function to calibrate the RTC peripheral when it is clocked by the LSI.
+ * @param[out] calib structure where the measured frequency and the applied values are stored.
+ * @return 0 if the calibration was applied.
+ * @return 1 if the LSI could not be measured, the frequency is out of range or a previous recalibration
+ *         did not finish on time.
+ * @note The LSI is measured using TIM5 channel 4 input capture against the APB1 timer clock, so the
+ *       accuracy is the one of the HSE. The prescalers are set for a 1 Hz calendar clock and the remaining
+ *       error is corrected with the smooth calibration. TIM5 is left disabled when the function returns.
+ */
+uint8_t RTC_Calibrate(RTC_Calib_t* calib);
+
 /**
  * @brief Function to set alarm in the RTC peripheral.
  * @param[in] structure with the alarm configuration
@@ -20,9 +20,38 @@
 */
 
 #include <stdint.h>
+#include <stddef.h>
 #include "timer_driver.h"
+#include "rcc_driver.h"
 #include "stm32f446xx.h"
 
+/** @brief Number of timer peripherals */
+#define TIMER_NUM_INSTANCES     (TIMER14 + 1)
+
+/** @brief Handles of the initialized timers, re-timed when the clock changes */
+static Timer_Handle_t* Timer_Handles[TIMER_NUM_INSTANCES] = {NULL};
+/** @brief Clock of each timer when its prescaler and period were calculated */
+static uint32_t Timer_Clk[TIMER_NUM_INSTANCES] = {0};
+
+/***********************************************************************************************************/
+/*                                       Static Function Prototypes                                        */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for getting the input clock of a timer.
+ * @param[in] timer_num is the timer peripheral.
+ * @return clock frequency in Hz.
+ */
+static uint32_t Timer_GetClock(Timer_Num_t timer_num);
+
+/**
+ * @brief Function for keeping the update period of the initialized timers when the clock changes.
+ * @param[in] clocks is a pointer to the new frequencies of the clock tree.
+ * @return void.
+ * @note The prescaler and period of the timer handles are updated with the new values.
+ */
+static void Timer_ClockChangeCallback(const RCC_Clocks_t* clocks);
+
 /***********************************************************************************************************/
 /*                                       Public API Definitions                                            */
 /***********************************************************************************************************/
@@ -47,6 +76,11 @@ void Timer_Init(Timer_Handle_t* Timer_Handle){
     }
     /* Enable interrupt */
     Timer_Handle->pTimer->DIER |= (1 << TIM_DIER_UIE);
+
+    /* Keep the handle, so the timer is re-timed when the clock changes */
+    Timer_Handles[Timer_Handle->tim_num] = Timer_Handle;
+    Timer_Clk[Timer_Handle->tim_num] = Timer_GetClock(Timer_Handle->tim_num);
+    (void)RCC_RegisterClockCallback(Timer_ClockChangeCallback);
 }
 
 void Timer_Start(Timer_Handle_t* Timer_Handle){
@@ -467,3 +501,59 @@ __attribute__((weak)) void Timer_ApplicationEventCallback(Timer_Num_t tim_num, T
 
     /* This is a weak implementation. The application may override this function */
 }
+
+/***********************************************************************************************************/
+/*                                       Static Function Definitions                                       */
+/***********************************************************************************************************/
+
+static uint32_t Timer_GetClock(Timer_Num_t timer_num){
+
+    /* TIM1, TIM8, TIM9, TIM10 and TIM11 are hanging on APB2 bus */
+    if((timer_num == TIMER1) || (timer_num == TIMER8) || (timer_num == TIMER9) ||
+       (timer_num == TIMER10) || (timer_num == TIMER11)){
+        return RCC_GetClocks()->timclk_apb2;
+    }
+
+    return RCC_GetClocks()->timclk_apb1;
+}
+
+static void Timer_ClockChangeCallback(const RCC_Clocks_t* clocks){
+
+    Timer_Handle_t* handle;
+    uint32_t clk;
+    uint64_t ticks;
+    uint32_t max_period;
+    uint32_t prescaler;
+
+    for(uint8_t i = 0; i < TIMER_NUM_INSTANCES; i++){
+        handle = Timer_Handles[i];
+        clk = Timer_GetClock((Timer_Num_t)i);
+        if((handle == NULL) || (Timer_Clk[i] == clk) || (Timer_Clk[i] == 0)){
+            continue;
+        }
+
+        /* Timer clock cycles of an update period with the new clock */
+        ticks = ((uint64_t)(handle->prescaler + 1) * ((uint64_t)handle->period + 1) * clk) / Timer_Clk[i];
+        if(ticks == 0){
+            ticks = 1;
+        }
+
+        /* Smallest prescaler that fits the period in the counter, so the resolution is kept */
+        max_period = ((i == TIMER2) || (i == TIMER5)) ? 0xFFFFFFFF : 0xFFFF;
+        prescaler = (uint32_t)((ticks + max_period) / ((uint64_t)max_period + 1));
+        if(prescaler == 0){
+            prescaler = 1;
+        }
+        if(prescaler > 0x10000){
+            prescaler = 0x10000;
+        }
+
+        handle->prescaler = (uint16_t)(prescaler - 1);
+        handle->period = (uint32_t)(ticks / prescaler) - 1;
+        Timer_Clk[i] = clk;
+
+        /* The prescaler is loaded at the next update event, the period is not preloaded */
+        handle->pTimer->PSC = handle->prescaler;
+        handle->pTimer->ARR = handle->period;
+    }
+}
@@ -158,6 +158,8 @@ typedef struct
  * @brief Function to initialize the timer peripheral.
  * @param[in] Timer_Handle handle structure for managing the timer peripheral.
  * @return void
+ * @note The handle must stay valid, when the clock changes the prescaler and period are recalculated to keep
+ *       the update period.
  */
 void Timer_Init(Timer_Handle_t* Timer_Handle);
 
@@ -29,6 +29,32 @@
 #include "usart_driver.h"
 #include "rcc_driver.h"
 
+/** @brief Number of USART peripherals */
+#define USART_NUM_INSTANCES     6
+
+/** @brief USART peripherals, in the same order as USART_Baud */
+static USART_RegDef_t* const USART_Instances[USART_NUM_INSTANCES] = {USART1, USART2, USART3, UART4, UART5, USART6};
+/** @brief Baud rate configured for each USART, 0 if not configured */
+static uint32_t USART_Baud[USART_NUM_INSTANCES] = {0};
+
+/***********************************************************************************************************/
+/*                                       Static Function Prototypes                                        */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for getting the index of a USART peripheral in USART_Instances.
+ * @param[in] pUSARTx the base address of the USARTx peripheral.
+ * @return index of the peripheral, USART_NUM_INSTANCES if it is not valid.
+ */
+static uint8_t USART_GetIndex(USART_RegDef_t* pUSARTx);
+
+/**
+ * @brief Function for setting again the baud rate of the configured USARTs when the clock changes.
+ * @param[in] clocks is a pointer to the new frequencies of the clock tree.
+ * @return void.
+ */
+static void USART_ClockChangeCallback(const RCC_Clocks_t* clocks);
+
 /***********************************************************************************************************/
 /*                                       Public API Definitions                                            */
 /***********************************************************************************************************/
@@ -138,6 +164,10 @@ void USART_DeInit(USART_RegDef_t* pUSARTx){
     else{
         /* do nothing */
     }
+
+    if(USART_GetIndex(pUSARTx) < USART_NUM_INSTANCES){
+        USART_Baud[USART_GetIndex(pUSARTx)] = 0;
+    }
 }
 
 void USART_PerClkCtrl(USART_RegDef_t* pUSARTx, uint8_t en_or_di){
@@ -313,6 +343,13 @@ void USART_SetBaudRate(USART_RegDef_t* pUSARTx, uint32_t baudrate){
     uint32_t usartdiv;
     uint32_t mantissa, fraction;
     uint32_t temp = 0;
+    uint8_t index = USART_GetIndex(pUSARTx);
+
+    /* Keep the baud rate, so it is set again when the clock changes */
+    if(index < USART_NUM_INSTANCES){
+        USART_Baud[index] = baudrate;
+        (void)RCC_RegisterClockCallback(USART_ClockChangeCallback);
+    }
 
     /* Get the value of APB bus clock into the variable PCLKx */
     if(pUSARTx == USART1 || pUSARTx == USART6){
@@ -402,7 +439,7 @@ void USART_IRQPriorityConfig(uint8_t IRQNumber, uint32_t IRQPriority){
     *(NVIC_PR_BASEADDR + iprx) |= (IRQPriority << shift);
 }
 
-void USART_IRQHandling(USART_Handle_t* pUSART_Handle){
+RAMFUNC void USART_IRQHandling(USART_Handle_t* pUSART_Handle){
 
     uint32_t temp1, temp2, temp3;
     uint32_t dummy_read;
@@ -643,3 +680,29 @@ __attribute__((weak)) void USART_ApplicationEventCallback(USART_Handle_t* pUSART
 
     /* This is a weak implementation. The application may override this function */
 }
+
+/***********************************************************************************************************/
+/*                                       Static Function Definitions                                       */
+/***********************************************************************************************************/
+
+static uint8_t USART_GetIndex(USART_RegDef_t* pUSARTx){
+
+    uint8_t i;
+
+    for(i = 0; i < USART_NUM_INSTANCES; i++){
+        if(USART_Instances[i] == pUSARTx){
+            break;
+        }
+    }
+
+    return i;
+}
+
+static void USART_ClockChangeCallback(const RCC_Clocks_t* clocks){
+
+    for(uint8_t i = 0; i < USART_NUM_INSTANCES; i++){
+        if(USART_Baud[i] != 0){
+            USART_SetBaudRate(USART_Instances[i], USART_Baud[i]);
+        }
+    }
+}
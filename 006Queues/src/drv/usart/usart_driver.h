@@ -245,7 +245,7 @@ void USART_IRQPriorityConfig(uint8_t IRQNumber, uint32_t IRQPriority);
  * @param[in] pUSART_Handle handle structure to USART peripheral.
  * @return void.
  */
-void USART_IRQHandling(USART_Handle_t* pUSART_Handle);
+RAMFUNC void USART_IRQHandling(USART_Handle_t* pUSART_Handle);
 
 /**
  * @brief Function enable the USART peripheral.
@@ -8,23 +8,72 @@
 #include "task.h"
 #include "queue.h"
 #include "timers.h"
+#include "semphr.h"
 #include "rcc_driver.h"
 #include "flash_driver.h"
-#include "pwr_driver.h"
 #include "gpio_driver.h"
 #include "usart_driver.h"
 #include "timer_driver.h"
 #include "rtc_driver.h"
+#include "crc_driver.h"
+#include "dma_driver.h"
 #include "menu_cmd_task.h"
+#include "cmd_line.h"
+#include "cmd_proto.h"
 #include "LEDs_task.h"
 #include "RTC_task.h"
+#ifdef BENCH_ENABLE
+#include "bench_task.h"
+#endif
+#include "app_state.h"
+#include "flash_async.h"
+#include "clk_scaling.h"
+#include "clk_config.h"
+#include "rt_stats.h"
+#include "stack_mon_task.h"
 #include <stdio.h>
 #include <string.h>
 
-#define DWT_CTRL  (*(volatile uint32_t*)0xE0001000)
+#ifdef BENCH_ENABLE
+/** @brief DWT cycle counter, read for printing the boot time */
+#define DWT_CYCCNT  (*(volatile uint32_t*)0xE0001004)
+#endif
+
+/** @brief Counter frequency of TIM6 */
+#define TIM6_CNT_HZ         10000000U
+/** @brief Update frequency of TIM6, used as 1 ms tick */
+#define TIM6_TICK_HZ        1000U
+/** @brief Maximum baud rate error of USART3, in tenths of percent */
+#define USART3_MAX_ERR      20U
+/** @brief Stack depth in words of the application tasks */
+#define TASK_STACK_DEPTH    250U
+/** @brief Number of elements of the print queue */
+#define Q_PRINT_LENGTH      10U
+/** @brief Number of LED effect timers */
+#define LED_TIMER_NUM       4U
+
+/** @brief Defines the interrupt handler of a DMA stream, the DMA driver finds the handle owning the stream */
+#define DMA_STREAM_HANDLER(ctrl, str)                   \
+    void DMA##ctrl##_Stream##str##_Handler(void){       \
+        traceISR_ENTER();                               \
+        DMA_IRQHandling(ctrl, str);                     \
+        traceISR_EXIT();                                \
+    }
+
+/* TIM6 is configured once at 180 MHz, then the timer driver keeps its update period */
+_Static_assert((CLK_TIMCLK_APB1(CLK_OPP180) % TIM6_CNT_HZ) == 0, "TIM6 counter frequency not reachable");
+/* USART3 must keep working at every operating point */
+_Static_assert(CLK_USART_ERR(CLK_PCLK1(CLK_OPP180), USART_STD_BAUD_115200) <= USART3_MAX_ERR,
+               "USART3 baud rate error too high at 180 MHz");
+_Static_assert(CLK_USART_ERR(CLK_PCLK1(CLK_OPP84), USART_STD_BAUD_115200) <= USART3_MAX_ERR,
+               "USART3 baud rate error too high at 84 MHz");
+_Static_assert(CLK_USART_ERR(CLK_PCLK1(CLK_OPP16), USART_STD_BAUD_115200) <= USART3_MAX_ERR,
+               "USART3 baud rate error too high at 16 MHz");
 
 /** @brief Variable for storing the current system core clock */
 uint32_t SystemCoreClock = 8000000;
+/** @brief FreeRTOS heap, heap_4 builds its free list on it so it is not zeroed at boot */
+uint8_t ucHeap[configTOTAL_HEAP_SIZE] __attribute__((section(".noinit"), aligned(8)));
 /** @brief Handler structure for Timer peripheral */
 static Timer_Handle_t Timer = {0};
 /** @brief Variable for storing the current tick */
@@ -48,18 +97,58 @@ static TaskHandle_t print_task_handle;
 TaskHandle_t rtc_task_handle;
 /** @brief Variable for handling the LED_task_handler task */
 TaskHandle_t LED_task_handle;
+/** @brief Stack of the menu_task_handler task */
+static StackType_t menu_task_stack[TASK_STACK_DEPTH] SRAM2_DATA;
+/** @brief Stack of the print_task_handler task */
+static StackType_t print_task_stack[TASK_STACK_DEPTH] SRAM2_DATA;
+/** @brief Stack of the cmd_task_handler task */
+static StackType_t cmd_task_stack[TASK_STACK_DEPTH] SRAM2_DATA;
+/** @brief Stack of the LED_task_handler task */
+static StackType_t LED_task_stack[TASK_STACK_DEPTH] SRAM2_DATA;
+/** @brief Stack of the rtc_task_handler task */
+static StackType_t rtc_task_stack[TASK_STACK_DEPTH] SRAM2_DATA;
+/** @brief Stack of the stack_mon_task_handler task */
+static StackType_t stack_mon_task_stack[TASK_STACK_DEPTH] SRAM2_DATA;
+/** @brief Stack of the idle task */
+static StackType_t idle_task_stack[configMINIMAL_STACK_SIZE] SRAM2_DATA;
+/** @brief Stack of the timer service task */
+static StackType_t timer_task_stack[configTIMER_TASK_STACK_DEPTH] SRAM2_DATA;
+/** @brief Control blocks of the statically allocated tasks, kept in SRAM1 with the kernel data */
+static StaticTask_t menu_task_tcb, print_task_tcb, cmd_task_tcb, LED_task_tcb, rtc_task_tcb;
+#ifdef BENCH_ENABLE
+/** @brief Stack of the bench_task_handler task */
+static StackType_t bench_task_stack[TASK_STACK_DEPTH] SRAM2_DATA;
+/** @brief Control block of the bench_task_handler task */
+static StaticTask_t bench_task_tcb;
+#endif
+/** @brief Control block of the stack_mon_task_handler task */
+static StaticTask_t stack_mon_task_tcb;
+/** @brief Control block of the idle task */
+static StaticTask_t idle_task_tcb;
+/** @brief Control block of the timer service task */
+static StaticTask_t timer_task_tcb;
 /** @brief Variable for handling the queue used for printing */
 QueueHandle_t q_print;
-/** @brief Variable for handling the queue used for managing the information received by UART */
-QueueHandle_t q_data;
 /** @brief Variable for storing the character received by UART */
 static volatile uint8_t user_data;
 /** @brief Variable for storing the invalid option message */
 const char* msg_invalid = "////Invalid option////\n";
 /** @brief Array for handling the LED timers */
-TimerHandle_t led_timer_handle[4];
+TimerHandle_t led_timer_handle[LED_TIMER_NUM];
 /** @brief handler for managing the RTC timer */
 TimerHandle_t rtc_timer;
+/** @brief Storage of the print queue, it holds pointers to the messages */
+static uint8_t q_print_storage[Q_PRINT_LENGTH * sizeof(size_t)];
+/** @brief Control block of the print queue */
+static StaticQueue_t q_print_buffer;
+/** @brief Mutex for sharing the USART between the print task and the binary protocol responses */
+static SemaphoreHandle_t usart_tx_mutex;
+/** @brief Control block of the USART mutex */
+static StaticSemaphore_t usart_tx_mutex_buffer;
+/** @brief Control blocks of the LED timers */
+static StaticTimer_t led_timer_buffer[LED_TIMER_NUM];
+/** @brief Control block of the RTC timer */
+static StaticTimer_t rtc_timer_buffer;
 
 /***********************************************************************************************************/
 /*                                       Static Function Prototypes                                        */
@@ -150,14 +239,15 @@ static void print_task_handler(void* parameters);
 
 int main(void)
 {
-    BaseType_t status;
+#ifdef BENCH_ENABLE
+    TaskHandle_t bench_task_handle;
+#endif
+    TaskHandle_t stack_mon_task_handle;
+    uint8_t stack_mon_status = 0;
+    char ovf_task[configMAX_TASK_NAME_LEN];
 
     /* Configure the system clock */
     RCC_Config();
-    SystemCoreClock = RCC_GetPLLOutputClock();
-
-    /* Enable the CYCNT counter */
-    DWT_CTRL |= (1 << 0);
 
     /* Init timer 6 */
     Timer6_Config();
@@ -171,6 +261,14 @@ int main(void)
     USART_Enable(USART3, ENABLE);
     /* Init LED pins */
     LEDS_GPIOInit();
+    /* Enable flash operations by interrupt */
+    flash_async_init();
+    /* Enable the CRC peripheral, used by the backup record, the flash store and the binary protocol */
+    CRC_Init();
+    CRC_IRQPriorityConfig(6);
+    CRC_IRQConfig(ENABLE);
+    /* Restore the application state kept in the backup domain */
+    (void)app_state_init();
     /* Init RTC */
     RTC_Config();
 
@@ -178,35 +276,74 @@ int main(void)
     SEGGER_SYSVIEW_Conf();
     //SEGGER_SYSVIEW_Start();
 
-    /* Create tasks */
-    status = xTaskCreate(menu_task_handler, "Menu-Task", 250, NULL, 2, &menu_task_handle);
-    configASSERT(status == pdPASS);
-    status = xTaskCreate(print_task_handler, "Print-Task", 250, NULL, 2, &print_task_handle);
-    configASSERT(status == pdPASS);
-    status = xTaskCreate(cmd_task_handler, "Cmd-Task", 250, NULL, 2, &cmd_task_handle);
-    configASSERT(status == pdPASS);
-    status = xTaskCreate(LED_task_handler, "LED-Task", 250, NULL, 2, &LED_task_handle);
-    configASSERT(status == pdPASS);
-    status = xTaskCreate(rtc_task_handler, "Rtc-Task", 250, NULL, 2, &rtc_task_handle);
-    configASSERT(status == pdPASS);
+    /* Create tasks, stacks are in SRAM2 so CPU stack traffic does not compete with DMA in SRAM1 */
+    menu_task_handle = xTaskCreateStatic(menu_task_handler, "Menu-Task", TASK_STACK_DEPTH, NULL, 2,
+                                         menu_task_stack, &menu_task_tcb);
+    configASSERT(menu_task_handle != NULL);
+    print_task_handle = xTaskCreateStatic(print_task_handler, "Print-Task", TASK_STACK_DEPTH, NULL, 2,
+                                          print_task_stack, &print_task_tcb);
+    configASSERT(print_task_handle != NULL);
+    cmd_task_handle = xTaskCreateStatic(cmd_task_handler, "Cmd-Task", TASK_STACK_DEPTH, NULL, 2,
+                                        cmd_task_stack, &cmd_task_tcb);
+    configASSERT(cmd_task_handle != NULL);
+    LED_task_handle = xTaskCreateStatic(LED_task_handler, "LED-Task", TASK_STACK_DEPTH, NULL, 2,
+                                        LED_task_stack, &LED_task_tcb);
+    configASSERT(LED_task_handle != NULL);
+    rtc_task_handle = xTaskCreateStatic(rtc_task_handler, "Rtc-Task", TASK_STACK_DEPTH, NULL, 2,
+                                        rtc_task_stack, &rtc_task_tcb);
+    configASSERT(rtc_task_handle != NULL);
+#ifdef BENCH_ENABLE
+    bench_task_handle = xTaskCreateStatic(bench_task_handler, "Bench-Task", TASK_STACK_DEPTH, NULL, 1,
+                                          bench_task_stack, &bench_task_tcb);
+    configASSERT(bench_task_handle != NULL);
+#endif
+    stack_mon_task_handle = xTaskCreateStatic(stack_mon_task_handler, "Stack-Mon", TASK_STACK_DEPTH, NULL, 1,
+                                              stack_mon_task_stack, &stack_mon_task_tcb);
+    configASSERT(stack_mon_task_handle != NULL);
+    /* Watch the stack usage of every task, the monitor adds the idle and timer tasks itself */
+    stack_mon_status |= stack_mon_register(menu_task_handle, TASK_STACK_DEPTH);
+    stack_mon_status |= stack_mon_register(print_task_handle, TASK_STACK_DEPTH);
+    stack_mon_status |= stack_mon_register(cmd_task_handle, TASK_STACK_DEPTH);
+    stack_mon_status |= stack_mon_register(LED_task_handle, TASK_STACK_DEPTH);
+    stack_mon_status |= stack_mon_register(rtc_task_handle, TASK_STACK_DEPTH);
+#ifdef BENCH_ENABLE
+    stack_mon_status |= stack_mon_register(bench_task_handle, TASK_STACK_DEPTH);
+#endif
+    stack_mon_status |= stack_mon_register(stack_mon_task_handle, TASK_STACK_DEPTH);
+    /* The calls stay out of configASSERT, which a build may define to nothing */
+    configASSERT(!stack_mon_status);
     /* Create queues */
-    q_print = xQueueCreate(10, sizeof(size_t));
+    q_print = xQueueCreateStatic(Q_PRINT_LENGTH, sizeof(size_t), q_print_storage, &q_print_buffer);
     configASSERT(q_print != NULL);
-    q_data = xQueueCreate(10, sizeof(char));
-    configASSERT(q_data != NULL);
+    /* Queues in the registry are watched by queue_stats */
+    vQueueAddToRegistry(q_print, "q_print");
+    usart_tx_mutex = xSemaphoreCreateMutexStatic(&usart_tx_mutex_buffer);
+    configASSERT(usart_tx_mutex != NULL);
     /* Create software timers for LEDs effect, the id for the timers is a number between 1 and 4 */
-    for(uint8_t i = 0; i < 4; i++){
-        led_timer_handle[i] = xTimerCreate("LED_timer",
-                                           pdMS_TO_TICKS(500),
-                                           pdTRUE,
-                                           (void*)(i+1),
-                                           led_effect_callback);
+    for(uint8_t i = 0; i < LED_TIMER_NUM; i++){
+        led_timer_handle[i] = xTimerCreateStatic("LED_timer",
+                                                 pdMS_TO_TICKS(500),
+                                                 pdTRUE,
+                                                 (void*)(i+1),
+                                                 led_effect_callback,
+                                                 &led_timer_buffer[i]);
+        configASSERT(led_timer_handle[i] != NULL);
     }
     /* Create software timer for RTC */
-    rtc_timer = xTimerCreate ("rtc_report_timer", pdMS_TO_TICKS(1000), pdTRUE,NULL, rtc_report_callback);
+    rtc_timer = xTimerCreateStatic("rtc_report_timer", pdMS_TO_TICKS(1000), pdTRUE, NULL, rtc_report_callback,
+                                   &rtc_timer_buffer);
+    configASSERT(rtc_timer != NULL);
 
     (void)USART_ReceiveDataIT(&USART3Handle, (uint8_t*)&user_data, 1);
 
+#ifdef BENCH_ENABLE
+    /* CYCCNT is started in Reset_Handler, HSI cycles before RCC_Config are counted as CPU cycles too */
+    printf("Boot time: %lu cycles\n", (unsigned long)DWT_CYCCNT);
+#endif
+    if(stack_mon_last_overflow(ovf_task)){
+        printf("Reset by a stack overflow in %s\n", ovf_task);
+    }
+
     /* Start the freeRTOS scheduler */
     vTaskStartScheduler();
 
@@ -222,26 +359,14 @@ int main(void)
 
 static void RCC_Config(void)
 {
-    RCC_Config_t RCC_Cfg = {0};
-
-    /* Set FLASH latency according to clock frequency (see reference manual) */
-    Flash_SetLatency(5);
-
-    /* Set the over drive mode */
-    PWR_PCLK_EN();
-    PWR_SetOverDrive();
-
-    /* Set configuration */
-    RCC_Cfg.clk_source = RCC_CLK_SOURCE_PLL_P;
-    RCC_Cfg.pll_source = PLL_SOURCE_HSE;
-    RCC_Cfg.ahb_presc = AHB_NO_PRESC;
-    RCC_Cfg.apb1_presc = APB1_PRESC_4;
-    RCC_Cfg.apb2_presc = APB2_PRESC_2;
-    RCC_Cfg.pll_n = 180;
-    RCC_Cfg.pll_m = 4;
-    RCC_Cfg.pll_p = PLL_P_2;
-    /* Set clock */
-    RCC_SetSystemClock(RCC_Cfg);
+    uint8_t ret;
+
+    /* Start at full speed: PLL from HSE at 180 MHz with over-drive and 5 wait states */
+    ret = clk_scaling_set(CLK_OPP_180MHZ);
+    configASSERT(ret == 0);
+
+    /* Enable caches and prefetch, so code running at 5 wait states gets close to zero wait state */
+    Flash_ConfigAccelerator(ENABLE, ENABLE, ENABLE);
 }
 
 static void USART2_GPIOInit(void){
@@ -344,10 +469,17 @@ static void RTC_Time_Init(void){
 
 static void RTC_Config(void){
 
+    RTC_Calib_t calib;
+
     /* Turn on required input clock */
     RCC->CSR |= (1 << 0);
     while(!(RCC->CSR & (1 << 1)));
 
+    /* After a warm reset calendar, prescalers and calibration are still running in the backup domain */
+    if(app_state_rtc_configured()){
+        return;
+    }
+
     /* Select clock source */
     RTC_ClkSource(RCC_LSI_SOURCE);
 
@@ -356,14 +488,25 @@ static void RTC_Config(void){
     RTC_Time_Init();
 
     RTC_Init(RTC_Cfg);
+
+    /* Compensate the LSI deviation measuring it against the HSE based clock */
+    if(RTC_Calibrate(&calib)){
+        printf("RTC calibration failed, LSI used without compensation\n");
+    }
+    else{
+        printf("RTC calibrated: LSI %lu.%03lu Hz, CALM %u\n", (unsigned long)(calib.LSIFreq / 1000),
+               (unsigned long)(calib.LSIFreq % 1000), (unsigned int)calib.CalMinus);
+    }
+
+    app_state_rtc_set_configured();
 }
 
 static void Timer6_Config(void){
 
     Timer.tim_num = TIMER6;
     Timer.pTimer = TIM6;
-    Timer.prescaler = 8;
-    Timer.period = 10000 - 1;
+    Timer.prescaler = CLK_TIM_PSC(CLK_TIMCLK_APB1(CLK_OPP180), TIM6_CNT_HZ);
+    Timer.period = (TIM6_CNT_HZ / TIM6_TICK_HZ) - 1;
 
     Timer_Init(&Timer);
     Timer_IRQConfig(IRQ_NO_TIM6_DAC, ENABLE);
@@ -398,7 +541,9 @@ static void print_task_handler(void* parameters){
     for(;;){
         SEGGER_SYSVIEW_PrintfTarget("Print Task");
         xQueueReceive(q_print, &msg, portMAX_DELAY);
+        xSemaphoreTake(usart_tx_mutex, portMAX_DELAY);
         (void)USART_SendData(&USART3Handle, (uint8_t*)msg, strlen((char*)msg));
+        xSemaphoreGive(usart_tx_mutex);
     }
 }
 
@@ -406,10 +551,45 @@ static void print_task_handler(void* parameters){
 /*                               Weak Function Overwrite Definitions                                       */
 /***********************************************************************************************************/
 
+void vApplicationGetIdleTaskMemory(StaticTask_t** ppxIdleTaskTCBBuffer, StackType_t** ppxIdleTaskStackBuffer,
+                                   uint32_t* pulIdleTaskStackSize){
+
+    *ppxIdleTaskTCBBuffer = &idle_task_tcb;
+    *ppxIdleTaskStackBuffer = idle_task_stack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t** ppxTimerTaskTCBBuffer, StackType_t** ppxTimerTaskStackBuffer,
+                                    uint32_t* pulTimerTaskStackSize){
+
+    *ppxTimerTaskTCBBuffer = &timer_task_tcb;
+    *ppxTimerTaskStackBuffer = timer_task_stack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char* pcTaskName){
+
+    stack_mon_overflow(pcTaskName);
+}
+
+void vApplicationTickHook(void){
+
+    /* CYCCNT wraps in 24 s at 180 MHz, the run-time counter must see it more often than that */
+    (void)rt_stats_counter();
+}
+
 void TIM6_DAC_Handler(void){
     Timer_IRQHandling(&Timer);
 }
 
+void cmd_proto_send(const uint8_t* data, uint16_t len){
+
+    /* Whole frames are sent between two messages of the print task */
+    xSemaphoreTake(usart_tx_mutex, portMAX_DELAY);
+    USART_SendData(&USART3Handle, (uint8_t*)data, len);
+    xSemaphoreGive(usart_tx_mutex);
+}
+
 void Timer_ApplicationEventCallback(Timer_Num_t tim_num, Timer_Event_t timer_event){
 
     if(timer_event == TIMER_UIF_EVENT){
@@ -422,7 +602,32 @@ void Timer_ApplicationEventCallback(Timer_Num_t tim_num, Timer_Event_t timer_eve
     }
 }
 
-void USART3_Handler(void){
+void FLASH_Handler(void){
+
+    traceISR_ENTER();
+    Flash_IRQHandling();
+    traceISR_EXIT();
+}
+
+/* The streams are allocated at run time, so every stream has its handler */
+DMA_STREAM_HANDLER(1, 0)
+DMA_STREAM_HANDLER(1, 1)
+DMA_STREAM_HANDLER(1, 2)
+DMA_STREAM_HANDLER(1, 3)
+DMA_STREAM_HANDLER(1, 4)
+DMA_STREAM_HANDLER(1, 5)
+DMA_STREAM_HANDLER(1, 6)
+DMA_STREAM_HANDLER(1, 7)
+DMA_STREAM_HANDLER(2, 0)
+DMA_STREAM_HANDLER(2, 1)
+DMA_STREAM_HANDLER(2, 2)
+DMA_STREAM_HANDLER(2, 3)
+DMA_STREAM_HANDLER(2, 4)
+DMA_STREAM_HANDLER(2, 5)
+DMA_STREAM_HANDLER(2, 6)
+DMA_STREAM_HANDLER(2, 7)
+
+RAMFUNC void USART3_Handler(void){
 
     traceISR_ENTER();
     USART_IRQHandling(&USART3Handle);
@@ -432,23 +637,14 @@ void USART3_Handler(void){
 void USART_ApplicationEventCallback(USART_Handle_t* pUSART_Handle, uint8_t app_event){
 
     if(app_event == USART_EVENT_RX_CMPLT){
-        uint8_t dummy;
-
-        if(!xQueueIsQueueFullFromISR(q_data)){
-            xQueueSendFromISR(q_data, (void*)&user_data, NULL);
-        }
-        else{
-            if(user_data == '\r'){
-                /* Put the \r character at the end of the queue */
-                xQueueReceiveFromISR(q_data, (void*)&dummy, NULL);
-                xQueueSendFromISR(q_data, (void*)&user_data, NULL);
-            }
-        }
+        BaseType_t woken = pdFALSE;
 
-        if(user_data == '\r'){
-            xTaskNotifyFromISR(cmd_task_handle, 0, eNoAction, NULL);
+        /* The line is assembled here, the command task is only woken up when it is complete */
+        if(cmd_line_rx_byte(user_data)){
+            xTaskNotifyFromISR(cmd_task_handle, 0, eNoAction, &woken);
         }
         (void)USART_ReceiveDataIT(&USART3Handle, (uint8_t*)&user_data, 1);
+        portYIELD_FROM_ISR(woken);
     }
     else if(app_event == USART_EVENT_TX_CMPLT){
         /* do nothing */
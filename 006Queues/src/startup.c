@@ -15,7 +15,7 @@
 #define SRAM_SIZE       (128U * 1024U)
 /** @brief SRAM end address */
 #define SRAM_END        ((SRAM_START) + (SRAM_SIZE))
-/** @brief Stack start address */
+/** @brief Stack start address, top of SRAM2 (_estack in the linker script) */
 #define STACK_START     SRAM_END
 
 /** @brief Used for storing the end of the text section in the linker script */
@@ -26,11 +26,32 @@ extern uint32_t _sdata;
 extern uint32_t _edata;
 /** @brief Used to initialize data section of the linker script */
 extern uint32_t _la_data;
+/** @brief Used for storing the start of the ramfunc section in the linker script */
+extern uint32_t _sramfunc;
+/** @brief Used for storing the end of the ramfunc section in the linker script */
+extern uint32_t _eramfunc;
+/** @brief Used to initialize ramfunc section of the linker script */
+extern uint32_t _la_ramfunc;
 /** @brief Used for storing the start of the bss section in the linker script */
 extern uint32_t _sbss;
 /** @brief Used for storing the end of the bss section in the linker script */
 extern uint32_t _ebss;
 
+/** @brief Debug exception and monitor control register, TRCENA enables the DWT */
+#define DEMCR           (*(volatile uint32_t*)0xE000EDFCU)
+/** @brief DWT control register, bit 0 enables the cycle counter */
+#define DWT_CTRL        (*(volatile uint32_t*)0xE0001000U)
+/** @brief DWT cycle counter */
+#define DWT_CYCCNT      (*(volatile uint32_t*)0xE0001004U)
+
+/**
+ * @brief Function for copying a section from flash to SRAM.
+ * @param[in] pDst is the start of the section in SRAM, word aligned.
+ * @param[in] pEnd is the end of the section in SRAM, word aligned.
+ * @param[in] pSrc is the load address of the section in flash.
+ */
+static void Copy_Section(uint32_t *pDst, const uint32_t *pEnd, const uint32_t *pSrc);
+
 /** @brief Main function */
 int main(void);
 /** @brief Function for calling constructors and other library initialization which is 
@@ -354,20 +375,26 @@ void Default_Handler(void){
 }
 
 void Reset_Handler(void){
-    /* copy .data section to SRAM */
-    uint32_t size = (uint32_t)&_edata - (uint32_t)&_sdata;
-    uint8_t *pDst = (uint8_t*)&_sdata; /* sram */
-    uint8_t *pSrc = (uint8_t*)&_la_data; /* flash */
+    /* start counting cycles from reset, so the boot time can be measured (see main) */
+    DEMCR |= (1U << 24);
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= (1U << 0);
 
-    for(uint32_t i = 0; i < size; i++){
-        *pDst++ = *pSrc++;
-    }
+    /* copy .data and .ramfunc sections to SRAM, sections are word aligned by the linker script */
+    Copy_Section(&_sdata, &_edata, &_la_data);
+    Copy_Section(&_sramfunc, &_eramfunc, &_la_ramfunc);
 
-    /* init the .bss section to zero in SRAM */
-    size = (uint32_t)&_ebss - (uint32_t)&_sbss;
-    pDst = (uint8_t*)&_sbss;
+    /* init the .bss section to zero in SRAM, .noinit (heap and trace buffers) is not touched */
+    uint32_t *pDst = &_sbss;
 
-    for(uint32_t i = 0; i < size; i++){
+    while((&_ebss - pDst) >= 4){
+        pDst[0] = 0;
+        pDst[1] = 0;
+        pDst[2] = 0;
+        pDst[3] = 0;
+        pDst += 4;
+    }
+    while(pDst < &_ebss){
         *pDst++ = 0;
     }
 
@@ -375,3 +402,19 @@ void Reset_Handler(void){
 
     main();
 }
+
+static void Copy_Section(uint32_t *pDst, const uint32_t *pEnd, const uint32_t *pSrc){
+    /* four words per iteration, cutting the loop overhead and allowing LDM/STM bursts when optimizing */
+    while((pEnd - pDst) >= 4){
+        uint32_t w0 = pSrc[0], w1 = pSrc[1], w2 = pSrc[2], w3 = pSrc[3];
+        pDst[0] = w0;
+        pDst[1] = w1;
+        pDst[2] = w2;
+        pDst[3] = w3;
+        pDst += 4;
+        pSrc += 4;
+    }
+    while(pDst < pEnd){
+        *pDst++ = *pSrc++;
+    }
+}
@@ -31,6 +31,20 @@
 #define FLAG_RESET          RESET       /**< @brief Reset value for a flag */
 /** @} */
 
+/**
+ * @brief Attribute for placing a function in SRAM, it is copied from flash by Reset_Handler.
+ * @note Code in SRAM runs without flash wait states and does not depend on ART cache hits. Calls are done
+ *       through a register because SRAM is out of the range of a BL instruction from flash.
+ */
+#define RAMFUNC             __attribute__((section(".ramfunc"), long_call, noinline))
+
+/**
+ * @brief Attribute for placing a variable in SRAM2, used for the task stacks. It is not initialized at boot.
+ * @note SRAM2 is a separate slave of the bus matrix, so stack accesses of the CPU do not stall DMA
+ *       transfers to buffers in SRAM1.
+ */
+#define SRAM2_DATA          __attribute__((section(".sram2"), aligned(8)))
+
 /***********************************************************************************************************/
 /*                          ARM Cortex M4 Processor Specific Registers                                     */
 /***********************************************************************************************************/
@@ -969,6 +983,13 @@ typedef struct
 #define TIM_ARR             0   /**< @brief Auto-reload value */
 /** @} */
 
+/**
+ * @name Bit position definition TIM5 option register.
+ * @{
+ */
+#define TIM_OR_TI4_RMP      6   /**< @brief Timer input 4 remap (TIM5 only, 01 means LSI) */
+/** @} */
+
 /**
  * @name Bit position definition DMA low interrupt status register
  * @{
@@ -1219,6 +1240,16 @@ typedef struct
 #define RTC_PRER_PREDIV_A   16  /**< @brief Asynchronous prescaler factor */
 /** @} */
 
+/**
+ * @name Bit position definition RTC calibration register
+ * @{
+ */
+#define RTC_CALR_CALM       0   /**< @brief Calibration minus */
+#define RTC_CALR_CALW16     13  /**< @brief Use a 16-second calibration cycle period */
+#define RTC_CALR_CALW8      14  /**< @brief Use an 8-second calibration cycle period */
+#define RTC_CALR_CALP       15  /**< @brief Increase frequency of RTC by 488.5 ppm */
+/** @} */
+
 /**
  * @name Bit position definition RTC alarm x register
  * @{
@@ -1389,6 +1420,13 @@ typedef struct
 #define CRC_PCLK_EN()       (RCC->AHB1ENR |= (1 << 12)) /**< @brief Clock enable for CRC */
 /** @} */
 
+/**
+ * @name Clock enable macros for backup SRAM.
+ * @{
+ */
+#define BKPSRAM_PCLK_EN()   (RCC->AHB1ENR |= (1 << 18)) /**< @brief Clock enable for backup SRAM */
+/** @} */
+
 /**
  * @name Clock enable macros for TIM peripheral.
  * @{
@@ -1490,6 +1528,13 @@ typedef struct
 #define CRC_PCLK_DI()       (RCC->AHB1ENR &= ~(1 << 12))    /**< @brief Clock disable for CRC */
 /** @} */
 
+/**
+ * @name Clock disable macros for backup SRAM.
+ * @{
+ */
+#define BKPSRAM_PCLK_DI()   (RCC->AHB1ENR &= ~(1 << 18))    /**< @brief Clock disable for backup SRAM */
+/** @} */
+
 /**
  * @name Clock disable macros for TIM peripheral.
  * @{
@@ -1670,6 +1715,7 @@ typedef struct
  * @name IRQ (Interrupt Request) number.
  * @{
  */
+#define IRQ_NO_FLASH                4   /**< @brief Interrupt Num for FLASH global interrupt */
 #define IRQ_NO_EXTI0                6   /**< @brief Interrupt Num for EXTI0 */
 #define IRQ_NO_EXTI1                7   /**< @brief Interrupt Num for EXTI1 */
 #define IRQ_NO_EXTI2                8   /**< @brief Interrupt Num for EXTI2 */
@@ -4,8 +4,10 @@
 * @brief File containing the APIs for managing the task regarding the control of LEDs
 *
 * Public Functions:
-*       - void LED_task_handler(void* parameters)
-*       - void led_effect_callback(TimerHandle_t xTimer)
+*       - void    LED_task_handler(void* parameters)
+*       - void    led_effect_callback(TimerHandle_t xTimer)
+*       - uint8_t led_cmd_handler(uint8_t argc, char* argv[])
+*       - uint8_t led_set_effect(uint8_t effect)
 *
 * @note
 *       For further information about functions refer to the corresponding header file.
@@ -13,12 +15,14 @@
 
 #include "LEDs_task.h"
 #include "menu_cmd_task.h"
+#include "cmd_pool.h"
+#include "cmd_dispatch.h"
 #include "FreeRTOS.h"
 #include "queue.h"
 #include "timers.h"
 #include "gpio_driver.h"
+#include "app_state.h"
 #include <stdint.h>
-#include <string.h>
 
 /** @brief Variable for handling the queue used for printing */
 extern QueueHandle_t q_print;
@@ -31,6 +35,11 @@ extern TaskHandle_t menu_task_handle;
 /** @brief Array for handling the LED timers */
 extern TimerHandle_t led_timer_handle[4];
 
+/** @brief Number of slots of the table of LED effects */
+#define LED_CMD_SIZE        8
+/** @brief Seed of the hash of the table of LED effects */
+#define LED_CMD_SEED        1
+
 /***********************************************************************************************************/
 /*                                       Static Function Prototypes                                        */
 /***********************************************************************************************************/
@@ -41,6 +50,22 @@ extern TimerHandle_t led_timer_handle[4];
  */
 static void led_effect_stop(void);
 
+/**
+ * @brief Handler of the "none" effect: stops the effect running.
+ * @param[in] argc is the number of words.
+ * @param[in] argv is the array of words, argv[0] is the effect.
+ * @return 0 if the effect was applied, 1 if there are extra arguments.
+ */
+static uint8_t led_cmd_none(uint8_t argc, char* argv[]);
+
+/**
+ * @brief Handler of the "e1" to "e4" effects: starts the effect given by the last character.
+ * @param[in] argc is the number of words.
+ * @param[in] argv is the array of words, argv[0] is the effect.
+ * @return 0 if the effect was applied, 1 if there are extra arguments.
+ */
+static uint8_t led_cmd_effect(uint8_t argc, char* argv[]);
+
 /**
  * @brief Function to select an effect for the LEDs
  * @param[in] effect is the effect number, can be from 1 to 4
@@ -107,6 +132,18 @@ static void turn_on_odd_leds(void);
  */
 static void led_control(uint8_t value);
 
+/** @brief Effects of the LEDs, the same for the LED menu and the "led" command */
+static const cmd_entry_t led_cmd_entries[LED_CMD_SIZE] = {
+    CMD_ENTRY(LED_CMD_SIZE, LED_CMD_SEED, "none", 'n', 'e', led_cmd_none),
+    CMD_ENTRY(LED_CMD_SIZE, LED_CMD_SEED, "e1",   'e', '1', led_cmd_effect),
+    CMD_ENTRY(LED_CMD_SIZE, LED_CMD_SEED, "e2",   'e', '2', led_cmd_effect),
+    CMD_ENTRY(LED_CMD_SIZE, LED_CMD_SEED, "e3",   'e', '3', led_cmd_effect),
+    CMD_ENTRY(LED_CMD_SIZE, LED_CMD_SEED, "e4",   'e', '4', led_cmd_effect),
+};
+
+/** @brief Table of LED effects */
+const cmd_table_t led_cmd_table = {led_cmd_entries, LED_CMD_SIZE, LED_CMD_SEED};
+
 /***********************************************************************************************************/
 /*                                       Public API Definitions                                            */
 /***********************************************************************************************************/
@@ -115,44 +152,37 @@ void LED_task_handler(void* parameters){
 
     uint32_t cmd_addr;
     command_s* cmd;
+    char* argv[CMD_MAX_ARGS];
+    uint8_t argc;
     const char* msg_led = "========================\n"
                           "|      LED Effect      |\n"
                           "========================\n"
                           "(none,e1,e2,e3,e4)\n"
                           "Enter your choice here : ";
+    app_state_t state;
+
+    /* Resume the effect running before the last reset */
+    app_state_get(&state);
+    if((state.led_effect >= 1) && (state.led_effect <= 4)){
+        led_effect(state.led_effect);
+    }
 
     for(;;){
         SEGGER_SYSVIEW_PrintfTarget("LEDs Task");
         xTaskNotifyWait(0, 0, NULL, portMAX_DELAY);
         /* Print menu */
         xQueueSend(q_print, &msg_led, portMAX_DELAY);
-        /* Wait for commands */
-        xTaskNotifyWait(0, 0, &cmd_addr, portMAX_DELAY);
-        cmd = (command_s*)cmd_addr;
-
-        if(cmd->len <= 4){
-            if(!strcmp((char*)cmd->payload,"none")){
-                led_effect_stop();
-            }
-            else if(!strcmp((char*)cmd->payload, "e1")){
-                led_effect(1);
-            }
-            else if(!strcmp((char*)cmd->payload, "e2")){
-                led_effect(2);
-            }
-            else if(!strcmp((char*)cmd->payload, "e3")){
-                led_effect(3);
-            }
-            else if(!strcmp((char*)cmd->payload, "e4")){
-                led_effect(4);
-            }
-            else{
-                xQueueSend(q_print, &msg_invalid, portMAX_DELAY);
-            }
-        }
-        else{
+        /* Wait for commands, the value is cleared so a wake up without command reads NULL */
+        do{
+            xTaskNotifyWait(0, 0xFFFFFFFF, &cmd_addr, portMAX_DELAY);
+            cmd = (command_s*)cmd_addr;
+        }while(cmd == NULL);
+
+        argc = cmd_split((char*)cmd->payload, argv, CMD_MAX_ARGS);
+        if(cmd_dispatch(&led_cmd_table, argc, argv)){
             xQueueSend(q_print, &msg_invalid, portMAX_DELAY);
         }
+        cmd_pool_free(cmd);
 
         curr_state = sMainMenu;
         xTaskNotify(menu_task_handle, 0, eNoAction);
@@ -182,10 +212,57 @@ void led_effect_callback(TimerHandle_t xTimer){
     }
 }
 
+uint8_t led_cmd_handler(uint8_t argc, char* argv[]){
+
+    /* "led <effect>", the effect is looked up in the same table as in the LED menu */
+    if(argc != 2){
+        return 1;
+    }
+
+    return cmd_dispatch(&led_cmd_table, argc - 1, &argv[1]);
+}
+
+uint8_t led_set_effect(uint8_t effect){
+
+    if(effect > 4){
+        return 1;
+    }
+
+    if(effect == 0){
+        led_effect_stop();
+    }
+    else{
+        led_effect(effect);
+    }
+    app_state_set_led(effect);
+
+    return 0;
+}
+
 /***********************************************************************************************************/
 /*                                       Static Function Definitions                                       */
 /***********************************************************************************************************/
 
+static uint8_t led_cmd_none(uint8_t argc, char* argv[]){
+
+    if(argc != 1){
+        return 1;
+    }
+
+    return led_set_effect(0);
+}
+
+static uint8_t led_cmd_effect(uint8_t argc, char* argv[]){
+
+    uint8_t effect = argv[0][1] - '0';
+
+    if(argc != 1){
+        return 1;
+    }
+
+    return led_set_effect(effect);
+}
+
 static void led_effect_stop(void){
 
     for(uint8_t i = 0; i < 4; i++){
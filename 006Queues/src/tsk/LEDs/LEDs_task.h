@@ -5,8 +5,10 @@
 * LEDs
 *
 * Public Functions:
-*       - void LED_task_handler(void* parameters)
-*       - void led_effect_callback(TimerHandle_t xTimer)
+*       - void    LED_task_handler(void* parameters)
+*       - void    led_effect_callback(TimerHandle_t xTimer)
+*       - uint8_t led_cmd_handler(uint8_t argc, char* argv[])
+*       - uint8_t led_set_effect(uint8_t effect)
 */
 
 #ifndef LEDs_H
@@ -14,6 +16,10 @@
 
 #include "FreeRTOS.h"
 #include "timers.h"
+#include "cmd_dispatch.h"
+
+/** @brief Table of LED effects, for checking it at start up */
+extern const cmd_table_t led_cmd_table;
 
 /***********************************************************************************************************/
 /*                                       APIs Supported                                                    */
@@ -33,4 +39,19 @@ void LED_task_handler(void* parameters);
  */
 void led_effect_callback(TimerHandle_t xTimer);
 
+/**
+ * @brief Handler of the "led <none|e1|e2|e3|e4>" command, which selects an effect without the LED menu.
+ * @param[in] argc is the number of words.
+ * @param[in] argv is the array of words, argv[0] is "led".
+ * @return 0 if the effect was applied, 1 if the arguments are not valid.
+ */
+uint8_t led_cmd_handler(uint8_t argc, char* argv[]);
+
+/**
+ * @brief Function for selecting an effect of the LEDs and storing it, without printing anything.
+ * @param[in] effect is the effect number, 0 for none or 1 to 4.
+ * @return 0 if the effect was applied, 1 if the effect is not valid.
+ */
+uint8_t led_set_effect(uint8_t effect);
+
 #endif /* LEDs_H */
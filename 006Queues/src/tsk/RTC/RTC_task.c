@@ -4,8 +4,13 @@
 * @brief File containing the APIs for managing the task regarding the real time clock.
 *
 * Public Functions:
-*       - void rtc_task_handler(void* parameters)
-*       - void rtc_report_callback(TimerHandle_t xTimer)
+*       - void    rtc_task_handler(void* parameters)
+*       - void    rtc_report_callback(TimerHandle_t xTimer)
+*       - uint8_t rtc_cmd_handler(uint8_t argc, char* argv[])
+*       - uint8_t rtc_set_time(RTC_Time_t* time)
+*       - uint8_t rtc_set_date(RTC_Date_t* date)
+*       - void    rtc_set_report(uint8_t enable)
+*       - uint8_t rtc_get_time_date(RTC_Time_t* time, RTC_Date_t* date)
 *
 * @note
 *       For further information about functions refer to the corresponding header file.
@@ -13,14 +18,25 @@
 
 #include "RTC_task.h"
 #include "menu_cmd_task.h"
+#include "cmd_pool.h"
+#include "cmd_dispatch.h"
 #include "FreeRTOS.h"
+#include "task.h"
 #include "queue.h"
 #include "timers.h"
 #include "rtc_driver.h"
+#include "app_state.h"
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
 
+/** @brief Maximum time in ms waiting for the RTC shadow registers synchronization */
+#define RTC_SYNC_TIMEOUT_MS     10
+/** @brief Number of slots of the table of RTC commands */
+#define RTC_CMD_SIZE            5
+/** @brief Seed of the hash of the table of RTC commands */
+#define RTC_CMD_SEED            1
+
 /**
  * @brief Enum for managing the states of the FSM for configuring the time
  */
@@ -54,6 +70,8 @@ extern TimerHandle_t rtc_timer;
 
 /** @brief Message printed when the RTC date or time configuration is OK */
 static const char *msg_conf = "Configuration successful\n";
+/** @brief Message printed when the RTC registers are not synchronized on time */
+static const char *msg_sync_err = "RTC not synchronized, try again\n";
 
 /***********************************************************************************************************/
 /*                                       Static Function Prototypes                                        */
@@ -87,6 +105,54 @@ static void set_rtc_date(command_s* cmd);
  */
 static void set_rtc_report(command_s* cmd);
 
+/**
+ * @brief Function for checking and writing a time in the RTC, the new time is printed if it is valid.
+ * @param[in] time is a pointer to the time to be set.
+ * @return 0 if the time was set, 1 if it is not valid.
+ */
+static uint8_t rtc_apply_time(RTC_Time_t* time);
+
+/**
+ * @brief Function for checking and writing a date in the RTC, the new date is printed if it is valid.
+ * @param[in] date is a pointer to the date to be set.
+ * @return 0 if the date was set, 1 if it is not valid.
+ */
+static uint8_t rtc_apply_date(RTC_Date_t* date);
+
+/**
+ * @brief Handler of "rtc time hh:mm:ss am|pm".
+ * @param[in] argc is the number of words.
+ * @param[in] argv is the array of words, argv[0] is "time".
+ * @return 0 if the time was set, 1 if the arguments are not valid.
+ */
+static uint8_t rtc_cmd_time(uint8_t argc, char* argv[]);
+
+/**
+ * @brief Handler of "rtc date dd/mm/yy d", d is the day of the week (1-7 sun:1).
+ * @param[in] argc is the number of words.
+ * @param[in] argv is the array of words, argv[0] is "date".
+ * @return 0 if the date was set, 1 if the arguments are not valid.
+ */
+static uint8_t rtc_cmd_date(uint8_t argc, char* argv[]);
+
+/**
+ * @brief Handler of "rtc report y|n".
+ * @param[in] argc is the number of words.
+ * @param[in] argv is the array of words, argv[0] is "report".
+ * @return 0 if the report was changed, 1 if the arguments are not valid.
+ */
+static uint8_t rtc_cmd_report(uint8_t argc, char* argv[]);
+
+/**
+ * @brief Function for parsing numbers of one or two digits separated by a character, like "11:59:50".
+ * @param[in] str is the null terminated string.
+ * @param[in] sep is the separator.
+ * @param[out] out is the array where the numbers are stored.
+ * @param[in] num is the number of numbers expected.
+ * @return 0 if the string has exactly num numbers, 1 if not.
+ */
+static uint8_t parse_fields(const char* str, char sep, uint8_t* out, uint8_t num);
+
 /**
  * @brief Function for getting the current time and date of the RTC and sending to the print task via queue.
  * @return None
@@ -116,6 +182,22 @@ static uint8_t validate_rtc_information(RTC_Time_t* time , RTC_Date_t* date);
  */
 static void show_time_date_itm(void);
 
+/**
+ * @brief Function for yielding the CPU while the RTC registers are being synchronized.
+ * @return None
+ */
+static void rtc_sync_wait(void);
+
+/** @brief RTC commands, verbs following "rtc" */
+static const cmd_entry_t rtc_cmd_entries[RTC_CMD_SIZE] = {
+    CMD_ENTRY(RTC_CMD_SIZE, RTC_CMD_SEED, "time",   't', 'e', rtc_cmd_time),
+    CMD_ENTRY(RTC_CMD_SIZE, RTC_CMD_SEED, "date",   'd', 'e', rtc_cmd_date),
+    CMD_ENTRY(RTC_CMD_SIZE, RTC_CMD_SEED, "report", 'r', 't', rtc_cmd_report),
+};
+
+/** @brief Table of RTC commands */
+const cmd_table_t rtc_cmd_table = {rtc_cmd_entries, RTC_CMD_SIZE, RTC_CMD_SEED};
+
 /***********************************************************************************************************/
 /*                                       Public API Definitions                                            */
 /***********************************************************************************************************/
@@ -132,6 +214,13 @@ void rtc_task_handler(void* parameters){
                            "Enter your choice here : ";
     uint32_t cmd_addr;
     command_s *cmd;
+    app_state_t state;
+
+    /* Resume the report if it was enabled before the last reset */
+    app_state_get(&state);
+    if(state.rtc_report){
+        xTimerStart(rtc_timer, portMAX_DELAY);
+    }
 
     for(;;){
         SEGGER_SYSVIEW_PrintfTarget("RTC Task");
@@ -143,9 +232,12 @@ void rtc_task_handler(void* parameters){
         xQueueSend(q_print, &msg_rtc2, portMAX_DELAY);
 
         while(curr_state != sMainMenu){
-            /*Wait for command notification (Notify wait) */
-            xTaskNotifyWait(0, 0, &cmd_addr, portMAX_DELAY);
+            /*Wait for command notification (Notify wait), the value is cleared after reading it */
+            xTaskNotifyWait(0, 0xFFFFFFFF, &cmd_addr, portMAX_DELAY);
             cmd = (command_s*)cmd_addr;
+            if(cmd == NULL){
+                continue;
+            }
 
             switch(curr_state){
                 case sRtcMenu:
@@ -169,6 +261,7 @@ void rtc_task_handler(void* parameters){
                 default:
                     break;
             }
+            cmd_pool_free(cmd);
         }
 
         /*Notify menu task */
@@ -181,6 +274,62 @@ void rtc_report_callback(TimerHandle_t xTimer){
    show_time_date_itm();
 }
 
+uint8_t rtc_cmd_handler(uint8_t argc, char* argv[]){
+
+    /* "rtc <verb> <arguments>" */
+    if(argc < 2){
+        return 1;
+    }
+
+    return cmd_dispatch(&rtc_cmd_table, argc - 1, &argv[1]);
+}
+
+uint8_t rtc_set_time(RTC_Time_t* time){
+
+    if(validate_rtc_information(time, NULL)){
+        return 1;
+    }
+
+    RTC_SetTime(*time);
+
+    return 0;
+}
+
+uint8_t rtc_set_date(RTC_Date_t* date){
+
+    if(validate_rtc_information(NULL, date)){
+        return 1;
+    }
+
+    RTC_SetDate(*date);
+
+    return 0;
+}
+
+void rtc_set_report(uint8_t enable){
+
+    if(enable){
+        if(xTimerIsTimerActive(rtc_timer) == pdFALSE)
+            xTimerStart(rtc_timer, portMAX_DELAY);
+    }
+    else{
+        xTimerStop(rtc_timer, portMAX_DELAY);
+    }
+    app_state_set_report(enable);
+}
+
+uint8_t rtc_get_time_date(RTC_Time_t* time, RTC_Date_t* date){
+
+    /* Wait until the RTC time and date register are synchronized, sleeping the task meanwhile */
+    if(RTC_WaitSync(RTC_SYNC_TIMEOUT_MS, rtc_sync_wait)){
+        return 1;
+    }
+    RTC_GetTime(time);
+    RTC_GetDate(date);
+
+    return 0;
+}
+
 /***********************************************************************************************************/
 /*                                       Static Function Definitions                                       */
 /***********************************************************************************************************/
@@ -255,12 +404,7 @@ static void set_rtc_time(command_s* cmd){
         case RTC_PM_CONFIG:
             pm = getnumber(cmd->payload, cmd->len);
             time.PM = pm;
-            if(!validate_rtc_information(&time, NULL)){
-                RTC_SetTime(time);
-                xQueueSend(q_print, &msg_conf, portMAX_DELAY);
-                show_time_date();
-            }
-            else{
+            if(rtc_apply_time(&time)){
                 xQueueSend(q_print, &msg_invalid, portMAX_DELAY);
             }
             curr_state = sMainMenu;
@@ -305,12 +449,7 @@ static void set_rtc_date(command_s* cmd){
             year = getnumber(cmd->payload, cmd->len);
             date.YearUnits = year % 10;
             date.YearTens = (year - date.YearUnits)/10;
-            if(!validate_rtc_information(NULL, &date)){
-                RTC_SetDate(date);
-                xQueueSend(q_print,&msg_conf, portMAX_DELAY);
-                show_time_date();
-            }
-            else{
+            if(rtc_apply_date(&date)){
                 xQueueSend(q_print, &msg_invalid, portMAX_DELAY);
             }
             curr_state = sMainMenu;
@@ -325,11 +464,10 @@ static void set_rtc_report(command_s* cmd){
 
     if(cmd->len == 1){
         if(cmd->payload[0] == 'y'){
-            if(xTimerIsTimerActive(rtc_timer) == pdFALSE)
-                xTimerStart(rtc_timer, portMAX_DELAY);
+            rtc_set_report(1);
         }
         else if(cmd->payload[0] == 'n'){
-            xTimerStop(rtc_timer, portMAX_DELAY);
+            rtc_set_report(0);
         }
         else{
             xQueueSend(q_print, &msg_invalid, portMAX_DELAY);
@@ -341,6 +479,122 @@ static void set_rtc_report(command_s* cmd){
     curr_state = sMainMenu;
 }
 
+static uint8_t rtc_apply_time(RTC_Time_t* time){
+
+    if(rtc_set_time(time)){
+        return 1;
+    }
+
+    xQueueSend(q_print, &msg_conf, portMAX_DELAY);
+    show_time_date();
+
+    return 0;
+}
+
+static uint8_t rtc_apply_date(RTC_Date_t* date){
+
+    if(rtc_set_date(date)){
+        return 1;
+    }
+
+    xQueueSend(q_print, &msg_conf, portMAX_DELAY);
+    show_time_date();
+
+    return 0;
+}
+
+static uint8_t rtc_cmd_time(uint8_t argc, char* argv[]){
+
+    RTC_Time_t time = {0};
+    uint8_t hms[3];
+
+    if((argc != 3) || parse_fields(argv[1], ':', hms, 3)){
+        return 1;
+    }
+
+    if(!strcmp(argv[2], "pm") || !strcmp(argv[2], "PM")){
+        time.PM = 1;
+    }
+    else if(strcmp(argv[2], "am") && strcmp(argv[2], "AM")){
+        return 1;
+    }
+
+    time.HourTens = hms[0] / 10;
+    time.HourUnits = hms[0] % 10;
+    time.MinuteTens = hms[1] / 10;
+    time.MinuteUnits = hms[1] % 10;
+    time.SecondTens = hms[2] / 10;
+    time.SecondUnits = hms[2] % 10;
+
+    return rtc_apply_time(&time);
+}
+
+static uint8_t rtc_cmd_date(uint8_t argc, char* argv[]){
+
+    RTC_Date_t date = {0};
+    uint8_t dmy[3];
+    uint8_t dow;
+
+    if((argc != 3) || parse_fields(argv[1], '/', dmy, 3) || parse_fields(argv[2], '\0', &dow, 1)){
+        return 1;
+    }
+
+    date.DateTens = dmy[0] / 10;
+    date.DateUnits = dmy[0] % 10;
+    date.MonthTens = dmy[1] / 10;
+    date.MonthUnits = dmy[1] % 10;
+    date.YearTens = dmy[2] / 10;
+    date.YearUnits = dmy[2] % 10;
+    date.WeekDayUnits = dow;
+
+    return rtc_apply_date(&date);
+}
+
+static uint8_t rtc_cmd_report(uint8_t argc, char* argv[]){
+
+    if((argc != 2) || (argv[1][1] != '\0')){
+        return 1;
+    }
+
+    if(argv[1][0] == 'y'){
+        rtc_set_report(1);
+    }
+    else if(argv[1][0] == 'n'){
+        rtc_set_report(0);
+    }
+    else{
+        return 1;
+    }
+
+    return 0;
+}
+
+static uint8_t parse_fields(const char* str, char sep, uint8_t* out, uint8_t num){
+
+    uint8_t digits;
+
+    for(uint8_t i = 0; i < num; i++){
+        out[i] = 0;
+        for(digits = 0; (str[digits] >= '0') && (str[digits] <= '9'); digits++){
+            if(digits == 2){
+                return 1;
+            }
+            out[i] = (out[i] * 10) + (str[digits] - '0');
+        }
+        if(digits == 0){
+            return 1;
+        }
+        str += digits;
+        /* Fields are separated by sep, the last one ends the string */
+        if(*str != ((i == (num - 1)) ? '\0' : sep)){
+            return 1;
+        }
+        str++;
+    }
+
+    return 0;
+}
+
 static void show_time_date(void){
 
     static char showtime[50];
@@ -356,12 +610,11 @@ static void show_time_date(void){
     memset(&date, 0, sizeof(date));
     memset(&time, 0, sizeof(time));
 
-    /* Wait until the RTC time and date register are synchronized */
-    while(!RTC_GetRSF());
-    /* Get the RTC current Time */
-    RTC_GetTime(&time);
-    /* Get the RTC current Date */
-    RTC_GetDate(&date);
+    /* Get the RTC current time and date */
+    if(rtc_get_time_date(&time, &date)){
+        xQueueSend(q_print, &msg_sync_err, portMAX_DELAY);
+        return;
+    }
 
     if(time.PM){
         pm_am = pm;
@@ -469,3 +722,8 @@ static void show_time_date_itm(void){
            date.MonthTens, date.MonthUnits,
            date.DateTens, date.DateUnits);
 }
+
+static void rtc_sync_wait(void){
+
+    vTaskDelay(pdMS_TO_TICKS(1));
+}
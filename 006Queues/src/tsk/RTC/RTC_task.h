@@ -5,8 +5,13 @@
 * clock.
 *
 * Public Functions:
-*       - void rtc_task_handler(void* parameters)
-*       - void rtc_report_callback(TimerHandle_t xTimer)
+*       - void    rtc_task_handler(void* parameters)
+*       - void    rtc_report_callback(TimerHandle_t xTimer)
+*       - uint8_t rtc_cmd_handler(uint8_t argc, char* argv[])
+*       - uint8_t rtc_set_time(RTC_Time_t* time)
+*       - uint8_t rtc_set_date(RTC_Date_t* date)
+*       - void    rtc_set_report(uint8_t enable)
+*       - uint8_t rtc_get_time_date(RTC_Time_t* time, RTC_Date_t* date)
 */
 
 #ifndef RTC_H
@@ -14,6 +19,11 @@
 
 #include "FreeRTOS.h"
 #include "timers.h"
+#include "cmd_dispatch.h"
+#include "rtc_driver.h"
+
+/** @brief Table of RTC commands, for checking it at start up */
+extern const cmd_table_t rtc_cmd_table;
 
 /***********************************************************************************************************/
 /*                                       APIs Supported                                                    */
@@ -33,4 +43,43 @@ void rtc_task_handler(void* parameters);
  */
 void rtc_report_callback(TimerHandle_t xTimer);
 
+/**
+ * @brief Handler of the "rtc <time|date|report> <arguments>" command, which configures the RTC without the
+ * RTC menu.
+ * @param[in] argc is the number of words.
+ * @param[in] argv is the array of words, argv[0] is "rtc".
+ * @return 0 if the command was applied, 1 if the arguments are not valid.
+ */
+uint8_t rtc_cmd_handler(uint8_t argc, char* argv[]);
+
+/**
+ * @brief Function for checking and writing a time in the RTC, without printing anything.
+ * @param[in] time is a pointer to the time to be set.
+ * @return 0 if the time was set, 1 if it is not valid.
+ */
+uint8_t rtc_set_time(RTC_Time_t* time);
+
+/**
+ * @brief Function for checking and writing a date in the RTC, without printing anything.
+ * @param[in] date is a pointer to the date to be set.
+ * @return 0 if the date was set, 1 if it is not valid.
+ */
+uint8_t rtc_set_date(RTC_Date_t* date);
+
+/**
+ * @brief Function for enabling or disabling the RTC report and storing the setting.
+ * @param[in] enable is 1 for enabling the report, 0 for disabling it.
+ * @return None
+ */
+void rtc_set_report(uint8_t enable);
+
+/**
+ * @brief Function for reading the current time and date once the RTC shadow registers are synchronized. The
+ * calling task sleeps while waiting.
+ * @param[out] time is a pointer where the time is stored.
+ * @param[out] date is a pointer where the date is stored.
+ * @return 0 if the values were read, 1 if the synchronization timed out.
+ */
+uint8_t rtc_get_time_date(RTC_Time_t* time, RTC_Date_t* date);
+
 #endif /* RTC_H  */
@@ -0,0 +1,206 @@
+/********************************************************************************************************//**
+* @file bench_task.c
+*
+* @brief File containing the APIs for managing the task that measures the effect of the flash accelerator
+* (caches and prefetch) on a CPU bound kernel and the cost of the CRC calculation.
+*
+* Public Functions:
+*       - void bench_task_handler(void* parameters)
+*       - void CRC_ApplicationEventCallback(CRC_Event_t crc_event, uint32_t crc)
+*
+* @note
+*       For further information about functions refer to the corresponding header file.
+*/
+
+#include "bench_task.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "flash_driver.h"
+#include "crc_driver.h"
+#include "stack_mon_task.h"
+#include <stdint.h>
+#include <stdio.h>
+
+#define DWT_CYCCNT  (*(volatile uint32_t*)0xE0001004)
+
+/** @brief Number of taps of the benchmark filter */
+#define BENCH_TAPS          32
+/** @brief Number of samples filtered in each run */
+#define BENCH_SAMPLES       256
+/** @brief Number of runs averaged for each configuration */
+#define BENCH_RUNS          4
+
+/**
+ * @brief Structure with an accelerator configuration to be measured
+ */
+typedef struct{
+    const char* name;       /**< Name printed with the result */
+    uint8_t icache;         /**< ENABLE or DISABLE the instruction cache */
+    uint8_t dcache;         /**< ENABLE or DISABLE the data cache */
+    uint8_t prefetch;       /**< ENABLE or DISABLE the prefetch buffer */
+}bench_cfg_t;
+
+/** @brief Accelerator configurations to be measured, the last one is left active */
+static const bench_cfg_t bench_cfg[] = {
+    {"all off",          DISABLE, DISABLE, DISABLE},
+    {"prefetch",         DISABLE, DISABLE, ENABLE},
+    {"icache",           ENABLE,  DISABLE, DISABLE},
+    {"icache+dcache",    ENABLE,  ENABLE,  DISABLE},
+    {"all on",           ENABLE,  ENABLE,  ENABLE},
+};
+
+/** @brief Filter coefficients, kept in flash so data accesses also go through the accelerator */
+static const int16_t bench_coeff[BENCH_TAPS] = {
+     -12,  -31,  -45,  -38,    0,   71,  160,  236,
+     260,  198,   36, -205, -468, -668, -706, -487,
+      36,  837, 1826, 2859, 3762, 4369, 4575, 4369,
+    3762, 2859, 1826,  837,   36, -487, -706, -668,
+};
+
+/** @brief Number of words of the CRC benchmark, the first 16KB sector of the flash image */
+#define BENCH_CRC_WORDS     4096
+
+/** @brief Result of the kernel, volatile so the compiler does not remove the computation */
+static volatile int32_t bench_sink;
+/** @brief Task waiting for the end of the CRC calculation by DMA */
+static TaskHandle_t bench_crc_task = NULL;
+/** @brief Event which finished the CRC calculation by DMA */
+static volatile CRC_Event_t bench_crc_event = CRC_EVENT_DMA_ERROR;
+/** @brief CRC calculated by DMA */
+static volatile uint32_t bench_crc_value;
+
+/***********************************************************************************************************/
+/*                                       Static Function Prototypes                                        */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function with the CPU bound kernel: a FIR filter over a generated signal.
+ * @return None
+ */
+static void bench_kernel(void);
+
+/**
+ * @brief Function for measuring the kernel with the current accelerator configuration.
+ * @return average number of CPU cycles of a run.
+ */
+static uint32_t bench_measure(void);
+
+/**
+ * @brief Function for calculating the CRC of the flash image with the CPU feeding the CRC peripheral and with
+ *        DMA, printing the cycles of each one and checking that both results match.
+ * @return None
+ */
+static void bench_crc(void);
+
+/***********************************************************************************************************/
+/*                                       Public API Definitions                                            */
+/***********************************************************************************************************/
+
+void bench_task_handler(void* parameters){
+
+    uint32_t cycles[sizeof(bench_cfg)/sizeof(bench_cfg[0])];
+
+    for(uint8_t i = 0; i < (sizeof(bench_cfg)/sizeof(bench_cfg[0])); i++){
+        /* The accelerator is shared by all the tasks, nobody else runs while it is reconfigured */
+        vTaskSuspendAll();
+        Flash_ConfigAccelerator(bench_cfg[i].icache, bench_cfg[i].dcache, bench_cfg[i].prefetch);
+        cycles[i] = bench_measure();
+        (void)xTaskResumeAll();
+    }
+
+    for(uint8_t i = 0; i < (sizeof(bench_cfg)/sizeof(bench_cfg[0])); i++){
+        printf("Bench %-14s %lu cycles (x%lu.%02lu)\n", bench_cfg[i].name, (unsigned long)cycles[i],
+               (unsigned long)(cycles[0] / cycles[i]),
+               (unsigned long)(((cycles[0] % cycles[i]) * 100) / cycles[i]));
+    }
+
+    bench_crc();
+
+    /* The stack report keeps the usage of the benchmark after it is gone */
+    stack_mon_unregister(NULL);
+    vTaskDelete(NULL);
+}
+
+/***********************************************************************************************************/
+/*                                       Static Function Definitions                                       */
+/***********************************************************************************************************/
+
+static void bench_kernel(void){
+
+    int16_t x[BENCH_TAPS] = {0};
+    int32_t acc = 0;
+    int16_t sample = 0;
+
+    for(uint16_t n = 0; n < BENCH_SAMPLES; n++){
+        /* Triangular input signal */
+        sample = (n & 0x40) ? (sample - 512) : (sample + 512);
+
+        for(uint8_t k = BENCH_TAPS - 1; k > 0; k--){
+            x[k] = x[k - 1];
+        }
+        x[0] = sample;
+
+        acc = 0;
+        for(uint8_t k = 0; k < BENCH_TAPS; k++){
+            acc += (int32_t)x[k] * bench_coeff[k];
+        }
+        bench_sink = acc >> 15;
+    }
+}
+
+static uint32_t bench_measure(void){
+
+    uint32_t start;
+    uint32_t total = 0;
+
+    /* First run only warms up the caches */
+    bench_kernel();
+
+    for(uint8_t i = 0; i < BENCH_RUNS; i++){
+        start = DWT_CYCCNT;
+        bench_kernel();
+        total += DWT_CYCCNT - start;
+    }
+
+    return total / BENCH_RUNS;
+}
+
+static void bench_crc(void){
+
+    const uint32_t* image = (const uint32_t*)FLASH_BASEADDR;
+    uint32_t start, cpu_cycles, dma_cycles;
+    uint32_t crc;
+
+    start = DWT_CYCCNT;
+    crc = CRC_Words(CRC_INIT_VALUE, image, BENCH_CRC_WORDS);
+    cpu_cycles = DWT_CYCCNT - start;
+
+    /* The cycles include the switch back to this task, the CPU runs other tasks while DMA feeds the CRC */
+    bench_crc_task = xTaskGetCurrentTaskHandle();
+    start = DWT_CYCCNT;
+    if(CRC_WordsDMA(CRC_INIT_VALUE, image, BENCH_CRC_WORDS) || !ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100))){
+        printf("CRC DMA could not be started or timed out\n");
+        return;
+    }
+    dma_cycles = DWT_CYCCNT - start;
+
+    printf("CRC %u bytes: CPU %lu cycles, DMA %lu cycles, %s\n", BENCH_CRC_WORDS * 4, (unsigned long)cpu_cycles,
+           (unsigned long)dma_cycles,
+           ((bench_crc_event == CRC_EVENT_DMA_CMPLT) && (bench_crc_value == crc)) ? "match" : "MISMATCH");
+}
+
+/***********************************************************************************************************/
+/*                               Weak Function Overwrite Definitions                                       */
+/***********************************************************************************************************/
+
+void CRC_ApplicationEventCallback(CRC_Event_t crc_event, uint32_t crc){
+
+    BaseType_t woken = pdFALSE;
+
+    bench_crc_event = crc_event;
+    bench_crc_value = crc;
+    if(bench_crc_task != NULL){
+        vTaskNotifyGiveFromISR(bench_crc_task, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
@@ -0,0 +1,28 @@
+/********************************************************************************************************//**
+* @file bench_task.h
+*
+* @brief Header file containing the prototypes of the APIs for managing the task that measures the effect of
+* the flash accelerator (caches and prefetch) on a CPU bound kernel and the cost of the CRC calculation. The
+* FreeRTOS heaps are compared on the host, see test/heap_bench.c.
+*
+* Public Functions:
+*       - void bench_task_handler(void* parameters)
+*/
+
+#ifndef BENCH_TASK_H
+#define BENCH_TASK_H
+
+/***********************************************************************************************************/
+/*                                       APIs Supported                                                    */
+/***********************************************************************************************************/
+
+/**
+ * @brief Task for running the benchmark once for every accelerator configuration, calculating the CRC of the
+ *        flash image with the CPU and with DMA, and printing the results.
+ * @param[in] parameters is a pointer to the input parameters to the task
+ * @return None
+ * @note The task deletes itself when it finishes, leaving caches and prefetch enabled.
+ */
+void bench_task_handler(void* parameters);
+
+#endif /* BENCH_TASK_H */
@@ -0,0 +1,97 @@
+/********************************************************************************************************//**
+* @file cmd_dispatch.c
+*
+* @brief File containing the APIs for dispatching text commands through constant tables of verbs indexed by a
+* perfect hash.
+*
+* Public Functions:
+*       - uint8_t            cmd_hash(const char* word, uint8_t len, const cmd_table_t* table)
+*       - const cmd_entry_t* cmd_find(const cmd_table_t* table, const char* word, uint8_t len)
+*       - uint8_t            cmd_split(char* line, char* argv[], uint8_t max)
+*       - uint8_t            cmd_dispatch(const cmd_table_t* table, uint8_t argc, char* argv[])
+*       - uint8_t            cmd_table_check(const cmd_table_t* table)
+*
+* @note
+*       For further information about functions refer to the corresponding header file.
+*/
+
+#include "cmd_dispatch.h"
+#include <stdint.h>
+#include <string.h>
+
+/***********************************************************************************************************/
+/*                                       Public API Definitions                                            */
+/***********************************************************************************************************/
+
+uint8_t cmd_hash(const char* word, uint8_t len, const cmd_table_t* table){
+
+    return CMD_HASH(len, (uint8_t)word[0], (uint8_t)word[len - 1], table->seed, table->size);
+}
+
+const cmd_entry_t* cmd_find(const cmd_table_t* table, const char* word, uint8_t len){
+
+    const cmd_entry_t* entry;
+
+    if(len == 0){
+        return NULL;
+    }
+
+    entry = &table->entries[cmd_hash(word, len, table)];
+    if((entry->verb == NULL) || (strncmp(entry->verb, word, len) != 0) || (entry->verb[len] != '\0')){
+        return NULL;
+    }
+
+    return entry;
+}
+
+uint8_t cmd_split(char* line, char* argv[], uint8_t max){
+
+    uint8_t argc = 0;
+
+    while(*line != '\0'){
+        if(*line == ' '){
+            *line++ = '\0';
+            continue;
+        }
+        if(argc == max){
+            break;
+        }
+        argv[argc++] = line;
+        while((*line != ' ') && (*line != '\0')){
+            line++;
+        }
+    }
+
+    return argc;
+}
+
+uint8_t cmd_dispatch(const cmd_table_t* table, uint8_t argc, char* argv[]){
+
+    const cmd_entry_t* entry;
+
+    if(argc == 0){
+        return 1;
+    }
+
+    entry = cmd_find(table, argv[0], strlen(argv[0]));
+    if(entry == NULL){
+        return 1;
+    }
+
+    return entry->handler(argc, argv);
+}
+
+uint8_t cmd_table_check(const cmd_table_t* table){
+
+    const char* verb;
+
+    for(uint8_t i = 0; i < table->size; i++){
+        verb = table->entries[i].verb;
+        if((verb != NULL) && ((verb[0] == '\0') || (cmd_hash(verb, strlen(verb), table) != i) ||
+                              (table->entries[i].handler == NULL))){
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+/********************************************************************************************************//**
+* @file cmd_dispatch.h
+*
+* @brief Header file containing the prototypes of the APIs for dispatching text commands through constant
+* tables of verbs indexed by a perfect hash.
+*
+* Public Functions:
+*       - uint8_t            cmd_hash(const char* word, uint8_t len, const cmd_table_t* table)
+*       - const cmd_entry_t* cmd_find(const cmd_table_t* table, const char* word, uint8_t len)
+*       - uint8_t            cmd_split(char* line, char* argv[], uint8_t max)
+*       - uint8_t            cmd_dispatch(const cmd_table_t* table, uint8_t argc, char* argv[])
+*       - uint8_t            cmd_table_check(const cmd_table_t* table)
+*
+* @note
+*       Each verb is stored in the slot given by the hash of its length and its first and last characters, so
+*       a lookup is one hash and one string compare whatever the number of verbs. Tables are filled with
+*       CMD_ENTRY, two verbs landing in the same slot are reported by the compiler (-Werror=override-init);
+*       the seed or the size of the table must be changed then.
+*/
+
+#ifndef CMD_DISPATCH_H
+#define CMD_DISPATCH_H
+
+#include <stdint.h>
+
+/** @brief Maximum number of words of a command, verb included */
+#define CMD_MAX_ARGS        6
+
+/** @brief Slot of a verb in a table of the given size and seed */
+#define CMD_HASH(len, first, last, seed, size)  (((((uint32_t)(first)) * (seed)) + ((uint32_t)(len) << 2) +     \
+                                                  ((uint32_t)(last))) % (size))
+
+/** @brief Entry of a table with the verb in its slot, first and last are the first and last verb characters */
+#define CMD_ENTRY(size, seed, verb, first, last, fn) \
+    [CMD_HASH(sizeof(verb) - 1, first, last, seed, size)] = {verb, fn}
+
+/**
+ * @brief Handler of a verb.
+ * @param[in] argc is the number of words, argv[0] is the verb.
+ * @param[in] argv is the array of words.
+ * @return 0 if the command was executed, 1 if the arguments are not valid.
+ */
+typedef uint8_t (*cmd_handler_t)(uint8_t argc, char* argv[]);
+
+/**
+ * @brief Structure with a verb and its handler
+ */
+typedef struct{
+    const char* verb;       /**< Verb, NULL for an empty slot */
+    cmd_handler_t handler;  /**< Function parsing the arguments and executing the command */
+}cmd_entry_t;
+
+/**
+ * @brief Structure with a table of verbs
+ */
+typedef struct{
+    const cmd_entry_t* entries; /**< Slots, indexed by CMD_HASH */
+    uint8_t size;               /**< Number of slots */
+    uint8_t seed;               /**< Seed of CMD_HASH used for filling the slots */
+}cmd_table_t;
+
+/***********************************************************************************************************/
+/*                                       APIs Supported                                                    */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for getting the slot of a word in a table.
+ * @param[in] word is a pointer to the word, it does not need to be null terminated.
+ * @param[in] len is the length of the word, at least 1.
+ * @param[in] table is a pointer to the table.
+ * @return slot of the word.
+ */
+uint8_t cmd_hash(const char* word, uint8_t len, const cmd_table_t* table);
+
+/**
+ * @brief Function for looking for a verb in a table.
+ * @param[in] table is a pointer to the table.
+ * @param[in] word is a pointer to the word, it does not need to be null terminated.
+ * @param[in] len is the length of the word.
+ * @return pointer to the entry of the verb, NULL if the table does not have it.
+ */
+const cmd_entry_t* cmd_find(const cmd_table_t* table, const char* word, uint8_t len);
+
+/**
+ * @brief Function for splitting a line in words separated by spaces, the line is modified.
+ * @param[in,out] line is the null terminated line, the spaces are replaced by '\0'.
+ * @param[out] argv is the array where the pointers to the words are stored.
+ * @param[in] max is the size of argv.
+ * @return number of words, words after max are ignored.
+ */
+uint8_t cmd_split(char* line, char* argv[], uint8_t max);
+
+/**
+ * @brief Function for running the handler of the verb in argv[0].
+ * @param[in] table is a pointer to the table.
+ * @param[in] argc is the number of words.
+ * @param[in] argv is the array of words.
+ * @return 0 if the command was executed.
+ *         1 if the verb is unknown or the arguments are not valid.
+ */
+uint8_t cmd_dispatch(const cmd_table_t* table, uint8_t argc, char* argv[]);
+
+/**
+ * @brief Function for checking that every verb of a table is in the slot of its hash, which fails when the
+ *        first or last character given to CMD_ENTRY do not match the verb.
+ * @param[in] table is a pointer to the table.
+ * @return 0 if the table is consistent, 1 if not.
+ */
+uint8_t cmd_table_check(const cmd_table_t* table);
+
+#endif /* CMD_DISPATCH_H */
@@ -0,0 +1,164 @@
+/********************************************************************************************************//**
+* @file cmd_line.c
+*
+* @brief File containing the APIs for assembling the received characters into lines inside the reception
+* interrupt, so the command task is only woken up with complete lines.
+*
+* Public Functions:
+*       - uint8_t cmd_line_rx_byte(uint8_t byte)
+*       - uint8_t cmd_line_take(uint8_t* line, uint8_t* len, uint8_t* frame)
+*       - void    cmd_line_get_stats(cmd_line_stats_t* stats)
+*
+* @note
+*       For further information about functions refer to the corresponding header file.
+*/
+
+#include "cmd_line.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+#include <string.h>
+
+_Static_assert((CMD_LINE_MAX_LEN > 0) && (CMD_LINE_MAX_LEN < 255), "The line length is stored in a uint8_t");
+
+/** @brief Line buffers, one filled by the interrupt and the other one waiting for the command task */
+static uint8_t line_buf[2][CMD_LINE_MAX_LEN + 1];
+/** @brief Length of the complete line of each buffer */
+static uint8_t line_len[2];
+/** @brief 1 if the complete line of the buffer is a binary frame */
+static uint8_t line_frame[2];
+/** @brief Buffer being filled by the interrupt */
+static uint8_t rx_index = 0;
+/** @brief Number of characters of the line being received */
+static uint8_t rx_len = 0;
+/** @brief 1 when the line being received is too long, it is discarded at the end */
+static uint8_t rx_overflow = 0;
+/** @brief 1 while a binary frame is being received */
+static uint8_t rx_frame = 0;
+/** @brief 1 when the previous byte of the frame was CMD_LINE_FRAME_ESC */
+static uint8_t rx_escape = 0;
+/** @brief Buffer with the complete line, valid while line_ready is 1 */
+static uint8_t ready_index = 0;
+/** @brief 1 while a complete line has not been taken, written by the interrupt and cleared by the task */
+static uint8_t line_ready = 0;
+/** @brief Counters of the line assembler */
+static cmd_line_stats_t line_stats = {0};
+
+/***********************************************************************************************************/
+/*                                       Public API Definitions                                            */
+/***********************************************************************************************************/
+
+uint8_t cmd_line_rx_byte(uint8_t byte){
+
+    uint8_t complete = 0;
+
+    if(rx_frame){
+        /* Binary frames are stored up to the closing delimiter, empty frames are skipped. A '\r' is escaped
+           inside a frame, so it means the frame was started by a stray 0x00 and ends it as an overflow */
+        if(byte == '\r'){
+            rx_overflow = 1;
+        }
+        else if(byte == CMD_LINE_FRAME_ESC){
+            rx_escape = 1;
+            return 0;
+        }
+        else if(byte != 0x00){
+            if(rx_escape){
+                byte ^= CMD_LINE_FRAME_XOR;
+                rx_escape = 0;
+            }
+            if(rx_len < CMD_LINE_MAX_LEN){
+                line_buf[rx_index][rx_len++] = byte;
+                return 0;
+            }
+            /* Too long, back to lines without waiting for a delimiter which may never come */
+            rx_overflow = 1;
+        }
+        else if(rx_len == 0){
+            return 0;
+        }
+    }
+    else if(byte == 0x00){
+        /* Start of a binary frame, a partial text line is lost */
+        rx_frame = 1;
+        rx_len = 0;
+        rx_overflow = 0;
+        rx_escape = 0;
+        return 0;
+    }
+    else{
+        switch(byte){
+            case '\n':
+                return 0;
+            case '\b':
+            case 0x7F:
+                if((rx_len > 0) && !rx_overflow){
+                    rx_len--;
+                }
+                return 0;
+            case '\r':
+                break;
+            default:
+                if(rx_len < CMD_LINE_MAX_LEN){
+                    line_buf[rx_index][rx_len++] = byte;
+                }
+                else{
+                    rx_overflow = 1;
+                }
+                return 0;
+        }
+    }
+
+    /* End of line or frame */
+    if(rx_overflow){
+        line_stats.overflows++;
+    }
+    else if(__atomic_load_n(&line_ready, __ATOMIC_ACQUIRE)){
+        line_stats.dropped++;
+    }
+    else{
+        line_buf[rx_index][rx_len] = '\0';
+        line_len[rx_index] = rx_len;
+        line_frame[rx_index] = rx_frame;
+        ready_index = rx_index;
+        rx_index ^= 1;
+        if(rx_frame){
+            line_stats.frames++;
+        }
+        else{
+            line_stats.lines++;
+        }
+        __atomic_store_n(&line_ready, 1, __ATOMIC_RELEASE);
+        complete = 1;
+    }
+    rx_len = 0;
+    rx_overflow = 0;
+    rx_frame = 0;
+    rx_escape = 0;
+
+    return complete;
+}
+
+uint8_t cmd_line_take(uint8_t* line, uint8_t* len, uint8_t* frame){
+
+    if(!__atomic_load_n(&line_ready, __ATOMIC_ACQUIRE)){
+        return 1;
+    }
+
+    /* The interrupt does not write ready_index nor its buffer until line_ready is cleared */
+    if(line != NULL){
+        memcpy(line, line_buf[ready_index], line_len[ready_index] + 1);
+    }
+    *len = line_len[ready_index];
+    *frame = line_frame[ready_index];
+    __atomic_store_n(&line_ready, 0, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+void cmd_line_get_stats(cmd_line_stats_t* stats){
+
+    taskENTER_CRITICAL();
+    *stats = line_stats;
+    taskEXIT_CRITICAL();
+}
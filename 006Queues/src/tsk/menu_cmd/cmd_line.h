@@ -0,0 +1,77 @@
+/********************************************************************************************************//**
+* @file cmd_line.h
+*
+* @brief Header file containing the prototypes of the APIs for assembling the received characters into lines
+* inside the reception interrupt, so the command task is only woken up with complete lines.
+*
+* Public Functions:
+*       - uint8_t cmd_line_rx_byte(uint8_t byte)
+*       - uint8_t cmd_line_take(uint8_t* line, uint8_t* len, uint8_t* frame)
+*       - void    cmd_line_get_stats(cmd_line_stats_t* stats)
+*
+* @note
+*       Lines are finished by '\r', '\n' is ignored and backspace (0x08 or 0x7F) removes the last character.
+*       A 0x00 byte starts a binary frame instead: the following bytes are stored until the next 0x00, so frames
+*       are sent as 0x00, COBS encoded frame, 0x00. Inside a frame 0x0D and CMD_LINE_FRAME_ESC are sent as
+*       CMD_LINE_FRAME_ESC followed by the byte XORed with CMD_LINE_FRAME_XOR, so a '\r' never belongs to a
+*       frame: it ends the frame as an overflow, like a frame longer than CMD_LINE_MAX_LEN, and the assembler is
+*       back to lines. A stray 0x00, e.g. typed with Ctrl+@, only costs the line being typed.
+*       There are two line buffers: the interrupt fills one while the other keeps the last complete line until
+*       the command task takes it.
+*/
+
+#ifndef CMD_LINE_H
+#define CMD_LINE_H
+
+#include <stdint.h>
+
+/** @brief Maximum number of characters of a line or a binary frame, longer ones are discarded */
+#ifndef CMD_LINE_MAX_LEN
+#define CMD_LINE_MAX_LEN    31
+#endif
+
+/** @brief Escape byte of the binary frames */
+#define CMD_LINE_FRAME_ESC  0x1B
+/** @brief Value XORed with the byte following CMD_LINE_FRAME_ESC */
+#define CMD_LINE_FRAME_XOR  0x20
+
+/**
+ * @brief Structure with the counters of the line assembler
+ */
+typedef struct{
+    uint32_t lines;         /**< Complete lines handed to the command task */
+    uint32_t frames;        /**< Complete binary frames handed to the command task */
+    uint32_t overflows;     /**< Lines or frames discarded for being longer than CMD_LINE_MAX_LEN */
+    uint32_t dropped;       /**< Lines discarded because the previous one was not taken yet */
+}cmd_line_stats_t;
+
+/***********************************************************************************************************/
+/*                                       APIs Supported                                                    */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for adding a received character to the current line, to be called from the reception
+ *        interrupt.
+ * @param[in] byte is the received character.
+ * @return 1 if a complete line is ready to be taken, 0 if not.
+ */
+uint8_t cmd_line_rx_byte(uint8_t byte);
+
+/**
+ * @brief Function for taking the last complete line, which frees its buffer for the interrupt.
+ * @param[out] line is a pointer to a buffer of CMD_LINE_MAX_LEN + 1 bytes where the null terminated line is
+ *             copied, NULL for discarding the line.
+ * @param[out] len is a pointer where the length of the line is stored.
+ * @param[out] frame is a pointer where 1 is stored if the line is a binary frame, without the delimiters.
+ * @return 0 if a line was taken, 1 if there is no complete line.
+ */
+uint8_t cmd_line_take(uint8_t* line, uint8_t* len, uint8_t* frame);
+
+/**
+ * @brief Function for getting a copy of the counters of the line assembler.
+ * @param[out] stats is a pointer where the counters are copied.
+ * @return None
+ */
+void cmd_line_get_stats(cmd_line_stats_t* stats);
+
+#endif /* CMD_LINE_H */
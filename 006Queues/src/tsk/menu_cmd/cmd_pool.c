@@ -0,0 +1,65 @@
+/********************************************************************************************************//**
+* @file cmd_pool.c
+*
+* @brief File containing the APIs for a lock-free pool of command objects, which are handed from the command
+* task to the task processing them by pointer.
+*
+* Public Functions:
+*       - command_s* cmd_pool_alloc(void)
+*       - void       cmd_pool_free(command_s* cmd)
+*
+* @note
+*       For further information about functions refer to the corresponding header file.
+*/
+
+#include "cmd_pool.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+
+_Static_assert((CMD_POOL_SIZE > 0) && (CMD_POOL_SIZE < 32), "The free map of the command pool has 32 bits");
+
+/** @brief Bit set in the free map for every command of the pool */
+#define CMD_POOL_ALL        ((1U << CMD_POOL_SIZE) - 1U)
+
+/** @brief Command objects */
+static command_s cmd_pool[CMD_POOL_SIZE];
+/** @brief Bit n set when cmd_pool[n] is free, updated with LDREX/STREX so no critical section is needed */
+static uint32_t cmd_pool_free_map = CMD_POOL_ALL;
+
+/***********************************************************************************************************/
+/*                                       Public API Definitions                                            */
+/***********************************************************************************************************/
+
+command_s* cmd_pool_alloc(void){
+
+    uint32_t map = __atomic_load_n(&cmd_pool_free_map, __ATOMIC_RELAXED);
+    uint8_t index;
+
+    do{
+        if(map == 0){
+            return NULL;
+        }
+        index = __builtin_ctz(map);
+    /* On failure map is reloaded with the current value and the lowest free command is taken again */
+    }while(!__atomic_compare_exchange_n(&cmd_pool_free_map, &map, map & ~(1U << index), 1,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    return &cmd_pool[index];
+}
+
+void cmd_pool_free(command_s* cmd){
+
+    uint32_t index;
+
+    if(cmd == NULL){
+        return;
+    }
+
+    index = cmd - cmd_pool;
+    configASSERT(index < CMD_POOL_SIZE);
+    /* Freeing a command twice means two tasks thought they owned it */
+    configASSERT((__atomic_load_n(&cmd_pool_free_map, __ATOMIC_RELAXED) & (1U << index)) == 0);
+
+    (void)__atomic_fetch_or(&cmd_pool_free_map, 1U << index, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,43 @@
+/********************************************************************************************************//**
+* @file cmd_pool.h
+*
+* @brief Header file containing the prototypes of the APIs for a lock-free pool of command objects, which are
+* handed from the command task to the task processing them by pointer.
+*
+* Public Functions:
+*       - command_s* cmd_pool_alloc(void)
+*       - void       cmd_pool_free(command_s* cmd)
+*
+* @note
+*       The task allocating a command owns it until it is sent to another task, which becomes the owner and
+*       must return it with cmd_pool_free() when it is processed. The functions can be called from any task or
+*       interrupt.
+*/
+
+#ifndef CMD_POOL_H
+#define CMD_POOL_H
+
+#include <stdint.h>
+#include "menu_cmd_task.h"
+
+/** @brief Number of command objects, up to 31 */
+#define CMD_POOL_SIZE       4
+
+/***********************************************************************************************************/
+/*                                       APIs Supported                                                    */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for taking a command object from the pool.
+ * @return pointer to the command, NULL if all of them are in use.
+ */
+command_s* cmd_pool_alloc(void);
+
+/**
+ * @brief Function for returning a command object to the pool.
+ * @param[in] cmd is a pointer to the command, NULL is ignored.
+ * @return None
+ */
+void cmd_pool_free(command_s* cmd);
+
+#endif /* CMD_POOL_H */
@@ -0,0 +1,279 @@
+/********************************************************************************************************//**
+* @file cmd_proto.c
+*
+* @brief File containing the APIs for the binary command protocol, which shares the USART with the text menu
+* for automated clients.
+*
+* Public Functions:
+*       - void cmd_proto_process(const uint8_t* frame, uint8_t len)
+*       - void cmd_proto_get_stats(cmd_proto_stats_t* stats)
+*       - void cmd_proto_send(const uint8_t* data, uint16_t len)
+*
+* @note
+*       For further information about functions refer to the corresponding header file.
+*/
+
+#include "cmd_proto.h"
+#include "cmd_line.h"
+#include "LEDs_task.h"
+#include "RTC_task.h"
+#include "crc_driver.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+#include <string.h>
+
+/** @brief Bytes of a message around the payload: type, sequence number and CRC */
+#define CMD_PROTO_OVERHEAD      6
+/** @brief Maximum length of a decoded message, COBS adds at least one byte to the frame */
+#define CMD_PROTO_MAX_MSG       (CMD_LINE_MAX_LEN - 1)
+/** @brief Maximum length of a response, a ping echoes the longest payload plus the status byte */
+#define CMD_PROTO_MAX_RESP      (CMD_PROTO_MAX_MSG + 1)
+/** @brief Length of the RTC_GET response data */
+#define CMD_PROTO_RTC_LEN       8
+
+_Static_assert(CMD_PROTO_MAX_MSG >= (CMD_PROTO_OVERHEAD + 1 + CMD_PROTO_RTC_LEN),
+               "CMD_LINE_MAX_LEN too short for the binary protocol");
+_Static_assert(CMD_PROTO_MAX_RESP < 254, "Responses are encoded in a single COBS block");
+
+/** @brief Counters of the binary protocol, only written by the command task */
+static cmd_proto_stats_t proto_stats = {0};
+
+/***********************************************************************************************************/
+/*                                       Static Function Prototypes                                        */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for executing a request and sending its response.
+ * @param[in] type is the type of the request.
+ * @param[in] seq is the sequence number of the request.
+ * @param[in] data is a pointer to the payload.
+ * @param[in] len is the length of the payload.
+ * @return None
+ */
+static void proto_execute(uint8_t type, uint8_t seq, const uint8_t* data, uint8_t len);
+
+/**
+ * @brief Function for adding the CRC to a message, encoding it and sending it.
+ * @param[in] msg is a pointer to the message, with room for the CRC after len bytes.
+ * @param[in] len is the length of the message without CRC.
+ * @return None
+ */
+static void proto_send(uint8_t* msg, uint8_t len);
+
+/**
+ * @brief Function for decoding a COBS frame.
+ * @param[in] src is a pointer to the encoded frame, without delimiters.
+ * @param[in] len is the length of the encoded frame.
+ * @param[out] dst is a pointer to a buffer of len bytes for the decoded message.
+ * @param[out] dst_len is a pointer where the length of the decoded message is stored.
+ * @return 0 if the frame was decoded, 1 if the encoding is not valid.
+ */
+static uint8_t cobs_decode(const uint8_t* src, uint8_t len, uint8_t* dst, uint8_t* dst_len);
+
+/**
+ * @brief Function for encoding a message with COBS, without delimiters.
+ * @param[in] src is a pointer to the message, shorter than 254 bytes.
+ * @param[in] len is the length of the message.
+ * @param[out] dst is a pointer to a buffer of len + 1 bytes for the encoded frame.
+ * @return Length of the encoded frame.
+ */
+static uint8_t cobs_encode(const uint8_t* src, uint8_t len, uint8_t* dst);
+
+/***********************************************************************************************************/
+/*                                       Public API Definitions                                            */
+/***********************************************************************************************************/
+
+void cmd_proto_process(const uint8_t* frame, uint8_t len){
+
+    uint8_t msg[CMD_LINE_MAX_LEN];
+    uint8_t msg_len;
+    uint32_t crc;
+
+    if(cobs_decode(frame, len, msg, &msg_len) || (msg_len < CMD_PROTO_OVERHEAD)){
+        proto_stats.cobs_errors++;
+        return;
+    }
+
+    msg_len -= 4;
+    crc = (uint32_t)msg[msg_len] | ((uint32_t)msg[msg_len + 1] << 8) |
+          ((uint32_t)msg[msg_len + 2] << 16) | ((uint32_t)msg[msg_len + 3] << 24);
+    if(crc != CRC_Bytes(CRC_INIT_VALUE, msg, msg_len)){
+        proto_stats.crc_errors++;
+        return;
+    }
+
+    proto_stats.frames++;
+    proto_execute(msg[0], msg[1], &msg[2], msg_len - 2);
+}
+
+void cmd_proto_get_stats(cmd_proto_stats_t* stats){
+
+    taskENTER_CRITICAL();
+    *stats = proto_stats;
+    taskEXIT_CRITICAL();
+}
+
+__attribute__((weak)) void cmd_proto_send(const uint8_t* data, uint16_t len){
+
+    /* This is a weak implementation. The application may override this function */
+}
+
+/***********************************************************************************************************/
+/*                                       Static Function Definitions                                       */
+/***********************************************************************************************************/
+
+static void proto_execute(uint8_t type, uint8_t seq, const uint8_t* data, uint8_t len){
+
+    uint8_t resp[CMD_PROTO_MAX_RESP + 4];
+    uint8_t resp_len = 3;
+    uint8_t status = CMD_PROTO_OK;
+    RTC_Time_t time = {0};
+    RTC_Date_t date = {0};
+
+    switch(type){
+        case CMD_PROTO_PING:
+            memcpy(&resp[3], data, len);
+            resp_len += len;
+            break;
+        case CMD_PROTO_LED_SET:
+            if((len != 1) || led_set_effect(data[0])){
+                status = CMD_PROTO_ERR_ARG;
+            }
+            break;
+        case CMD_PROTO_RTC_GET:
+            if(len != 0){
+                status = CMD_PROTO_ERR_ARG;
+            }
+            else if(rtc_get_time_date(&time, &date)){
+                status = CMD_PROTO_ERR_EXEC;
+            }
+            else{
+                resp[3] = (time.HourTens * 10) + time.HourUnits;
+                resp[4] = (time.MinuteTens * 10) + time.MinuteUnits;
+                resp[5] = (time.SecondTens * 10) + time.SecondUnits;
+                resp[6] = time.PM;
+                resp[7] = (date.DateTens * 10) + date.DateUnits;
+                resp[8] = (date.MonthTens * 10) + date.MonthUnits;
+                resp[9] = (date.YearTens * 10) + date.YearUnits;
+                resp[10] = date.WeekDayUnits;
+                resp_len += CMD_PROTO_RTC_LEN;
+            }
+            break;
+        case CMD_PROTO_RTC_SET_TIME:
+            if((len != 4) || (data[0] > 99) || (data[1] > 99) || (data[2] > 99) || (data[3] > 1)){
+                status = CMD_PROTO_ERR_ARG;
+                break;
+            }
+            time.HourTens = data[0] / 10;
+            time.HourUnits = data[0] % 10;
+            time.MinuteTens = data[1] / 10;
+            time.MinuteUnits = data[1] % 10;
+            time.SecondTens = data[2] / 10;
+            time.SecondUnits = data[2] % 10;
+            time.PM = data[3];
+            if(rtc_set_time(&time)){
+                status = CMD_PROTO_ERR_ARG;
+            }
+            break;
+        case CMD_PROTO_RTC_SET_DATE:
+            if((len != 4) || (data[0] > 99) || (data[1] > 99) || (data[2] > 99)){
+                status = CMD_PROTO_ERR_ARG;
+                break;
+            }
+            date.DateTens = data[0] / 10;
+            date.DateUnits = data[0] % 10;
+            date.MonthTens = data[1] / 10;
+            date.MonthUnits = data[1] % 10;
+            date.YearTens = data[2] / 10;
+            date.YearUnits = data[2] % 10;
+            date.WeekDayUnits = data[3];
+            if(rtc_set_date(&date)){
+                status = CMD_PROTO_ERR_ARG;
+            }
+            break;
+        case CMD_PROTO_RTC_REPORT:
+            if((len != 1) || (data[0] > 1)){
+                status = CMD_PROTO_ERR_ARG;
+                break;
+            }
+            rtc_set_report(data[0]);
+            break;
+        default:
+            status = CMD_PROTO_ERR_TYPE;
+            break;
+    }
+
+    resp[0] = type | CMD_PROTO_RESPONSE;
+    resp[1] = seq;
+    resp[2] = status;
+    proto_send(resp, resp_len);
+}
+
+static void proto_send(uint8_t* msg, uint8_t len){
+
+    /* Leading and trailing delimiters, so any text printed before is dropped by the client as a bad frame */
+    static uint8_t tx[CMD_PROTO_MAX_RESP + 4 + 3];
+    uint32_t crc = CRC_Bytes(CRC_INIT_VALUE, msg, len);
+    uint8_t tx_len;
+
+    msg[len++] = (uint8_t)crc;
+    msg[len++] = (uint8_t)(crc >> 8);
+    msg[len++] = (uint8_t)(crc >> 16);
+    msg[len++] = (uint8_t)(crc >> 24);
+
+    tx[0] = 0x00;
+    tx_len = 1 + cobs_encode(msg, len, &tx[1]);
+    tx[tx_len++] = 0x00;
+
+    cmd_proto_send(tx, tx_len);
+}
+
+static uint8_t cobs_decode(const uint8_t* src, uint8_t len, uint8_t* dst, uint8_t* dst_len){
+
+    uint8_t i = 0;
+    uint8_t out = 0;
+    uint8_t code;
+
+    while(i < len){
+        code = src[i++];
+        if((code == 0) || ((i + code - 1) > len)){
+            return 1;
+        }
+        for(uint8_t k = 1; k < code; k++){
+            if(src[i] == 0){
+                return 1;
+            }
+            dst[out++] = src[i++];
+        }
+        /* Every block but the last one and the 254 bytes long ones stands for a zero */
+        if((code != 0xFF) && (i < len)){
+            dst[out++] = 0;
+        }
+    }
+    *dst_len = out;
+
+    return 0;
+}
+
+static uint8_t cobs_encode(const uint8_t* src, uint8_t len, uint8_t* dst){
+
+    uint8_t code_index = 0;
+    uint8_t out = 1;
+    uint8_t code = 1;
+
+    for(uint8_t i = 0; i < len; i++){
+        if(src[i] == 0){
+            dst[code_index] = code;
+            code_index = out++;
+            code = 1;
+        }
+        else{
+            dst[out++] = src[i];
+            code++;
+        }
+    }
+    dst[code_index] = code;
+
+    return out;
+}
@@ -0,0 +1,87 @@
+/********************************************************************************************************//**
+* @file cmd_proto.h
+*
+* @brief Header file containing the prototypes of the APIs for the binary command protocol, which shares the
+* USART with the text menu for automated clients.
+*
+* Public Functions:
+*       - void cmd_proto_process(const uint8_t* frame, uint8_t len)
+*       - void cmd_proto_get_stats(cmd_proto_stats_t* stats)
+*       - void cmd_proto_send(const uint8_t* data, uint16_t len)
+*
+* @note
+*       A frame is sent as 0x00, the COBS encoded message and 0x00, requests escaping 0x0D as described in
+*       cmd_line.h. The message is the type, the sequence number, the payload and the CRC-32/MPEG-2 (polynomial
+*       0x04C11DB7, initial value 0xFFFFFFFF, no reflection nor final xor) of the previous bytes, little-endian.
+*       Every valid request is answered with the type ORed with CMD_PROTO_RESPONSE, the same sequence number, a
+*       status byte and the response data. Frames with a wrong encoding or CRC are dropped without answer.
+*/
+
+#ifndef CMD_PROTO_H
+#define CMD_PROTO_H
+
+#include <stdint.h>
+
+/** @brief Bit set in the type of the responses */
+#define CMD_PROTO_RESPONSE      0x80
+
+/**
+ * @brief Enum with the message types of the requests
+ */
+typedef enum{
+    CMD_PROTO_PING = 0x01,          /**< Payload is echoed back */
+    CMD_PROTO_LED_SET = 0x10,       /**< Payload: effect, 0 for none or 1 to 4 */
+    CMD_PROTO_RTC_GET = 0x20,       /**< Response: hour, minute, second, pm, day, month, year, week day */
+    CMD_PROTO_RTC_SET_TIME = 0x21,  /**< Payload: hour (1 to 12), minute, second, pm */
+    CMD_PROTO_RTC_SET_DATE = 0x22,  /**< Payload: day, month, year (0 to 99), week day (1 to 7, sunday 1) */
+    CMD_PROTO_RTC_REPORT = 0x23     /**< Payload: 1 for enabling the RTC report, 0 for disabling it */
+}cmd_proto_type_t;
+
+/**
+ * @brief Enum with the status byte of the responses
+ */
+typedef enum{
+    CMD_PROTO_OK = 0,               /**< Request executed */
+    CMD_PROTO_ERR_ARG,              /**< Payload not valid for the type */
+    CMD_PROTO_ERR_TYPE,             /**< Unknown type */
+    CMD_PROTO_ERR_EXEC              /**< Request valid but failed */
+}cmd_proto_status_t;
+
+/**
+ * @brief Structure with the counters of the binary protocol
+ */
+typedef struct{
+    uint32_t frames;        /**< Valid frames executed */
+    uint32_t cobs_errors;   /**< Frames dropped for a wrong encoding or length */
+    uint32_t crc_errors;    /**< Frames dropped for a wrong CRC */
+}cmd_proto_stats_t;
+
+/***********************************************************************************************************/
+/*                                       APIs Supported                                                    */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for decoding and executing a received frame, the response is sent with cmd_proto_send().
+ * @param[in] frame is a pointer to the COBS encoded frame, without the delimiters.
+ * @param[in] len is the length of the encoded frame.
+ * @return None
+ */
+void cmd_proto_process(const uint8_t* frame, uint8_t len);
+
+/**
+ * @brief Function for getting a copy of the counters of the binary protocol.
+ * @param[out] stats is a pointer where the counters are copied.
+ * @return None
+ */
+void cmd_proto_get_stats(cmd_proto_stats_t* stats);
+
+/**
+ * @brief Weak function for sending an encoded response, including the delimiters. It must be implemented by
+ *        the application, which owns the USART.
+ * @param[in] data is a pointer to the bytes to be sent.
+ * @param[in] len is the number of bytes.
+ * @return None
+ */
+void cmd_proto_send(const uint8_t* data, uint16_t len);
+
+#endif /* CMD_PROTO_H */
@@ -12,10 +12,24 @@
 */
 
 #include "menu_cmd_task.h"
+#include "cmd_pool.h"
+#include "cmd_dispatch.h"
+#include "cmd_line.h"
+#include "cmd_proto.h"
+#include "LEDs_task.h"
+#include "RTC_task.h"
+#include "rt_stats.h"
+#include "stack_mon_task.h"
+#include "queue_stats.h"
 #include "FreeRTOS.h"
 #include "queue.h"
 #include <stdint.h>
 
+/** @brief Number of slots of the table of direct commands */
+#define TOP_CMD_SIZE    8
+/** @brief Seed of the hash of the table of direct commands */
+#define TOP_CMD_SEED    1
+
 /** @brief Variable for handling the menu_task_handler task */
 extern TaskHandle_t menu_task_handle;
 /** @brief Variable for handling the LED_task_handler task */
@@ -24,30 +38,46 @@ extern TaskHandle_t LED_task_handle;
 extern TaskHandle_t rtc_task_handle;
 /** @brief Variable for handling the queue used for printing */
 extern QueueHandle_t q_print;
-/** @brief Variable for handling the queue used for managing the information received by UART */
-extern QueueHandle_t q_data;
 /** @brief Variable for storing and managing the possible states of the application */
 state_t curr_state = sMainMenu;
 /** @brief Variable for storing the invalid option message */
 extern const char* msg_invalid;
 
+/** @brief Direct commands, accepted in any state without going through the menus */
+static const cmd_entry_t top_cmd_entries[TOP_CMD_SIZE] = {
+    CMD_ENTRY(TOP_CMD_SIZE, TOP_CMD_SEED, "led", 'l', 'd', led_cmd_handler),
+    CMD_ENTRY(TOP_CMD_SIZE, TOP_CMD_SEED, "rtc", 'r', 'c', rtc_cmd_handler),
+};
+
+/** @brief Table of direct commands */
+static const cmd_table_t top_cmd_table = {top_cmd_entries, TOP_CMD_SIZE, TOP_CMD_SEED};
+
 /***********************************************************************************************************/
 /*                                       Static Function Prototypes                                        */
 /***********************************************************************************************************/
 
 /**
- * @brief Function for notifying the regarding task depending on the received command
- * @param[out] cmd is a pointer to the received command
+ * @brief Function for taking a command from the pool, filling it with the received line and sending it to the
+ *        regarding task depending on the current state. The receiving task owns the command then.
  * @return None
  */
-static void process_command(command_s* cmd);
+static void process_command(void);
 
 /**
- * @brief Function for extracting the command value from the data queue. The command is finished by a '\0'
- * @param[out] cmd is a pointer to the extracted command
+ * @brief Function for extracting the command value from the line assembled by the reception interrupt. The
+ * command is finished by a '\0'.
+ * @param[out] cmd is a pointer to the extracted command, NULL for discarding the line
+ * @param[out] frame is a pointer where 1 is stored if the command is a binary frame
+ * @return 0 if a command was extracted, 1 if there is no complete line.
+ */
+static uint8_t extract_command(command_s* cmd, uint8_t* frame);
+
+/**
+ * @brief Function for running a direct command, like "led e1" or "rtc report y".
+ * @param[in] cmd is a pointer to the command, its payload is split in words.
  * @return None
  */
-static uint8_t extract_command(command_s* cmd);
+static void run_direct_command(command_s* cmd);
 
 /***********************************************************************************************************/
 /*                                       Public API Definitions                                            */
@@ -58,24 +88,39 @@ void menu_task_handler(void* parameters){
     uint32_t cmd_addr;
     command_s* cmd;
     uint8_t option;
+    uint8_t len;
+    static char stats[RT_STATS_REPORT_LEN];
+    static char* msg_stats = stats;
+    static char stacks[STACK_MON_REPORT_LEN];
+    static char* msg_stacks = stacks;
+    static char queues[QUEUE_STATS_REPORT_LEN];
+    static char* msg_queues = queues;
     const char* msg_menu = "\n========================\n"
                          "|         Menu         |\n"
                          "========================\n"
                          "LED effect    ----> 0\n"
                          "Date and time ----> 1\n"
-                         "Exit          ----> 2\n"
+                         "Task stats    ----> 2\n"
+                         "Stack report  ----> 3\n"
+                         "Queue stats   ----> 4\n"
+                         "Exit          ----> 5\n"
                          "Enter your choice here : ";
 
     for(;;){
         SEGGER_SYSVIEW_PrintfTarget("Menu Task");
         /* Print menu */
         xQueueSend(q_print, &msg_menu, portMAX_DELAY);
-        /* Wait for commands */
-        xTaskNotifyWait(0, 0, &cmd_addr, portMAX_DELAY);
-        cmd = (command_s*)cmd_addr;
+        /* Wait for commands, the value is cleared so a wake up without command reads NULL */
+        do{
+            xTaskNotifyWait(0, 0xFFFFFFFF, &cmd_addr, portMAX_DELAY);
+            cmd = (command_s*)cmd_addr;
+        }while(cmd == NULL);
+        /* The command is returned to the pool as soon as it is read */
+        len = cmd->len;
+        option = cmd->payload[0] - 48;
+        cmd_pool_free(cmd);
 
-        if(cmd->len == 1){
-            option = cmd->payload[0] - 48;
+        if(len == 1){
             switch(option){
                 case 0:
                     curr_state = sLedEffect;
@@ -86,6 +131,19 @@ void menu_task_handler(void* parameters){
                     xTaskNotify(rtc_task_handle, 0, eNoAction);
                     break;
                 case 2:
+                    /* The menu is printed after the report, so the previous report was sent before a new option arrives */
+                    rt_stats_report(stats, sizeof(stats));
+                    xQueueSend(q_print, &msg_stats, portMAX_DELAY);
+                    continue;
+                case 3:
+                    stack_mon_report(stacks, sizeof(stacks));
+                    xQueueSend(q_print, &msg_stacks, portMAX_DELAY);
+                    continue;
+                case 4:
+                    queue_stats_report(queues, sizeof(queues));
+                    xQueueSend(q_print, &msg_queues, portMAX_DELAY);
+                    continue;
+                case 5:
                     break;
                 default:
                     xQueueSend(q_print, &msg_invalid, portMAX_DELAY);
@@ -103,13 +161,17 @@ void menu_task_handler(void* parameters){
 void cmd_task_handler(void* parameters){
 
     BaseType_t ret;
-    command_s cmd;
+
+    /* A collision in a perfect hash table is caught at compile time, a wrong first/last character here */
+    configASSERT(!cmd_table_check(&top_cmd_table));
+    configASSERT(!cmd_table_check(&led_cmd_table));
+    configASSERT(!cmd_table_check(&rtc_cmd_table));
 
     for(;;){
         SEGGER_SYSVIEW_PrintfTarget("Command Task");
         ret = xTaskNotifyWait(0, 0, NULL, portMAX_DELAY);
         if(ret == pdTRUE){
-            process_command(&cmd);
+            process_command();
         }
     }
 }
@@ -118,46 +180,80 @@ void cmd_task_handler(void* parameters){
 /*                                       Static Function Definitions                                       */
 /***********************************************************************************************************/
 
-static void process_command(command_s* cmd){
+static void process_command(void){
+
+    command_s* cmd = cmd_pool_alloc();
+    TaskHandle_t dest;
+    uint8_t frame;
+    uint8_t i;
 
-    extract_command(cmd);
+    /* The line is always taken out of the line buffer, it is lost if every command is still in use */
+    if(extract_command(cmd, &frame) || (cmd == NULL)){
+        cmd_pool_free(cmd);
+        return;
+    }
+
+    /* Binary frames are answered here and never change the menu state */
+    if(frame){
+        cmd_proto_process(cmd->payload, cmd->len);
+        cmd_pool_free(cmd);
+        return;
+    }
+
+    /* A line starting with a known verb is run here whatever the menu state is */
+    for(i = 0; (i < cmd->len) && (cmd->payload[i] != ' '); i++);
+    if(cmd_find(&top_cmd_table, (const char*)cmd->payload, i) != NULL){
+        run_direct_command(cmd);
+        cmd_pool_free(cmd);
+        return;
+    }
 
     switch(curr_state){
         case sMainMenu:
-            xTaskNotify(menu_task_handle, (uint32_t)cmd, eSetValueWithOverwrite);
+            dest = menu_task_handle;
             break;
         case sLedEffect:
-            xTaskNotify(LED_task_handle, (uint32_t)cmd, eSetValueWithOverwrite);
+            dest = LED_task_handle;
             break;
         case sRtcMenu:
         case sRtcTimeConfig:
         case sRtcDateConfig:
         case sRtcReport:
-            xTaskNotify(rtc_task_handle, (uint32_t)cmd, eSetValueWithOverwrite);
+            dest = rtc_task_handle;
             break;
         default:
+            dest = NULL;
             break;
     }
-}
 
-static uint8_t extract_command(command_s* cmd){
+    /* The previous command is not overwritten while its owner has not taken it, the new one is dropped */
+    if((dest == NULL) || (xTaskNotify(dest, (uint32_t)cmd, eSetValueWithoutOverwrite) != pdPASS)){
+        cmd_pool_free(cmd);
+    }
+}
 
-    uint8_t item;
-    BaseType_t status;
-    uint8_t i = 0;
+static uint8_t extract_command(command_s* cmd, uint8_t* frame){
 
-    status = uxQueueMessagesWaiting(q_data);
-    if(!status){return 1;}
+    uint8_t len;
 
-    do{
-        status = xQueueReceive(q_data, &item, 0);
-        if(status == pdTRUE){
-            cmd->payload[i++] = item;
-        }
-    }while(item != '\r');
+    if(cmd_line_take((cmd != NULL) ? cmd->payload : NULL, &len, frame)){
+        return 1;
+    }
 
-    cmd->payload[i-1] = '\0';
-    cmd->len = i-1;
+    if(cmd != NULL){
+        cmd->len = len;
+    }
 
     return 0;
 }
+
+static void run_direct_command(command_s* cmd){
+
+    char* argv[CMD_MAX_ARGS];
+    uint8_t argc;
+
+    argc = cmd_split((char*)cmd->payload, argv, CMD_MAX_ARGS);
+    if(cmd_dispatch(&top_cmd_table, argc, argv)){
+        xQueueSend(q_print, &msg_invalid, portMAX_DELAY);
+    }
+}
@@ -13,6 +13,10 @@
 #define MENU_CMD_H
 
 #include <stdint.h>
+#include "cmd_line.h"
+
+/** @brief Maximum length of a command including the terminating '\0' */
+#define CMD_MAX_LEN     (CMD_LINE_MAX_LEN + 1)
 
 /**
  * @brief Enum with the different states of the application
@@ -30,8 +34,8 @@ typedef enum{
  * @brief Structure for managing the received command
  */
 typedef struct{
-    uint8_t payload[10];    /**< Received command */
-    uint8_t len;            /**< Command lenght */
+    uint8_t payload[CMD_MAX_LEN];   /**< Received command */
+    uint8_t len;                    /**< Command lenght */
 }command_s;
 
 /***********************************************************************************************************/
@@ -0,0 +1,237 @@
+/********************************************************************************************************//**
+* @file stack_mon_task.c
+*
+* @brief File containing the APIs for managing the task that watches the stack usage of the other tasks and
+* recommends their stack sizes.
+*
+* Public Functions:
+*       - uint8_t  stack_mon_register(TaskHandle_t task, uint32_t depth)
+*       - void     stack_mon_unregister(TaskHandle_t task)
+*       - void     stack_mon_task_handler(void* parameters)
+*       - uint32_t stack_mon_report(char* buf, uint32_t size)
+*       - void     stack_mon_overflow(const char* name)
+*       - uint8_t  stack_mon_last_overflow(char* name)
+*
+* @note
+*       For further information about functions refer to the corresponding header file.
+*/
+
+#include "stack_mon_task.h"
+#include "stm32f446xx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "timers.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/** @brief Value marking a valid overflow record */
+#define STACK_MON_OVF_MAGIC     0x53544B4FU
+/** @brief AIRCR value requesting a system reset, with the write key */
+#define STACK_MON_SYSRESETREQ   ((0x5FAU << 16) | (1U << 2))
+
+/**
+ * @brief Structure with the stack figures of a watched task.
+ */
+typedef struct{
+    TaskHandle_t task;      /**< Handle of the task */
+    const char* name;       /**< Name of the task, kept for the report after the task is deleted */
+    uint32_t depth;         /**< Stack depth in words */
+    uint32_t min_free;      /**< Last high-water mark in words */
+    uint8_t active;         /**< 1 while the task is sampled */
+    uint8_t warned;         /**< 1 once the low stack warning was printed */
+}stack_mon_entry_t;
+
+/**
+ * @brief Structure with the task which overflowed its stack, kept across the reset.
+ */
+typedef struct{
+    uint32_t magic;                         /**< STACK_MON_OVF_MAGIC if the record is valid */
+    char name[configMAX_TASK_NAME_LEN];     /**< Name of the task */
+}stack_mon_ovf_t;
+
+/** @brief Variable for handling the queue used for printing */
+extern QueueHandle_t q_print;
+
+/** @brief Watched tasks */
+static stack_mon_entry_t stack_mon_entries[STACK_MON_MAX_TASKS];
+/** @brief Number of valid entries of stack_mon_entries */
+static uint8_t stack_mon_num = 0;
+/** @brief Overflow record, not initialized at boot so it survives the reset requested by the hook */
+static stack_mon_ovf_t stack_mon_ovf __attribute__((section(".noinit")));
+
+/***********************************************************************************************************/
+/*                                       Static Function Prototypes                                        */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for updating the high-water mark of a task and printing a warning if it is too low.
+ * @param[in] entry is a pointer to the entry of the task.
+ * @return None
+ */
+static void stack_mon_sample(stack_mon_entry_t* entry);
+
+/**
+ * @brief Function for getting the recommended stack depth of a task.
+ * @param[in] entry is a pointer to the entry of the task.
+ * @return recommended depth in words.
+ */
+static uint32_t stack_mon_recommended(const stack_mon_entry_t* entry);
+
+/***********************************************************************************************************/
+/*                                       Public API Definitions                                            */
+/***********************************************************************************************************/
+
+uint8_t stack_mon_register(TaskHandle_t task, uint32_t depth){
+
+    stack_mon_entry_t* entry;
+    uint8_t index;
+
+    taskENTER_CRITICAL();
+    if(stack_mon_num >= STACK_MON_MAX_TASKS){
+        taskEXIT_CRITICAL();
+        return 1;
+    }
+    index = stack_mon_num++;
+    taskEXIT_CRITICAL();
+
+    entry = &stack_mon_entries[index];
+    entry->task = task;
+    entry->name = pcTaskGetName(task);
+    entry->depth = depth;
+    entry->min_free = depth;
+    entry->warned = 0;
+    /* The entry is only sampled once it is filled */
+    __atomic_store_n(&entry->active, 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+void stack_mon_unregister(TaskHandle_t task){
+
+    if(task == NULL){
+        task = xTaskGetCurrentTaskHandle();
+    }
+
+    for(uint8_t i = 0; i < stack_mon_num; i++){
+        if(__atomic_load_n(&stack_mon_entries[i].active, __ATOMIC_ACQUIRE) && (stack_mon_entries[i].task == task)){
+            stack_mon_sample(&stack_mon_entries[i]);
+            __atomic_store_n(&stack_mon_entries[i].active, 0, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+void stack_mon_task_handler(void* parameters){
+
+    TickType_t last_wake;
+
+    /* Both kernel tasks exist once the scheduler is running */
+    (void)stack_mon_register(xTaskGetIdleTaskHandle(), configMINIMAL_STACK_SIZE);
+    (void)stack_mon_register(xTimerGetTimerDaemonTaskHandle(), configTIMER_TASK_STACK_DEPTH);
+
+    last_wake = xTaskGetTickCount();
+    for(;;){
+        SEGGER_SYSVIEW_PrintfTarget("Stack Monitor Task");
+        for(uint8_t i = 0; i < stack_mon_num; i++){
+            if(__atomic_load_n(&stack_mon_entries[i].active, __ATOMIC_ACQUIRE)){
+                stack_mon_sample(&stack_mon_entries[i]);
+            }
+        }
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(STACK_MON_PERIOD_MS));
+    }
+}
+
+uint32_t stack_mon_report(char* buf, uint32_t size){
+
+    const stack_mon_entry_t* entry;
+    uint32_t total = 0;
+    uint32_t total_rec = 0;
+    uint32_t rec;
+    uint32_t len;
+
+    len = snprintf(buf, size, "\nTask        Size  Used  Free   Rec\n");
+    for(uint8_t i = 0; (i < stack_mon_num) && (len < size); i++){
+        entry = &stack_mon_entries[i];
+        rec = stack_mon_recommended(entry);
+        total += entry->depth;
+        total_rec += rec;
+        len += snprintf(&buf[len], size - len, "%-10s %5lu %5lu %5lu %5lu%s\n", entry->name,
+                        (unsigned long)entry->depth, (unsigned long)(entry->depth - entry->min_free),
+                        (unsigned long)entry->min_free, (unsigned long)rec, entry->active ? "" : " (deleted)");
+    }
+    if(len < size){
+        len += snprintf(&buf[len], size - len, "Total %lu words, recommended %lu words\n",
+                        (unsigned long)total, (unsigned long)total_rec);
+    }
+
+    return (len < size) ? len : (size - 1);
+}
+
+void stack_mon_overflow(const char* name){
+
+    uint8_t i;
+
+    taskDISABLE_INTERRUPTS();
+
+    for(i = 0; (i < (configMAX_TASK_NAME_LEN - 1)) && (name[i] != '\0'); i++){
+        stack_mon_ovf.name[i] = name[i];
+    }
+    stack_mon_ovf.name[i] = '\0';
+    stack_mon_ovf.magic = STACK_MON_OVF_MAGIC;
+
+    /* The stacks of the other tasks may be corrupted too, a reset is the only safe way out */
+    __asm volatile("dsb" ::: "memory");
+    SCB->AIRCR = STACK_MON_SYSRESETREQ;
+    __asm volatile("dsb" ::: "memory");
+    for(;;);
+}
+
+uint8_t stack_mon_last_overflow(char* name){
+
+    uint8_t i;
+
+    /* After a power on the record holds random data, the magic value tells it apart */
+    if(stack_mon_ovf.magic != STACK_MON_OVF_MAGIC){
+        return 0;
+    }
+    stack_mon_ovf.magic = 0;
+
+    for(i = 0; (i < (configMAX_TASK_NAME_LEN - 1)) && (stack_mon_ovf.name[i] != '\0'); i++){
+        name[i] = stack_mon_ovf.name[i];
+    }
+    name[i] = '\0';
+
+    return 1;
+}
+
+/***********************************************************************************************************/
+/*                                       Static Function Definitions                                       */
+/***********************************************************************************************************/
+
+static void stack_mon_sample(stack_mon_entry_t* entry){
+
+    static const char* msg_low = "////Low stack: ";
+    static const char* msg_end = "////\n";
+
+    entry->min_free = uxTaskGetStackHighWaterMark(entry->task);
+
+    if((entry->min_free < STACK_MON_WARN_WORDS) && !entry->warned){
+        entry->warned = 1;
+        /* The name lives in the task control block, so no buffer is needed for the message */
+        xQueueSend(q_print, &msg_low, 0);
+        xQueueSend(q_print, &entry->name, 0);
+        xQueueSend(q_print, &msg_end, 0);
+    }
+}
+
+static uint32_t stack_mon_recommended(const stack_mon_entry_t* entry){
+
+    uint32_t used = entry->depth - entry->min_free;
+    uint32_t margin = (used * STACK_MON_MARGIN_PCT) / 100;
+
+    if(margin < STACK_MON_MIN_MARGIN){
+        margin = STACK_MON_MIN_MARGIN;
+    }
+
+    return (used + margin + 7) & ~7U;
+}
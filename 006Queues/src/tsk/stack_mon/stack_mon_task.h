@@ -0,0 +1,92 @@
+/********************************************************************************************************//**
+* @file stack_mon_task.h
+*
+* @brief Header file containing the prototypes of the APIs for managing the task that watches the stack usage
+* of the other tasks and recommends their stack sizes.
+*
+* Public Functions:
+*       - uint8_t  stack_mon_register(TaskHandle_t task, uint32_t depth)
+*       - void     stack_mon_unregister(TaskHandle_t task)
+*       - void     stack_mon_task_handler(void* parameters)
+*       - uint32_t stack_mon_report(char* buf, uint32_t size)
+*       - void     stack_mon_overflow(const char* name)
+*       - uint8_t  stack_mon_last_overflow(char* name)
+*
+* @note
+*       The high-water mark is the minimum free stack since the task was created, found by the kernel from
+*       the fill pattern left at the bottom of the stack. The recommended size is the used stack plus
+*       STACK_MON_MARGIN_PCT percent, at least STACK_MON_MIN_MARGIN words, rounded up to 8 words.
+*/
+
+#ifndef STACK_MON_TASK_H
+#define STACK_MON_TASK_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+
+/** @brief Maximum number of tasks watched */
+#define STACK_MON_MAX_TASKS     12
+/** @brief Sampling period of the high-water marks in ms */
+#define STACK_MON_PERIOD_MS     1000
+/** @brief A warning is printed once when a task has less free stack than this, in words */
+#define STACK_MON_WARN_WORDS    32
+/** @brief Safety margin of the recommended size, in percent of the used stack */
+#define STACK_MON_MARGIN_PCT    25
+/** @brief Minimum safety margin of the recommended size in words, covers the exception frame with FPU */
+#define STACK_MON_MIN_MARGIN    40
+/** @brief Size of a buffer big enough for the report of STACK_MON_MAX_TASKS tasks */
+#define STACK_MON_REPORT_LEN    (48 * (STACK_MON_MAX_TASKS + 3))
+
+/***********************************************************************************************************/
+/*                                       APIs Supported                                                    */
+/***********************************************************************************************************/
+
+/**
+ * @brief Function for adding a task to the monitor.
+ * @param[in] task is the handle of the task.
+ * @param[in] depth is the stack depth of the task in words, as given when it was created.
+ * @return 0 if the task was added, 1 if the table is full.
+ * @note The idle and timer service tasks are added by the monitor task itself.
+ */
+uint8_t stack_mon_register(TaskHandle_t task, uint32_t depth);
+
+/**
+ * @brief Function for stopping watching a task before it is deleted, its last figures stay in the report.
+ * @param[in] task is the handle of the task, NULL for the calling task.
+ * @return None
+ */
+void stack_mon_unregister(TaskHandle_t task);
+
+/**
+ * @brief Task for sampling the high-water marks of the registered tasks every STACK_MON_PERIOD_MS and printing
+ *        a warning when a task is close to overflowing its stack.
+ * @param[in] parameters is a pointer to the input parameters to the task
+ * @return None
+ */
+void stack_mon_task_handler(void* parameters);
+
+/**
+ * @brief Function for writing a table with the size, usage and recommended size of the stack of each task.
+ * @param[out] buf is the buffer for the text, STACK_MON_REPORT_LEN bytes are enough.
+ * @param[in] size is the size of the buffer.
+ * @return length of the text, without the terminating '\0'.
+ */
+uint32_t stack_mon_report(char* buf, uint32_t size);
+
+/**
+ * @brief Function for recording the task which overflowed its stack and resetting the MCU, called from the
+ *        stack overflow hook of the kernel.
+ * @param[in] name is the name of the task.
+ * @return It does not return.
+ */
+void stack_mon_overflow(const char* name) __attribute__((noreturn));
+
+/**
+ * @brief Function for checking if the last reset was caused by a stack overflow, the record is cleared.
+ * @param[out] name is a buffer of configMAX_TASK_NAME_LEN bytes for the name of the task.
+ * @return 1 if there was a stack overflow, 0 if not.
+ */
+uint8_t stack_mon_last_overflow(char* name);
+
+#endif /* STACK_MON_TASK_H */
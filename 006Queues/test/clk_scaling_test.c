@@ -0,0 +1,417 @@
+/********************************************************************************************************//**
+* @file clk_scaling_test.c
+*
+* @brief Host test of the operating point transitions of clk_scaling.c over simulated RCC, PWR and FLASH
+* registers.
+*
+* @note
+*       clk_scaling.c and the RCC, PWR and FLASH drivers are built for the host with the register blocks moved
+*       to RAM by test/sim/stm32f446xx.h. A thread plays the hardware: it sets the ready flags the drivers poll,
+*       switches the system clock when SW changes and logs the latency changes, the over-drive switches, the
+*       clock switches and the updates of SystemCoreClock in the order the code did them. On each step it also
+*       checks the rules of the reference manual: enough wait states for HCLK, over-drive above 168 MHz, bus
+*       limits, over-drive only switched while HSI or HSE is the system clock and PLL only configured while it
+*       is off. The registers are read in the reverse order of the code, so a write seen implies the previous
+*       ones are seen too.
+*/
+
+#include "clk_scaling.h"
+#include "clk_config.h"
+#include "stm32f446xx.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/** @brief Maximum number of events logged */
+#define SIM_LOG_LEN             256
+/** @brief Maximum number of rule violations printed */
+#define SIM_MAX_PRINTS          10
+
+/** @brief Checks a condition, counting and printing the failure without stopping the test */
+#define CHECK(cond)             do{ if(!(cond)){ printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+                                    failures++; } }while(0)
+
+/**
+ * @brief Events logged by the simulated hardware.
+ */
+typedef enum{
+    EV_LATENCY,                         /**< Flash wait states changed, value is the latency */
+    EV_OVERDRIVE,                       /**< Regulator switched, value is 1 for over-drive and 0 for normal */
+    EV_SWITCH,                          /**< System clock switched, value is the new HCLK */
+    EV_CORECLOCK                        /**< SystemCoreClock written, value is the new value */
+}sim_event_type_t;
+
+/**
+ * @brief Structure with an event logged by the simulated hardware.
+ */
+typedef struct{
+    sim_event_type_t type;              /**< Type of event */
+    uint32_t value;                     /**< Value, depending on the type */
+}sim_event_t;
+
+/**
+ * @brief Structure with the expected state of an operating point.
+ */
+typedef struct{
+    uint32_t hclk;                      /**< HCLK frequency */
+    uint8_t latency;                    /**< Flash wait states */
+    uint8_t over_drive;                 /**< 1 if over-drive is on */
+}opp_expected_t;
+
+/** @brief Simulated register blocks, used by the drivers through test/sim/stm32f446xx.h */
+RCC_RegDef_t sim_rcc;
+PWR_RegDef_t sim_pwr;
+FLASHINTR_RegDef_t sim_flash;
+
+/** @brief System core clock, updated by clk_scaling.c */
+uint32_t SystemCoreClock = CLK_HSI_HZ;
+
+/** @brief Expected state of each operating point, in the same order as clk_opp_t */
+static const opp_expected_t opp_expected[CLK_OPP_NUM] = {
+    {CLK_HCLK(CLK_OPP180), CLK_OPP180_LATENCY, CLK_OPP180_OVER_DRIVE},
+    {CLK_HCLK(CLK_OPP84), CLK_OPP84_LATENCY, CLK_OPP84_OVER_DRIVE},
+    {CLK_HCLK(CLK_OPP16), CLK_OPP16_LATENCY, CLK_OPP16_OVER_DRIVE},
+};
+
+/** @brief Events logged by the simulated hardware */
+static sim_event_t sim_log[SIM_LOG_LEN];
+/** @brief Number of events logged, published with release order */
+static uint32_t sim_log_len = 0;
+/** @brief Number of steps done by the simulated hardware */
+static uint32_t sim_steps = 0;
+/** @brief Rules of the reference manual broken */
+static uint32_t sim_errors = 0;
+/** @brief Set by the test to stop the simulated hardware */
+static uint8_t sim_stop = 0;
+/** @brief Number of failed checks */
+static uint32_t failures = 0;
+
+/***********************************************************************************************************/
+/*                                       Hardware Simulation                                               */
+/***********************************************************************************************************/
+
+static void sim_event(sim_event_type_t type, uint32_t value){
+
+    uint32_t len = __atomic_load_n(&sim_log_len, __ATOMIC_RELAXED);
+
+    if(len < SIM_LOG_LEN){
+        sim_log[len].type = type;
+        sim_log[len].value = value;
+        __atomic_store_n(&sim_log_len, len + 1, __ATOMIC_RELEASE);
+    }
+}
+
+static void sim_error(const char* rule, uint32_t value){
+
+    if(sim_errors < SIM_MAX_PRINTS){
+        printf("simulated hardware: %s (%lu)\n", rule, (unsigned long)value);
+    }
+    sim_errors++;
+}
+
+/** @brief System clock selected by the status bits, from the simulated oscillators */
+static uint32_t sim_sysclk(uint8_t sws, uint32_t pllcfgr){
+
+    static const uint8_t pllp_div[4] = {2, 4, 6, 8};
+    uint32_t src;
+
+    if(sws == 0){
+        return CLK_HSI_HZ;
+    }
+    if(sws == 1){
+        return CLK_HSE_HZ;
+    }
+    src = ((pllcfgr >> RCC_PLLCFGR_PLLSRC) & 0x01) ? CLK_HSE_HZ : CLK_HSI_HZ;
+
+    return (src / ((pllcfgr >> RCC_PLLCFGR_PLLM) & 0x3F)) * ((pllcfgr >> RCC_PLLCFGR_PLLN) & 0x1FF) /
+           pllp_div[(pllcfgr >> RCC_PLLCFGR_PLLP) & 0x03];
+}
+
+static uint32_t sim_ahb_div(uint32_t cfgr){
+
+    static const uint16_t div[8] = {2, 4, 8, 16, 64, 128, 256, 512};
+    uint8_t hpre = (cfgr >> RCC_CFGR_HPRE) & 0x0F;
+
+    return (hpre < 8) ? 1 : div[hpre - 8];
+}
+
+static uint32_t sim_apb_div(uint32_t cfgr, uint8_t shift){
+
+    uint8_t ppre = (cfgr >> shift) & 0x07;
+
+    return (ppre < 4) ? 1 : (2U << (ppre - 4));
+}
+
+/** @brief Checks the rules which depend on the clock in use */
+static void sim_check_clocks(uint32_t hclk, uint32_t cfgr, uint8_t latency, uint8_t over_drive){
+
+    if(latency < CLK_MIN_LATENCY(hclk)){
+        sim_error("not enough flash wait states for HCLK", hclk);
+    }
+    if((hclk > CLK_HCLK_MAX_NO_OD_HZ) && !over_drive){
+        sim_error("HCLK above 168 MHz without over-drive", hclk);
+    }
+    if(hclk > CLK_HCLK_MAX_HZ){
+        sim_error("HCLK above 180 MHz", hclk);
+    }
+    if(hclk / sim_apb_div(cfgr, RCC_CFGR_PPRE1) > CLK_PCLK1_MAX_HZ){
+        sim_error("PCLK1 above 45 MHz", hclk);
+    }
+    if(hclk / sim_apb_div(cfgr, RCC_CFGR_PPRE2) > CLK_PCLK2_MAX_HZ){
+        sim_error("PCLK2 above 90 MHz", hclk);
+    }
+}
+
+static void* sim_hardware(void* arg){
+
+    uint8_t sws = 0;
+    uint8_t hse_rdy = 0;
+    uint8_t pll_rdy = 0;
+    uint8_t od_rdy = 0;
+    uint8_t od_sw = 0;
+    uint8_t latency = 0;
+    uint32_t pll_locked_cfgr = 0;
+    uint32_t core_clock = SystemCoreClock;
+    uint32_t scc, cfgr, pwr_cr, acr, cr, pllcfgr, rdy, hclk;
+    uint8_t sw;
+
+    (void)arg;
+
+    while(!__atomic_load_n(&sim_stop, __ATOMIC_ACQUIRE)){
+        /* Reverse order of the writes of the code under test */
+        scc = __atomic_load_n(&SystemCoreClock, __ATOMIC_ACQUIRE);
+        cfgr = __atomic_load_n(&sim_rcc.CFGR, __ATOMIC_ACQUIRE);
+        cr = __atomic_load_n(&sim_rcc.CR, __ATOMIC_ACQUIRE);
+        pllcfgr = __atomic_load_n(&sim_rcc.PLLCFGR, __ATOMIC_ACQUIRE);
+        pwr_cr = __atomic_load_n(&sim_pwr.CR, __ATOMIC_ACQUIRE);
+        acr = __atomic_load_n(&sim_flash.ACR, __ATOMIC_ACQUIRE);
+
+        if(((acr >> FLASH_ACR_LATENCY) & 0x0F) != latency){
+            latency = (acr >> FLASH_ACR_LATENCY) & 0x0F;
+            sim_event(EV_LATENCY, latency);
+        }
+        hclk = sim_sysclk(sws, pll_locked_cfgr) / sim_ahb_div(cfgr);
+        sim_check_clocks(hclk, cfgr, latency, od_sw);
+
+        /* Regulator */
+        if(((pwr_cr >> PWR_CR_ODEN) & 0x01) != od_rdy){
+            if(sws == 2){
+                sim_error("ODEN changed while the PLL is the system clock", pwr_cr);
+            }
+            od_rdy = (pwr_cr >> PWR_CR_ODEN) & 0x01;
+        }
+        if((((pwr_cr >> PWR_CR_ODSWEN) & 0x01) && od_rdy) != od_sw){
+            if(sws == 2){
+                sim_error("ODSWEN changed while the PLL is the system clock", pwr_cr);
+            }
+            od_sw = !od_sw;
+            sim_event(EV_OVERDRIVE, od_sw);
+        }
+        sim_pwr.CSR = ((uint32_t)od_rdy << PWR_CSR_ODRDY) | ((uint32_t)od_sw << PWR_CSR_ODSWRDY);
+
+        /* Oscillators */
+        hse_rdy = (cr >> RCC_CR_HSEON) & 0x01;
+        if(((cr >> RCC_CR_PLLON) & 0x01) != pll_rdy){
+            pll_rdy = !pll_rdy;
+            if(!pll_rdy && (sws == 2)){
+                sim_error("PLL stopped while it is the system clock", cr);
+            }
+            pll_locked_cfgr = pllcfgr;
+        }
+        else if(pll_rdy && (pllcfgr != pll_locked_cfgr)){
+            sim_error("PLL configured while it is on", pllcfgr);
+            pll_locked_cfgr = pllcfgr;
+        }
+        if(!((cr >> RCC_CR_HSION) & 0x01) && (sws == 0)){
+            sim_error("HSI stopped while it is the system clock", cr);
+        }
+
+        /* Clock switch */
+        sw = (cfgr >> RCC_CFGR_SW) & 0x03;
+        if(sw != sws){
+            if(((sw == 1) && !hse_rdy) || ((sw == 2) && !pll_rdy) || (sw == 3)){
+                sim_error("switch to a clock which is not ready", sw);
+            }
+            else{
+                if(scc != core_clock){
+                    sim_error("SystemCoreClock written before the clock switch", scc);
+                }
+                sws = sw;
+                hclk = sim_sysclk(sws, pll_locked_cfgr) / sim_ahb_div(cfgr);
+                sim_event(EV_SWITCH, hclk);
+                sim_check_clocks(hclk, cfgr, latency, od_sw);
+            }
+        }
+
+        if(scc != core_clock){
+            core_clock = scc;
+            sim_event(EV_CORECLOCK, scc);
+        }
+
+        /* Status flags, the code under test may have written back stale ones with a read-modify-write */
+        rdy = (1 << RCC_CR_HSIRDY) | (1 << RCC_CR_HSERDY) | (1 << RCC_CR_PLLRDY);
+        __atomic_fetch_and(&sim_rcc.CR, ~rdy, __ATOMIC_ACQ_REL);
+        __atomic_fetch_or(&sim_rcc.CR, (((cr >> RCC_CR_HSION) & 0x01) << RCC_CR_HSIRDY) |
+                          ((uint32_t)hse_rdy << RCC_CR_HSERDY) | ((uint32_t)pll_rdy << RCC_CR_PLLRDY),
+                          __ATOMIC_ACQ_REL);
+        __atomic_fetch_and(&sim_rcc.CFGR, ~(0x03U << RCC_CFGR_SWS), __ATOMIC_ACQ_REL);
+        __atomic_fetch_or(&sim_rcc.CFGR, (uint32_t)sws << RCC_CFGR_SWS, __ATOMIC_ACQ_REL);
+
+        __atomic_fetch_add(&sim_steps, 1, __ATOMIC_RELEASE);
+        sched_yield();
+    }
+
+    return NULL;
+}
+
+/** @brief Waits until the simulated hardware has seen all the writes done so far */
+static void sim_sync(void){
+
+    uint32_t steps = __atomic_load_n(&sim_steps, __ATOMIC_ACQUIRE);
+
+    while(__atomic_load_n(&sim_steps, __ATOMIC_ACQUIRE) < steps + 2){
+        sched_yield();
+    }
+}
+
+/***********************************************************************************************************/
+/*                                       Helpers                                                           */
+/***********************************************************************************************************/
+
+/** @brief Returns the index of the first event of the range, -1 if there is none */
+static int32_t find_event(uint32_t first, uint32_t last, sim_event_type_t type, uint32_t value){
+
+    for(uint32_t i = first; i < last; i++){
+        if((sim_log[i].type == type) && (sim_log[i].value == value)){
+            return (int32_t)i;
+        }
+    }
+
+    return -1;
+}
+
+static uint32_t count_events(uint32_t first, uint32_t last, sim_event_type_t type){
+
+    uint32_t count = 0;
+
+    for(uint32_t i = first; i < last; i++){
+        if(sim_log[i].type == type){
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Switches from an operating point to another and checks the order of the steps.
+ * @param[in] from is the expected state before the switch.
+ * @param[in] to is the operating point to be set.
+ * @return None
+ */
+static void test_transition(const opp_expected_t* from, clk_opp_t to){
+
+    const opp_expected_t* exp = &opp_expected[to];
+    uint32_t first = __atomic_load_n(&sim_log_len, __ATOMIC_ACQUIRE);
+    uint32_t last;
+    int32_t sw = -1;
+    int32_t ev;
+
+    CHECK(!clk_scaling_set(to));
+    sim_sync();
+    last = __atomic_load_n(&sim_log_len, __ATOMIC_ACQUIRE);
+
+    CHECK(clk_scaling_get() == to);
+    CHECK(SystemCoreClock == exp->hclk);
+    CHECK(((sim_flash.ACR >> FLASH_ACR_LATENCY) & 0x0F) == exp->latency);
+
+    /* The last switch is the one to the operating point, the rest go through HSI */
+    for(uint32_t i = first; i < last; i++){
+        if(sim_log[i].type == EV_SWITCH){
+            sw = (int32_t)i;
+        }
+    }
+    CHECK((sw >= 0) && (sim_log[sw].value == exp->hclk));
+
+    /* Wait states go up before the frequency, and down after it */
+    ev = find_event(first, last, EV_LATENCY, exp->latency);
+    if(exp->latency > from->latency){
+        CHECK((ev >= 0) && (ev < sw));
+    }
+    else if(exp->latency < from->latency){
+        CHECK(ev > sw);
+    }
+    else{
+        CHECK(count_events(first, last, EV_LATENCY) == 0);
+    }
+
+    /* Over-drive is turned on before the PLL becomes the system clock, it is turned off on HSI which may be the
+       last switch */
+    ev = find_event(first, last, EV_OVERDRIVE, exp->over_drive);
+    if(exp->over_drive && !from->over_drive){
+        CHECK((ev >= 0) && (ev < sw));
+    }
+    else if(!exp->over_drive && from->over_drive){
+        CHECK(ev >= 0);
+    }
+    else{
+        CHECK(count_events(first, last, EV_OVERDRIVE) == 0);
+    }
+
+    /* SystemCoreClock is written once, after the switch */
+    ev = find_event(first, last, EV_CORECLOCK, exp->hclk);
+    CHECK((ev > sw) && (count_events(first, last, EV_CORECLOCK) == 1));
+}
+
+/***********************************************************************************************************/
+/*                                       Tests                                                             */
+/***********************************************************************************************************/
+
+static void test_transitions(void){
+
+    /* State after reset: HSI, 0 wait states, normal regulator */
+    static const opp_expected_t reset = {CLK_HSI_HZ, 0, 0};
+    static const clk_opp_t sequence[] = {CLK_OPP_180MHZ, CLK_OPP_84MHZ, CLK_OPP_16MHZ, CLK_OPP_84MHZ,
+                                         CLK_OPP_180MHZ, CLK_OPP_16MHZ, CLK_OPP_180MHZ, CLK_OPP_84MHZ};
+    const opp_expected_t* from = &reset;
+    uint32_t first;
+
+    for(uint32_t i = 0; i < sizeof(sequence) / sizeof(sequence[0]); i++){
+        test_transition(from, sequence[i]);
+        from = &opp_expected[sequence[i]];
+    }
+
+    /* Same operating point and invalid one do nothing */
+    first = __atomic_load_n(&sim_log_len, __ATOMIC_ACQUIRE);
+    CHECK(!clk_scaling_set(CLK_OPP_84MHZ));
+    CHECK(clk_scaling_set(CLK_OPP_NUM));
+    sim_sync();
+    CHECK(__atomic_load_n(&sim_log_len, __ATOMIC_ACQUIRE) == first);
+    CHECK(clk_scaling_get() == CLK_OPP_84MHZ);
+
+    CHECK(sim_log_len < SIM_LOG_LEN);
+}
+
+int main(void){
+
+    pthread_t hardware;
+
+    /* Reset values: HSI on and selected, PLL off */
+    sim_rcc.CR = (1 << RCC_CR_HSION) | (1 << RCC_CR_HSIRDY);
+    sim_rcc.PLLCFGR = 0x24003010U;
+
+    CHECK(!pthread_create(&hardware, NULL, sim_hardware, NULL));
+    test_transitions();
+    __atomic_store_n(&sim_stop, 1, __ATOMIC_RELEASE);
+    pthread_join(hardware, NULL);
+
+    CHECK(sim_errors == 0);
+    if(failures){
+        printf("clk_scaling_test: %u checks failed\n", (unsigned int)failures);
+        return 1;
+    }
+    printf("clk_scaling_test: OK\n");
+
+    return 0;
+}
@@ -0,0 +1,256 @@
+/********************************************************************************************************//**
+* @file heap_bench.c
+*
+* @brief Host benchmark comparing the FreeRTOS heaps selectable in CMakeLists.txt on the same allocation
+* sequences.
+*
+* @note
+*       The file is built once per heap against the stub kernel headers of test/stub, with the RAM budget of the
+*       target: for heap_pool.c FREERTOS_HEAP_POOL is defined and the pool arena is taken out of
+*       configTOTAL_HEAP_SIZE, as in cfg/FreeRTOSConfig.h. Two sequences are replayed: a trace of kernel object
+*       creation and deletion, with the approximate object sizes of the target, and a random sequence of message
+*       and log line sized blocks. For each one the worst-case time of pvPortMalloc and vPortFree is printed, in
+*       TSC cycles on x86 and in nanoseconds elsewhere, taking for each operation the fastest of BENCH_RUNS runs
+*       so the preemptions of the host do not count, with the failed allocations and the fragmentation.
+*       Fragmentation is 100 - largest free block / free bytes of the allocator owning the free blocks: for
+*       heap_pool it is the one of its heap_4 part, the free bytes of the pools are printed apart since a pool
+*       block only serves its own size class. The benchmark fails if memory is lost between runs.
+*/
+
+#include "FreeRTOS.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifndef HEAP_BENCH_NAME
+#define HEAP_BENCH_NAME         "heap"
+#endif
+
+/** @brief Number of times each sequence is replayed for timing it */
+#define BENCH_RUNS              5
+/** @brief Number of blocks the sequences can keep allocated at the same time */
+#define BENCH_SLOTS             16
+/** @brief Number of operations of the random sequence */
+#define BENCH_RANDOM_OPS        20000
+/** @brief Maximum size of a random allocation, message payloads and log lines */
+#define BENCH_RANDOM_MAX        256
+/** @brief Approximate sizes of the kernel objects on the target */
+#define BENCH_TCB               96
+#define BENCH_STACK             (130 * 4)
+#define BENCH_QUEUE(n, sz)      (80 + ((n) * (sz)))
+#define BENCH_TIMER             44
+#define BENCH_SEM               80
+
+/** @brief Checks a condition, counting and printing the failure without stopping the benchmark */
+#define CHECK(cond)             do{ if(!(cond)){ printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+                                    failures++; } }while(0)
+
+/**
+ * @brief Structure with an operation of a sequence: the slot is freed if it holds a block, otherwise a block
+ *        of the given size is allocated in it.
+ */
+typedef struct{
+    uint8_t slot;           /**< Slot holding the block, 0 to BENCH_SLOTS - 1 */
+    uint16_t size;          /**< Size to be allocated in the slot, 0 for an operation that only frees */
+}bench_op_t;
+
+/**
+ * @brief Heap trace: the kernel objects of the application are created, then some of them are deleted and
+ *        created again as a command driven application does, leaving holes between the long lived ones.
+ */
+static const bench_op_t bench_trace[] = {
+    /* Boot: tasks (stack and TCB), queues, timers and mutexes */
+    {0, BENCH_STACK}, {1, BENCH_TCB}, {2, BENCH_STACK}, {3, BENCH_TCB},
+    {4, BENCH_QUEUE(10, 4)}, {5, BENCH_QUEUE(10, 1)},
+    {6, BENCH_TIMER}, {7, BENCH_TIMER}, {8, BENCH_TIMER}, {9, BENCH_TIMER}, {10, BENCH_SEM}, {11, BENCH_SEM},
+    /* Run time: a worker task and a reply queue come and go, timers are recreated with other periods */
+    {12, BENCH_STACK}, {13, BENCH_TCB}, {14, BENCH_QUEUE(4, 16)},
+    {7, 0}, {9, 0}, {12, 0}, {13, 0},
+    {7, BENCH_TIMER}, {15, BENCH_QUEUE(8, 4)},
+    {14, 0}, {2, 0}, {3, 0},
+    {12, BENCH_STACK}, {13, BENCH_TCB}, {9, BENCH_TIMER}, {14, BENCH_QUEUE(2, 32)},
+    {5, 0}, {8, 0},
+};
+
+/** @brief Random sequence, built at start */
+static bench_op_t bench_random[BENCH_RANDOM_OPS];
+
+/** @brief Heap of the allocator, configAPPLICATION_ALLOCATED_HEAP is set */
+uint8_t ucHeap[configTOTAL_HEAP_SIZE];
+
+/** @brief Blocks allocated */
+static void* block[BENCH_SLOTS];
+/** @brief Fastest time of each operation of the sequence over the runs, in the unit of time_now */
+static uint64_t malloc_time[BENCH_RANDOM_OPS];
+static uint64_t free_time[BENCH_RANDOM_OPS];
+/** @brief Free bytes once the heap is set up */
+static size_t initial_free;
+/** @brief Number of failed checks */
+static uint32_t failures = 0;
+
+#ifdef FREERTOS_HEAP_POOL
+/* heap_4.c compiled inside heap_pool.c, for the figures of the part where fragmentation can happen */
+size_t prvHeap4GetFreeHeapSize(void);
+void prvHeap4GetHeapStats(HeapStats_t* pxHeapStats);
+#endif
+
+/***********************************************************************************************************/
+/*                                       Helpers                                                           */
+/***********************************************************************************************************/
+
+/** @brief Timestamp, TSC cycles on x86 and nanoseconds elsewhere */
+static uint64_t time_now(void){
+
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/** @brief Fragmentation of the free blocks of the allocator in percent, see the file header */
+static uint32_t fragmentation(void){
+
+    HeapStats_t stats;
+
+#ifdef FREERTOS_HEAP_POOL
+    prvHeap4GetHeapStats(&stats);
+#else
+    vPortGetHeapStats(&stats);
+#endif
+    if(stats.xAvailableHeapSpaceInBytes == 0){
+        return 0;
+    }
+
+    return 100 - (uint32_t)((stats.xSizeOfLargestFreeBlockInBytes * 100) / stats.xAvailableHeapSpaceInBytes);
+}
+
+/** @brief Worst of the fastest times of the operations, 0 if the sequence has none of that kind */
+static uint64_t worst_time(const uint64_t* times, uint32_t num){
+
+    uint64_t worst = 0;
+
+    for(uint32_t i = 0; i < num; i++){
+        if((times[i] != UINT64_MAX) && (times[i] > worst)){
+            worst = times[i];
+        }
+    }
+
+    return worst;
+}
+
+/***********************************************************************************************************/
+/*                                       Benchmark                                                         */
+/***********************************************************************************************************/
+
+static void bench_replay(const char* name, const bench_op_t* ops, uint32_t num){
+
+    uint64_t elapsed;
+    uint32_t fails = 0, frag_end = 0, frag_worst = 0, frag;
+    size_t pool_free = 0;
+    const bench_op_t* op;
+
+    for(uint32_t i = 0; i < num; i++){
+        malloc_time[i] = UINT64_MAX;
+        free_time[i] = UINT64_MAX;
+    }
+
+    for(uint32_t run = 0; run < BENCH_RUNS; run++){
+        for(uint32_t i = 0; i < num; i++){
+            op = &ops[i];
+            if(block[op->slot] != NULL){
+                elapsed = time_now();
+                vPortFree(block[op->slot]);
+                elapsed = time_now() - elapsed;
+                block[op->slot] = NULL;
+                free_time[i] = (elapsed < free_time[i]) ? elapsed : free_time[i];
+            }
+            else if(op->size){
+                elapsed = time_now();
+                block[op->slot] = pvPortMalloc(op->size);
+                elapsed = time_now() - elapsed;
+                malloc_time[i] = (elapsed < malloc_time[i]) ? elapsed : malloc_time[i];
+                if((run == 0) && (block[op->slot] == NULL)){
+                    fails++;
+                }
+            }
+            if(run == 0){
+                frag = fragmentation();
+                frag_worst = (frag > frag_worst) ? frag : frag_worst;
+            }
+        }
+
+        if(run == 0){
+            frag_end = fragmentation();
+#ifdef FREERTOS_HEAP_POOL
+            pool_free = xPortGetFreeHeapSize() - prvHeap4GetFreeHeapSize();
+#endif
+        }
+
+        for(uint32_t i = 0; i < BENCH_SLOTS; i++){
+            vPortFree(block[i]);
+            block[i] = NULL;
+        }
+        /* Every run starts from the same heap */
+        CHECK(xPortGetFreeHeapSize() == initial_free);
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    printf("%s %s: malloc max %lu free max %lu cycles, %lu failed, fragmentation %lu%% at the end %lu%% worst",
+#else
+    printf("%s %s: malloc max %lu free max %lu ns, %lu failed, fragmentation %lu%% at the end %lu%% worst",
+#endif
+           HEAP_BENCH_NAME, name, (unsigned long)worst_time(malloc_time, num),
+           (unsigned long)worst_time(free_time, num), (unsigned long)fails, (unsigned long)frag_end,
+           (unsigned long)frag_worst);
+#ifdef FREERTOS_HEAP_POOL
+    printf(", pools %lu bytes free at the end", (unsigned long)pool_free);
+#else
+    (void)pool_free;
+#endif
+    printf("\n");
+}
+
+int main(void){
+
+    uint32_t seed = 1;
+
+    /* Touch the heap before the allocator sets it up, so the page faults of the host are not timed */
+    memset(ucHeap, 0, sizeof(ucHeap));
+    /* The heap is set up by the first allocation, the heap_4 part of heap_pool by the first one too big for
+       the pools */
+    vPortFree(pvPortMalloc(8));
+    vPortFree(pvPortMalloc(BENCH_STACK));
+    initial_free = xPortGetFreeHeapSize();
+
+    /* Same pseudo-random sequence for every heap, so the results can be compared */
+    for(uint32_t i = 0; i < BENCH_RANDOM_OPS; i++){
+        seed = (seed * 1664525U) + 1013904223U;
+        bench_random[i].slot = (uint8_t)((seed >> 24) % BENCH_SLOTS);
+        bench_random[i].size = (uint16_t)(1 + ((seed >> 8) % BENCH_RANDOM_MAX));
+    }
+
+    printf("%s: %lu bytes of heap, %lu free\n", HEAP_BENCH_NAME,
+#ifdef FREERTOS_HEAP_POOL
+           (unsigned long)(configTOTAL_HEAP_SIZE + configHEAP_POOL_ARENA_SIZE),
+#else
+           (unsigned long)configTOTAL_HEAP_SIZE,
+#endif
+           (unsigned long)initial_free);
+    bench_replay("trace", bench_trace, sizeof(bench_trace)/sizeof(bench_trace[0]));
+    bench_replay("random", bench_random, BENCH_RANDOM_OPS);
+
+    if(failures){
+        printf("%s: %u checks failed\n", HEAP_BENCH_NAME, (unsigned int)failures);
+        return 1;
+    }
+
+    return 0;
+}
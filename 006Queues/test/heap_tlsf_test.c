@@ -0,0 +1,296 @@
+/********************************************************************************************************//**
+* @file heap_tlsf_test.c
+*
+* @brief Host test of heap_tlsf.c replaying randomized sequences of allocations and frees.
+*
+* @note
+*       heap_tlsf.c is built against the stub kernel headers of test/stub. With configHEAP_TLSF_CHECKS set the
+*       block chain and the free lists are verified after every operation and any inconsistency aborts the test.
+*       On top of that each allocation is filled with a pattern checked at its free, which catches overlapping
+*       blocks, and the statistics are compared with the ones kept by the test. The host pointers are 8 bytes,
+*       so the block header is bigger than on the target but the alignment is the same.
+*       The test also reports the worst-case time of pvPortMalloc and vPortFree, in TSC cycles on x86 and in
+*       nanoseconds elsewhere, and the fragmentation of the free space, 100 - largest free block / free bytes
+*       in percent. The replay is run TEST_RUNS times with the same seed and each operation keeps its fastest
+*       run, so the preemptions of the host do not count. The times are only meaningful when built without
+*       configHEAP_TLSF_CHECKS.
+*/
+
+#include "FreeRTOS.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/** @brief Number of random operations replayed */
+#define TEST_OPS                200000
+/** @brief Number of times the same replay is run for timing it */
+#define TEST_RUNS               5
+/** @brief Seed of the pseudo-random generator at the start of each run */
+#define TEST_SEED               0x2545F491U
+/** @brief Maximum number of blocks allocated at the same time */
+#define TEST_SLOTS              64
+/** @brief Biggest random request, a quarter of the heap */
+#define TEST_MAX_SIZE           (configTOTAL_HEAP_SIZE / 4)
+
+/** @brief Checks a condition, counting and printing the failure without stopping the test */
+#define CHECK(cond)             do{ if(!(cond)){ printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+                                    failures++; } }while(0)
+
+/** @brief Heap of heap_tlsf.c, configAPPLICATION_ALLOCATED_HEAP is set so it can be bound checked */
+uint8_t ucHeap[configTOTAL_HEAP_SIZE];
+
+/**
+ * @brief Structure with a block allocated by the test.
+ */
+typedef struct{
+    uint8_t* ptr;                       /**< Memory returned by pvPortMalloc, NULL if the slot is empty */
+    size_t size;                        /**< Bytes requested */
+    uint8_t fill;                       /**< Pattern written to the block */
+}test_block_t;
+
+/** @brief Blocks allocated */
+static test_block_t blocks[TEST_SLOTS];
+/** @brief State of the pseudo-random generator */
+static uint32_t rnd_state = TEST_SEED;
+/** @brief Number of failed checks */
+static uint32_t failures = 0;
+/** @brief Allocations and frees done */
+static size_t allocs = 0;
+static size_t frees = 0;
+/** @brief Allocations which failed */
+static size_t alloc_failed = 0;
+/** @brief Fastest time of each operation of the replay over the runs, in the unit of time_now */
+static uint64_t op_time[TEST_OPS];
+/** @brief 1 if the operation of the replay is a free */
+static uint8_t op_free[TEST_OPS];
+/** @brief Worst and summed fragmentation of the free space after each operation, in percent */
+static uint32_t frag_worst = 0;
+static uint64_t frag_sum = 0;
+
+/***********************************************************************************************************/
+/*                                       Helpers                                                           */
+/***********************************************************************************************************/
+
+/** @brief Timestamp, TSC cycles on x86 and nanoseconds elsewhere */
+static uint64_t time_now(void){
+
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static uint32_t rnd(void){
+
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+
+    return rnd_state;
+}
+
+/** @brief Random request size, mostly small blocks as the kernel and the application ask for */
+static size_t rnd_size(void){
+
+    uint32_t r = rnd() % 16;
+
+    if(r < 10){
+        return 1 + rnd() % 64;
+    }
+    if(r < 15){
+        return 1 + rnd() % 256;
+    }
+
+    return 1 + rnd() % TEST_MAX_SIZE;
+}
+
+static void check_fill(const test_block_t* block){
+
+    for(size_t i = 0; i < block->size; i++){
+        if(block->ptr[i] != (uint8_t)(block->fill + i)){
+            CHECK(block->ptr[i] == (uint8_t)(block->fill + i));
+            return;
+        }
+    }
+}
+
+/** @brief Allocates a block and checks it, returns the time taken by pvPortMalloc */
+static uint64_t test_alloc(test_block_t* block, size_t size){
+
+    HeapStats_t stats;
+    size_t rounded;
+    uint64_t elapsed;
+
+    elapsed = time_now();
+    block->ptr = pvPortMalloc(size);
+    elapsed = time_now() - elapsed;
+    if(block->ptr == NULL){
+        /* The request is rounded up to the next list, a failure means no free block reaches that size */
+        rounded = (size < 16) ? 16 : ((size + 7) & ~(size_t)7);
+        vPortGetHeapStats(&stats);
+        CHECK(stats.xSizeOfLargestFreeBlockInBytes < rounded + (rounded >> 3));
+        alloc_failed++;
+        return elapsed;
+    }
+    allocs++;
+
+    CHECK(!((uintptr_t)block->ptr & portBYTE_ALIGNMENT_MASK));
+    CHECK((block->ptr >= ucHeap) && (block->ptr + size <= ucHeap + configTOTAL_HEAP_SIZE));
+    block->size = size;
+    block->fill = (uint8_t)rnd();
+    for(size_t i = 0; i < size; i++){
+        block->ptr[i] = (uint8_t)(block->fill + i);
+    }
+
+    return elapsed;
+}
+
+/** @brief Checks and frees a block, returns the time taken by vPortFree */
+static uint64_t test_free(test_block_t* block){
+
+    uint64_t elapsed;
+
+    check_fill(block);
+    elapsed = time_now();
+    vPortFree(block->ptr);
+    elapsed = time_now() - elapsed;
+    block->ptr = NULL;
+    frees++;
+
+    return elapsed;
+}
+
+/***********************************************************************************************************/
+/*                                       Tests                                                             */
+/***********************************************************************************************************/
+
+static void measure_fragmentation(void){
+
+    HeapStats_t stats;
+    uint32_t frag = 0;
+
+    vPortGetHeapStats(&stats);
+    if(stats.xAvailableHeapSpaceInBytes > 0){
+        frag = 100 - (uint32_t)((stats.xSizeOfLargestFreeBlockInBytes * 100) / stats.xAvailableHeapSpaceInBytes);
+    }
+    if(frag > frag_worst){
+        frag_worst = frag;
+    }
+    frag_sum += frag;
+}
+
+static void test_limits(void){
+
+    CHECK(pvPortMalloc(0) == NULL);
+    CHECK(pvPortMalloc(configTOTAL_HEAP_SIZE + 1) == NULL);
+    /* NULL is ignored */
+    vPortFree(NULL);
+}
+
+static void test_random(void){
+
+    HeapStats_t stats;
+    size_t initial_free;
+    test_block_t* block;
+    uint64_t elapsed;
+
+    /* The heap is set up by the first allocation, which is not part of the replay */
+    (void)test_alloc(&blocks[0], 8);
+    (void)test_free(&blocks[0]);
+    initial_free = xPortGetFreeHeapSize();
+    CHECK(initial_free > configTOTAL_HEAP_SIZE - 64);
+
+    for(uint32_t run = 0; run < TEST_RUNS; run++){
+        /* Everything is freed at the end of a run, so the next one replays the same operations on the same heap */
+        rnd_state = TEST_SEED;
+        for(uint32_t i = 0; i < TEST_OPS; i++){
+            block = &blocks[rnd() % TEST_SLOTS];
+            op_free[i] = (block->ptr != NULL);
+            if(op_free[i]){
+                elapsed = test_free(block);
+            }
+            else{
+                elapsed = test_alloc(block, rnd_size());
+            }
+            if((run == 0) || (elapsed < op_time[i])){
+                op_time[i] = elapsed;
+            }
+            CHECK(xPortGetMinimumEverFreeHeapSize() <= xPortGetFreeHeapSize());
+            if(run == 0){
+                measure_fragmentation();
+            }
+        }
+
+        for(uint32_t i = 0; i < TEST_SLOTS; i++){
+            if(blocks[i].ptr != NULL){
+                (void)test_free(&blocks[i]);
+            }
+        }
+    }
+
+    /* Everything merged back into a single free block */
+    vPortGetHeapStats(&stats);
+    CHECK(stats.xAvailableHeapSpaceInBytes == initial_free);
+    CHECK(stats.xNumberOfFreeBlocks == 1);
+    CHECK(stats.xSizeOfLargestFreeBlockInBytes == initial_free);
+    CHECK(stats.xNumberOfSuccessfulAllocations == allocs);
+    CHECK(stats.xNumberOfSuccessfulFrees == frees);
+    /* The replay filled the heap at some point */
+    CHECK(alloc_failed > 0);
+
+    /* Most of the heap can still be allocated at once, the search rounds the request up to the next list */
+    (void)test_alloc(&blocks[0], initial_free - (initial_free >> 3));
+    CHECK(blocks[0].ptr != NULL);
+    if(blocks[0].ptr != NULL){
+        (void)test_free(&blocks[0]);
+    }
+}
+
+static void report(void){
+
+    uint64_t malloc_worst = 0;
+    uint64_t free_worst = 0;
+
+    for(uint32_t i = 0; i < TEST_OPS; i++){
+        if(op_free[i] && (op_time[i] > free_worst)){
+            free_worst = op_time[i];
+        }
+        else if(!op_free[i] && (op_time[i] > malloc_worst)){
+            malloc_worst = op_time[i];
+        }
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    printf("heap_tlsf_test: worst case %lu cycles malloc, %lu cycles free%s\n",
+#else
+    printf("heap_tlsf_test: worst case %lu ns malloc, %lu ns free%s\n",
+#endif
+           (unsigned long)malloc_worst, (unsigned long)free_worst, configHEAP_TLSF_CHECKS ? " (heap checks on)" : "");
+    printf("heap_tlsf_test: fragmentation %lu%% worst, %lu%% mean\n", (unsigned long)frag_worst,
+           (unsigned long)(frag_sum / TEST_OPS));
+}
+
+int main(void){
+
+    /* Touch the heap before heap_tlsf.c sets it up, so the page faults of the host are not timed */
+    memset(ucHeap, 0, sizeof(ucHeap));
+    test_limits();
+    test_random();
+
+    if(failures){
+        printf("heap_tlsf_test: %u checks failed\n", (unsigned int)failures);
+        return 1;
+    }
+    printf("heap_tlsf_test: OK, %lu allocations, %lu failed\n", (unsigned long)allocs, (unsigned long)alloc_failed);
+    report();
+
+    return 0;
+}
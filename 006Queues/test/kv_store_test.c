@@ -0,0 +1,350 @@
+/********************************************************************************************************//**
+* @file kv_store_test.c
+*
+* @brief Host test of the key-value store over a RAM-backed emulation of the flash.
+*
+* @note
+*       The emulator behaves as the internal flash: an erase sets all the bits of a sector and programming a
+*       word can only clear bits. A reset is emulated with a budget of flash operations: once it is spent every
+*       operation fails and leaves the flash untouched, as if the MCU had stopped at that point. Mounting the
+*       store again with kv_init is the reboot.
+*/
+
+#include "kv_store.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/** @brief Size of each emulated sector, small so the store is compacted often */
+#define EMU_SECTOR_SIZE         1024
+/** @brief Budget value meaning no reset is pending */
+#define EMU_NO_RESET            0xFFFFFFFFU
+
+/** @brief Sector state words of kv_store.c, for checking which recovery path a reset leads to */
+#define KV_COPY                 0xEEEEEEEEU
+#define KV_ACTIVE               0xCCCCCCCCU
+
+/** @brief Checks a condition, counting and printing the failure without stopping the test */
+#define CHECK(cond)             do{ if(!(cond)){ printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+                                    failures++; } }while(0)
+
+/** @brief Emulated flash sectors */
+static uint32_t emu_flash[2][EMU_SECTOR_SIZE / 4];
+/** @brief Flash operations left before the emulated reset */
+static uint32_t emu_budget = EMU_NO_RESET;
+/** @brief Number of erases done */
+static uint32_t emu_erases = 0;
+/** @brief Number of words programmed */
+static uint32_t emu_programs = 0;
+/** @brief State of the pseudo-random generator */
+static uint32_t rnd_state = 0x12345678U;
+/** @brief Number of failed checks */
+static uint32_t failures = 0;
+
+/** @brief Version of the value of each key stored by the test, -1 if the key has no value */
+static int32_t model[KV_MAX_KEYS];
+
+/***********************************************************************************************************/
+/*                                       Flash Emulation                                                   */
+/***********************************************************************************************************/
+
+static uint8_t emu_spend(void){
+
+    if(emu_budget == EMU_NO_RESET){
+        return 0;
+    }
+    if(emu_budget == 0){
+        return 1;
+    }
+    emu_budget--;
+
+    return 0;
+}
+
+static uint8_t emu_erase(uint8_t sector){
+
+    CHECK(sector < 2);
+    if(emu_spend()){
+        return 1;
+    }
+    memset(emu_flash[sector], 0xFF, sizeof(emu_flash[sector]));
+    emu_erases++;
+
+    return 0;
+}
+
+static uint8_t emu_program(uint8_t sector, uint32_t offset, uint32_t data){
+
+    CHECK((sector < 2) && (offset < EMU_SECTOR_SIZE) && !(offset & 3));
+    if(emu_spend()){
+        return 1;
+    }
+    /* Setting a bit needs an erase, the store must never try it */
+    CHECK(!(data & ~emu_flash[sector][offset / 4]));
+    emu_flash[sector][offset / 4] &= data;
+    emu_programs++;
+
+    return 0;
+}
+
+static uint32_t emu_read(uint8_t sector, uint32_t offset){
+
+    CHECK((sector < 2) && (offset < EMU_SECTOR_SIZE) && !(offset & 3));
+
+    return emu_flash[sector][offset / 4];
+}
+
+/** @brief Flash access of the store over the emulation */
+static const kv_flash_t emu_flash_if = {
+    EMU_SECTOR_SIZE,
+    emu_erase,
+    emu_program,
+    emu_read
+};
+
+/***********************************************************************************************************/
+/*                                       Helpers                                                           */
+/***********************************************************************************************************/
+
+static uint32_t rnd(void){
+
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+
+    return rnd_state;
+}
+
+/** @brief Builds the value of a key for a version, its length also depends on both */
+static uint16_t make_value(uint8_t key, int32_t version, uint8_t* buf){
+
+    uint16_t len = 1 + (uint16_t)(((uint32_t)key * 7 + (uint32_t)version * 13) % KV_MAX_LEN);
+
+    for(uint16_t i = 0; i < len; i++){
+        buf[i] = (uint8_t)(key ^ (version * 31) ^ (i * 5));
+    }
+
+    return len;
+}
+
+/** @brief Returns 1 if the key holds the value of the version */
+static uint8_t has_value(uint8_t key, int32_t version){
+
+    uint8_t expected[KV_MAX_LEN];
+    uint8_t buf[KV_MAX_LEN];
+    uint16_t expected_len;
+    uint16_t len = sizeof(buf);
+
+    if(version < 0){
+        return kv_get(key, buf, &len) != 0;
+    }
+    expected_len = make_value(key, version, expected);
+    if(kv_get(key, buf, &len)){
+        return 0;
+    }
+
+    return (len == expected_len) && !memcmp(buf, expected, len);
+}
+
+static uint8_t set_value(uint8_t key, int32_t version){
+
+    uint8_t buf[KV_MAX_LEN];
+    uint16_t len = make_value(key, version, buf);
+
+    return kv_set(key, buf, len);
+}
+
+static void check_model(void){
+
+    for(uint8_t k = 0; k < KV_MAX_KEYS; k++){
+        CHECK(has_value(k, model[k]));
+    }
+}
+
+static void format(void){
+
+    memset(emu_flash, 0xFF, sizeof(emu_flash));
+    emu_budget = EMU_NO_RESET;
+    for(uint8_t k = 0; k < KV_MAX_KEYS; k++){
+        model[k] = -1;
+    }
+    CHECK(!kv_init(&emu_flash_if));
+}
+
+/**
+ * @brief Sets a key with a reset after each possible number of flash operations and checks the recovery.
+ * @param[in] key is the key to be set.
+ * @param[in] seen_copy is set to 1 if a reset left a sector in the copy state.
+ * @param[in] seen_both is set to 1 if a reset left both sectors active.
+ * @return None
+ */
+static void reset_sweep(uint8_t key, uint8_t* seen_copy, uint8_t* seen_both){
+
+    static uint32_t snapshot[2][EMU_SECTOR_SIZE / 4];
+    int32_t version = model[key] + 1;
+    uint8_t done = 0;
+
+    memcpy(snapshot, emu_flash, sizeof(snapshot));
+
+    for(uint32_t budget = 0; !done; budget++){
+        memcpy(emu_flash, snapshot, sizeof(emu_flash));
+        emu_budget = EMU_NO_RESET;
+        CHECK(!kv_init(&emu_flash_if));
+
+        emu_budget = budget;
+        (void)set_value(key, version);
+        /* Operations left means the set finished before the reset */
+        done = (emu_budget > 0);
+        if((emu_flash[0][0] == KV_COPY) || (emu_flash[1][0] == KV_COPY)){
+            *seen_copy = 1;
+        }
+        if((emu_flash[0][0] == KV_ACTIVE) && (emu_flash[1][0] == KV_ACTIVE)){
+            *seen_both = 1;
+        }
+
+        /* Reboot: the key holds the old or the new value, the rest of keys are untouched */
+        emu_budget = EMU_NO_RESET;
+        CHECK(!kv_init(&emu_flash_if));
+        CHECK(has_value(key, model[key]) || has_value(key, version));
+        if(done){
+            CHECK(has_value(key, version));
+        }
+        for(uint8_t k = 0; k < KV_MAX_KEYS; k++){
+            if(k != key){
+                CHECK(has_value(k, model[k]));
+            }
+        }
+
+        /* The recovered store keeps working */
+        CHECK(!set_value(key, version + 1));
+        CHECK(!kv_init(&emu_flash_if));
+        CHECK(has_value(key, version + 1));
+    }
+
+    /* Continue from the state where the set finished */
+    memcpy(emu_flash, snapshot, sizeof(emu_flash));
+    CHECK(!kv_init(&emu_flash_if));
+    CHECK(!set_value(key, version));
+    model[key] = version;
+}
+
+/***********************************************************************************************************/
+/*                                       Tests                                                             */
+/***********************************************************************************************************/
+
+static void test_basic(void){
+
+    uint8_t buf[KV_MAX_LEN + 1];
+    uint16_t len;
+
+    format();
+
+    len = sizeof(buf);
+    CHECK(kv_get(3, buf, &len));
+    CHECK(!set_value(3, 0));
+    CHECK(has_value(3, 0));
+
+    /* Invalid parameters */
+    CHECK(kv_set(KV_MAX_KEYS, buf, 1));
+    CHECK(kv_set(0, buf, 0));
+    CHECK(kv_set(0, buf, KV_MAX_LEN + 1));
+    CHECK(kv_set(0, NULL, 1));
+    len = 0;
+    CHECK(kv_get(3, buf, &len));
+
+    /* The value survives a reboot */
+    CHECK(!kv_init(&emu_flash_if));
+    CHECK(has_value(3, 0));
+}
+
+static void test_same_value(void){
+
+    uint32_t programs;
+
+    format();
+    CHECK(!set_value(5, 1));
+    programs = emu_programs;
+    CHECK(!set_value(5, 1));
+    CHECK(emu_programs == programs);
+}
+
+static void test_compaction(void){
+
+    uint8_t key;
+
+    format();
+    emu_erases = 0;
+
+    for(uint32_t i = 0; i < 5000; i++){
+        key = (uint8_t)(rnd() % KV_MAX_KEYS);
+        CHECK(!set_value(key, model[key] + 1));
+        model[key]++;
+        CHECK(has_value(key, model[key]));
+        if((i % 97) == 0){
+            CHECK(!kv_init(&emu_flash_if));
+            check_model();
+        }
+    }
+
+    CHECK(!kv_init(&emu_flash_if));
+    check_model();
+    /* The initial format plus many compactions */
+    CHECK(emu_erases > 10);
+}
+
+static void test_reset(void){
+
+    static uint32_t before[2][EMU_SECTOR_SIZE / 4];
+    uint8_t seen_copy = 0;
+    uint8_t seen_both = 0;
+    uint32_t erases;
+    uint8_t key;
+
+    format();
+    for(uint8_t k = 0; k < KV_MAX_KEYS; k++){
+        CHECK(!set_value(k, 0));
+        model[k] = 0;
+    }
+
+    /* Reset while appending a record */
+    reset_sweep(2, &seen_copy, &seen_both);
+
+    /* Reset while compacting: find the next set which compacts, for two compactions so both sectors are used
+       as destination */
+    for(uint8_t n = 0; n < 2; n++){
+        for(;;){
+            key = (uint8_t)(rnd() % KV_MAX_KEYS);
+            memcpy(before, emu_flash, sizeof(before));
+            erases = emu_erases;
+            CHECK(!set_value(key, model[key] + 1));
+            if(emu_erases != erases){
+                memcpy(emu_flash, before, sizeof(emu_flash));
+                CHECK(!kv_init(&emu_flash_if));
+                break;
+            }
+            model[key]++;
+        }
+        reset_sweep(key, &seen_copy, &seen_both);
+        check_model();
+    }
+
+    /* Both recovery paths of kv_init were exercised */
+    CHECK(seen_copy);
+    CHECK(seen_both);
+}
+
+int main(void){
+
+    test_basic();
+    test_same_value();
+    test_compaction();
+    test_reset();
+
+    if(failures){
+        printf("kv_store_test: %u checks failed\n", (unsigned int)failures);
+        return 1;
+    }
+    printf("kv_store_test: OK\n");
+
+    return 0;
+}
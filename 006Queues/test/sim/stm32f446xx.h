@@ -0,0 +1,28 @@
+/********************************************************************************************************//**
+* @file stm32f446xx.h
+*
+* @brief Device header for the host tests: the definitions of the real header with the RCC, PWR and FLASH
+* register blocks moved to variables of the test.
+*
+* @note
+*       This directory must be searched before src, so the drivers built for the host include this file.
+*/
+
+#ifndef STM32F446XX_SIM_H
+#define STM32F446XX_SIM_H
+
+#include "../../src/stm32f446xx.h"
+
+/** @brief Simulated register blocks, defined by the test */
+extern RCC_RegDef_t sim_rcc;
+extern PWR_RegDef_t sim_pwr;
+extern FLASHINTR_RegDef_t sim_flash;
+
+#undef RCC
+#undef PWR
+#undef FLASHINTR
+#define RCC         (&sim_rcc)
+#define PWR         (&sim_pwr)
+#define FLASHINTR   (&sim_flash)
+
+#endif /* STM32F446XX_SIM_H */
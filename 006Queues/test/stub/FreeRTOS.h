@@ -0,0 +1,78 @@
+/********************************************************************************************************//**
+* @file FreeRTOS.h
+*
+* @brief Stub of the kernel header for building kernel dependent modules on the host.
+*
+* @note
+*       Only the types, configuration and port macros used by the heaps and clk_scaling.c are defined. The
+*       scheduler is never started, so suspending it and the critical sections do nothing, and a failed
+*       configASSERT aborts the test.
+*/
+
+#ifndef FREERTOS_STUB_H
+#define FREERTOS_STUB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** @brief Same heap as the target, see cfg/FreeRTOSConfig.h */
+#define configSUPPORT_DYNAMIC_ALLOCATION    1
+#ifdef FREERTOS_HEAP_POOL
+#define configTOTAL_HEAP_SIZE               ((size_t)(4 * 1024) - configHEAP_POOL_ARENA_SIZE)
+#else
+#define configTOTAL_HEAP_SIZE               ((size_t)(4 * 1024))
+#endif
+#define configHEAP_POOL_BLOCK_SIZES         { 32, 64, 128, 256 }
+#define configHEAP_POOL_BLOCK_COUNTS        { 8, 8, 8, 4 }
+#define configHEAP_POOL_ARENA_SIZE          ((size_t)2816)
+#define configAPPLICATION_ALLOCATED_HEAP    1
+#define configUSE_MALLOC_FAILED_HOOK        0
+#ifndef configHEAP_TLSF_CHECKS
+#define configHEAP_TLSF_CHECKS              1
+#endif
+#define configTICK_RATE_HZ                  ((TickType_t)1000)
+
+#define configASSERT(x)         do{ if(!(x)){ fprintf(stderr, "%s:%d: configASSERT failed: %s\n", __FILE__, __LINE__, #x); \
+                                    abort(); } }while(0)
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+
+#define portBYTE_ALIGNMENT      8
+#define portBYTE_ALIGNMENT_MASK 0x0007
+#define portPOINTER_SIZE_TYPE   uintptr_t
+#define portMAX_DELAY           ((size_t)-1)
+
+#define PRIVILEGED_FUNCTION
+#define PRIVILEGED_DATA
+
+#define mtCOVERAGE_TEST_MARKER()
+#define traceMALLOC(pvAddress, uiSize)
+#define traceFREE(pvAddress, uiSize)
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+
+typedef long BaseType_t;
+typedef uint32_t TickType_t;
+
+/** @brief As in portable.h */
+typedef struct xHeapStats{
+    size_t xAvailableHeapSpaceInBytes;
+    size_t xSizeOfLargestFreeBlockInBytes;
+    size_t xSizeOfSmallestFreeBlockInBytes;
+    size_t xNumberOfFreeBlocks;
+    size_t xMinimumEverFreeBytesRemaining;
+    size_t xNumberOfSuccessfulAllocations;
+    size_t xNumberOfSuccessfulFrees;
+}HeapStats_t;
+
+void* pvPortMalloc(size_t xWantedSize);
+void vPortFree(void* pv);
+size_t xPortGetFreeHeapSize(void);
+size_t xPortGetMinimumEverFreeHeapSize(void);
+void vPortGetHeapStats(HeapStats_t* pxHeapStats);
+
+#endif /* FREERTOS_STUB_H */
@@ -0,0 +1,21 @@
+/********************************************************************************************************//**
+* @file task.h
+*
+* @brief Stub of the kernel task header for building kernel dependent modules on the host, the scheduler is never
+* started.
+*/
+
+#ifndef TASK_STUB_H
+#define TASK_STUB_H
+
+#include "FreeRTOS.h"
+
+#define taskSCHEDULER_SUSPENDED     ((BaseType_t)0)
+#define taskSCHEDULER_NOT_STARTED   ((BaseType_t)1)
+#define taskSCHEDULER_RUNNING       ((BaseType_t)2)
+
+#define vTaskSuspendAll()
+#define xTaskResumeAll()            ((BaseType_t)0)
+#define xTaskGetSchedulerState()    taskSCHEDULER_NOT_STARTED
+
+#endif /* TASK_STUB_H */
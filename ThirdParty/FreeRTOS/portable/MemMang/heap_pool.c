@@ -0,0 +1,349 @@
+/*
+ * FreeRTOS Kernel V10.4.3
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * An implementation of pvPortMalloc() and vPortFree() that serves small
+ * requests from fixed size block pools and the rest from heap_4.c.
+ *
+ * The pools live in their own arena of configHEAP_POOL_ARENA_SIZE bytes, split
+ * at the first allocation into the size classes given by
+ * configHEAP_POOL_BLOCK_SIZES and configHEAP_POOL_BLOCK_COUNTS.  Each class
+ * keeps a singly linked list of free blocks, so allocating and freeing a pool
+ * block is O(1) and blocks of one class never fragment another one.  A request
+ * is served by the smallest class that fits it; requests bigger than the
+ * largest class, or arriving when their class is exhausted, fall back to the
+ * first fit allocator of heap_4.c, which uses ucHeap as usual.  vPortFree()
+ * tells both kinds of block apart by their address.
+ *
+ * Select this file instead of heap_4.c in the CMakeLists.txt of the project,
+ * heap_4.c is compiled as part of this file.
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+    #error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+/* Default size classes, tuned for timers, queues and task control blocks. */
+#ifndef configHEAP_POOL_BLOCK_SIZES
+    #define configHEAP_POOL_BLOCK_SIZES     { 32, 64, 128, 256 }
+#endif
+
+#ifndef configHEAP_POOL_BLOCK_COUNTS
+    #define configHEAP_POOL_BLOCK_COUNTS    { 8, 8, 8, 4 }
+#endif
+
+#ifndef configHEAP_POOL_ARENA_SIZE
+    #define configHEAP_POOL_ARENA_SIZE      ( ( size_t ) 2816 )
+#endif
+
+/* Maximum number of size classes. */
+#define heapPOOL_MAX_CLASSES    ( 8 )
+
+/*-----------------------------------------------------------*/
+
+/* The heap_4.c allocator is compiled here under private names, it serves the
+ * requests the pools cannot serve. */
+void * prvHeap4Malloc( size_t xWantedSize ) PRIVILEGED_FUNCTION;
+void prvHeap4Free( void * pv ) PRIVILEGED_FUNCTION;
+size_t prvHeap4GetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
+size_t prvHeap4GetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
+void prvHeap4InitialiseBlocks( void ) PRIVILEGED_FUNCTION;
+void prvHeap4GetHeapStats( HeapStats_t * pxHeapStats );
+
+#define pvPortMalloc                        prvHeap4Malloc
+#define vPortFree                           prvHeap4Free
+#define xPortGetFreeHeapSize                prvHeap4GetFreeHeapSize
+#define xPortGetMinimumEverFreeHeapSize     prvHeap4GetMinimumEverFreeHeapSize
+#define vPortInitialiseBlocks               prvHeap4InitialiseBlocks
+#define vPortGetHeapStats                   prvHeap4GetHeapStats
+
+#include "heap_4.c"
+
+#undef pvPortMalloc
+#undef vPortFree
+#undef xPortGetFreeHeapSize
+#undef xPortGetMinimumEverFreeHeapSize
+#undef vPortInitialiseBlocks
+#undef vPortGetHeapStats
+
+/*-----------------------------------------------------------*/
+
+/* A free block of a pool, the link is stored in the block itself. */
+typedef struct A_POOL_LINK
+{
+    struct A_POOL_LINK * pxNextFreeBlock; /*<< The next free block of the same class. */
+} PoolLink_t;
+
+/* A size class. */
+typedef struct A_POOL_CLASS
+{
+    PoolLink_t * pxFreeList; /*<< First free block, NULL when the class is exhausted. */
+    uint8_t * pucStart;      /*<< First byte of the class in the arena. */
+    uint8_t * pucEnd;        /*<< First byte after the class in the arena. */
+    size_t xBlockSize;       /*<< Size of every block, multiple of portBYTE_ALIGNMENT. */
+} PoolClass_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Splits the arena in the size classes and links their free blocks.  Called
+ * automatically the first time pvPortMalloc() is called.
+ */
+static void prvPoolInit( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * Returns the class the block belongs to, or NULL if the block does not come
+ * from the arena.
+ */
+static PoolClass_t * prvPoolFindClass( const void * pv ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+/* The arena, aligned for the blocks it holds. */
+PRIVILEGED_DATA static union
+{
+    uint8_t ucBytes[ configHEAP_POOL_ARENA_SIZE ];
+    uint64_t ullAlign;
+} xPoolArena;
+
+PRIVILEGED_DATA static PoolClass_t xPoolClasses[ heapPOOL_MAX_CLASSES ];
+PRIVILEGED_DATA static BaseType_t xPoolNumClasses = 0;
+PRIVILEGED_DATA static BaseType_t xPoolInitialised = pdFALSE;
+
+/* Same statistics as heap_4.c, for the pool blocks only. */
+PRIVILEGED_DATA static size_t xPoolFreeBytesRemaining = 0U;
+PRIVILEGED_DATA static size_t xPoolMinimumEverFreeBytesRemaining = 0U;
+PRIVILEGED_DATA static size_t xPoolNumberOfSuccessfulAllocations = 0;
+PRIVILEGED_DATA static size_t xPoolNumberOfSuccessfulFrees = 0;
+
+/*-----------------------------------------------------------*/
+
+void * pvPortMalloc( size_t xWantedSize )
+{
+    PoolClass_t * pxClass = NULL;
+    PoolLink_t * pxBlock = NULL;
+    BaseType_t x;
+
+    vTaskSuspendAll();
+    {
+        if( xPoolInitialised == pdFALSE )
+        {
+            prvPoolInit();
+        }
+
+        if( xWantedSize > 0 )
+        {
+            /* Smallest class that fits, the classes are sorted by size. */
+            for( x = 0; x < xPoolNumClasses; x++ )
+            {
+                if( xWantedSize <= xPoolClasses[ x ].xBlockSize )
+                {
+                    pxClass = &xPoolClasses[ x ];
+                    break;
+                }
+            }
+
+            if( ( pxClass != NULL ) && ( pxClass->pxFreeList != NULL ) )
+            {
+                pxBlock = pxClass->pxFreeList;
+                pxClass->pxFreeList = pxBlock->pxNextFreeBlock;
+                xPoolFreeBytesRemaining -= pxClass->xBlockSize;
+
+                if( xPoolFreeBytesRemaining < xPoolMinimumEverFreeBytesRemaining )
+                {
+                    xPoolMinimumEverFreeBytesRemaining = xPoolFreeBytesRemaining;
+                }
+
+                xPoolNumberOfSuccessfulAllocations++;
+                traceMALLOC( ( void * ) pxBlock, xWantedSize );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    if( pxBlock == NULL )
+    {
+        /* Too big for the pools or the class is exhausted. heap_4.c calls the
+         * malloc failed hook if it cannot serve the request either. */
+        return prvHeap4Malloc( xWantedSize );
+    }
+
+    return ( void * ) pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void * pv )
+{
+    PoolClass_t * pxClass;
+    PoolLink_t * pxBlock = ( PoolLink_t * ) pv;
+
+    if( pv != NULL )
+    {
+        pxClass = prvPoolFindClass( pv );
+
+        if( pxClass != NULL )
+        {
+            /* The block must be at a block boundary of its class. */
+            configASSERT( ( ( size_t ) ( ( uint8_t * ) pv - pxClass->pucStart ) % pxClass->xBlockSize ) == 0 );
+
+            vTaskSuspendAll();
+            {
+                pxBlock->pxNextFreeBlock = pxClass->pxFreeList;
+                pxClass->pxFreeList = pxBlock;
+                xPoolFreeBytesRemaining += pxClass->xBlockSize;
+                xPoolNumberOfSuccessfulFrees++;
+                traceFREE( pv, pxClass->xBlockSize );
+            }
+            ( void ) xTaskResumeAll();
+        }
+        else
+        {
+            prvHeap4Free( pv );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+    return prvHeap4GetFreeHeapSize() + xPoolFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+    /* Both minimums may have been reached at different times, so this is a
+     * lower bound of the real minimum. */
+    return prvHeap4GetMinimumEverFreeHeapSize() + xPoolMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+    /* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t * pxHeapStats )
+{
+    /* The free block figures describe the heap_4.c part, where fragmentation
+     * can happen.  The byte and call counts include the pools. */
+    prvHeap4GetHeapStats( pxHeapStats );
+
+    taskENTER_CRITICAL();
+    {
+        pxHeapStats->xAvailableHeapSpaceInBytes += xPoolFreeBytesRemaining;
+        pxHeapStats->xMinimumEverFreeBytesRemaining += xPoolMinimumEverFreeBytesRemaining;
+        pxHeapStats->xNumberOfSuccessfulAllocations += xPoolNumberOfSuccessfulAllocations;
+        pxHeapStats->xNumberOfSuccessfulFrees += xPoolNumberOfSuccessfulFrees;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvPoolInit( void ) /* PRIVILEGED_FUNCTION */
+{
+    static const size_t xBlockSizes[] = configHEAP_POOL_BLOCK_SIZES;
+    static const size_t xBlockCounts[] = configHEAP_POOL_BLOCK_COUNTS;
+    uint8_t * pucNext = xPoolArena.ucBytes;
+    PoolLink_t * pxBlock;
+    size_t xCount, xBlockSize;
+    BaseType_t x;
+
+    configASSERT( sizeof( xBlockSizes ) / sizeof( xBlockSizes[ 0 ] ) == sizeof( xBlockCounts ) / sizeof( xBlockCounts[ 0 ] ) );
+    configASSERT( sizeof( xBlockSizes ) / sizeof( xBlockSizes[ 0 ] ) <= heapPOOL_MAX_CLASSES );
+
+    xPoolNumClasses = ( BaseType_t ) ( sizeof( xBlockSizes ) / sizeof( xBlockSizes[ 0 ] ) );
+
+    for( x = 0; x < xPoolNumClasses; x++ )
+    {
+        /* Blocks keep the alignment of the port, and must hold the link. */
+        xBlockSize = ( xBlockSizes[ x ] + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+        configASSERT( xBlockSize >= sizeof( PoolLink_t ) );
+        configASSERT( ( x == 0 ) || ( xBlockSize > xPoolClasses[ x - 1 ].xBlockSize ) );
+        configASSERT( ( size_t ) ( pucNext - xPoolArena.ucBytes ) + ( xBlockSize * xBlockCounts[ x ] ) <= configHEAP_POOL_ARENA_SIZE );
+
+        xPoolClasses[ x ].xBlockSize = xBlockSize;
+        xPoolClasses[ x ].pucStart = pucNext;
+        xPoolClasses[ x ].pxFreeList = NULL;
+
+        /* Link the blocks from the end, so they are handed out in address
+         * order. */
+        for( xCount = xBlockCounts[ x ]; xCount > 0; xCount-- )
+        {
+            pxBlock = ( PoolLink_t * ) ( pucNext + ( ( xCount - 1 ) * xBlockSize ) );
+            pxBlock->pxNextFreeBlock = xPoolClasses[ x ].pxFreeList;
+            xPoolClasses[ x ].pxFreeList = pxBlock;
+        }
+
+        pucNext += xBlockSize * xBlockCounts[ x ];
+        xPoolClasses[ x ].pucEnd = pucNext;
+        xPoolFreeBytesRemaining += xBlockSize * xBlockCounts[ x ];
+    }
+
+    xPoolMinimumEverFreeBytesRemaining = xPoolFreeBytesRemaining;
+    xPoolInitialised = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static PoolClass_t * prvPoolFindClass( const void * pv ) /* PRIVILEGED_FUNCTION */
+{
+    const uint8_t * puc = ( const uint8_t * ) pv;
+    BaseType_t x;
+
+    if( ( puc >= xPoolArena.ucBytes ) && ( puc < &xPoolArena.ucBytes[ configHEAP_POOL_ARENA_SIZE ] ) )
+    {
+        for( x = 0; x < xPoolNumClasses; x++ )
+        {
+            if( ( puc >= xPoolClasses[ x ].pucStart ) && ( puc < xPoolClasses[ x ].pucEnd ) )
+            {
+                return &xPoolClasses[ x ];
+            }
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,653 @@
+/*
+ * FreeRTOS Kernel V10.4.3
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * An implementation of pvPortMalloc() and vPortFree() based on the Two-Level
+ * Segregated Fit allocator, with bounded O(1) execution time.
+ *
+ * Free blocks are kept in segregated lists indexed by a first level (power of
+ * two of the size) and a second level (heapTLSF_SL_COUNT linear subdivisions
+ * of that power of two).  Two bitmaps tell which lists are not empty, so the
+ * list holding a block big enough for a request is found with two count
+ * leading/trailing zeros instructions instead of walking a free list.  Freed
+ * blocks are merged with their free physical neighbours immediately.
+ *
+ * Every block has an 8 byte header: the previous physical block, only valid
+ * when that block is free, and the size of the block with two flags in the
+ * lower bits.  The heap is ucHeap, as in heap_4.c.
+ *
+ * With configHEAP_TLSF_CHECKS set to 1 the whole heap is verified after every
+ * operation, which is O(n) with the scheduler suspended and only meant for
+ * debugging.  It defaults to 0.
+ *
+ * Select this file instead of heap_4.c in the CMakeLists.txt of the project.
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+    #error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+#ifndef configHEAP_TLSF_CHECKS
+    #define configHEAP_TLSF_CHECKS    0
+#endif
+
+#if ( portBYTE_ALIGNMENT != 8 )
+    #error heap_tlsf.c assumes an 8 byte alignment
+#endif
+
+/* Second level: log2 of the number of subdivisions of each power of two. */
+#define heapTLSF_SL_LOG2           ( 4 )
+#define heapTLSF_SL_COUNT          ( 1 << heapTLSF_SL_LOG2 )
+
+/* Blocks below heapTLSF_SMALL_BLOCK are all in the first level 0, split in
+ * heapTLSF_SL_COUNT lists of portBYTE_ALIGNMENT bytes. */
+#define heapTLSF_ALIGN_LOG2        ( 3 )
+#define heapTLSF_FL_SHIFT          ( heapTLSF_SL_LOG2 + heapTLSF_ALIGN_LOG2 )
+#define heapTLSF_SMALL_BLOCK       ( ( size_t ) 1 << heapTLSF_FL_SHIFT )
+
+/* Biggest block is below 2^heapTLSF_FL_MAX bytes, 128 KB covers all the SRAM. */
+#define heapTLSF_FL_MAX            ( 17 )
+#define heapTLSF_FL_COUNT          ( heapTLSF_FL_MAX - heapTLSF_FL_SHIFT + 1 )
+
+/* Flags stored in the lower bits of the block size. */
+#define heapTLSF_FREE_BIT          ( ( size_t ) 1 )
+#define heapTLSF_PREV_FREE_BIT     ( ( size_t ) 2 )
+#define heapTLSF_FLAGS_MASK        ( heapTLSF_FREE_BIT | heapTLSF_PREV_FREE_BIT )
+
+/* Find last set and find first set bit, the argument must not be 0. */
+#define heapTLSF_FLS( x )          ( 31 - __builtin_clz( ( uint32_t ) ( x ) ) )
+#define heapTLSF_FFS( x )          ( __builtin_ctz( ( uint32_t ) ( x ) ) )
+
+/* Allocate the memory for the heap. */
+#if ( configAPPLICATION_ALLOCATED_HEAP == 1 )
+
+/* The application writer has already defined the array used for the RTOS
+* heap - probably so it can be placed in a special segment or address. */
+    extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#else
+    PRIVILEGED_DATA static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#endif /* configAPPLICATION_ALLOCATED_HEAP */
+
+/* A block of the heap.  The free list links are only used while the block is
+ * free, they are part of the memory handed to the application otherwise. */
+typedef struct A_TLSF_BLOCK
+{
+    struct A_TLSF_BLOCK * pxPrevPhysBlock; /*<< Previous physical block, valid when it is free. */
+    size_t xSize;                          /*<< Bytes after the header, with the flags in the lower bits. */
+    struct A_TLSF_BLOCK * pxNextFree;      /*<< Next block of the same free list. */
+    struct A_TLSF_BLOCK * pxPrevFree;      /*<< Previous block of the same free list. */
+} TlsfBlock_t;
+
+/* Bytes between the start of a block and the memory handed to the application. */
+#define heapTLSF_HEADER_SIZE       ( ( size_t ) ( 2 * sizeof( void * ) ) )
+
+/* A free block must hold the free list links. */
+#define heapTLSF_MIN_BLOCK_SIZE    ( sizeof( TlsfBlock_t ) - heapTLSF_HEADER_SIZE )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Called automatically to setup the required heap structures the first time
+ * pvPortMalloc() is called.
+ */
+static void prvHeapInit( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * Gets the lists where a block of the given size is stored.
+ */
+static void prvMappingInsert( size_t xSize,
+                              BaseType_t * pxFl,
+                              BaseType_t * pxSl ) PRIVILEGED_FUNCTION;
+
+/*
+ * Gets the first lists where every block is at least of the given size.
+ */
+static void prvMappingSearch( size_t xSize,
+                              BaseType_t * pxFl,
+                              BaseType_t * pxSl ) PRIVILEGED_FUNCTION;
+
+/*
+ * Removes and returns a block of at least xSize bytes, NULL if there is none.
+ */
+static TlsfBlock_t * prvTakeSuitableBlock( size_t xSize ) PRIVILEGED_FUNCTION;
+
+/*
+ * Adds a free block to its free list.
+ */
+static void prvInsertFreeBlock( TlsfBlock_t * pxBlock ) PRIVILEGED_FUNCTION;
+
+/*
+ * Removes a free block from its free list.
+ */
+static void prvRemoveFreeBlock( TlsfBlock_t * pxBlock ) PRIVILEGED_FUNCTION;
+
+/*
+ * Returns the next physical block.
+ */
+static TlsfBlock_t * prvNextPhysBlock( const TlsfBlock_t * pxBlock ) PRIVILEGED_FUNCTION;
+
+#if ( configHEAP_TLSF_CHECKS == 1 )
+
+/*
+ * Walks the whole heap and the free lists asserting their consistency.
+ */
+    static void prvCheckHeap( void ) PRIVILEGED_FUNCTION;
+#endif
+
+/*-----------------------------------------------------------*/
+
+/* First and second level bitmaps, and the heads of the free lists. */
+PRIVILEGED_DATA static uint32_t ulFlBitmap = 0;
+PRIVILEGED_DATA static uint32_t ulSlBitmap[ heapTLSF_FL_COUNT ];
+PRIVILEGED_DATA static TlsfBlock_t * pxFreeLists[ heapTLSF_FL_COUNT ][ heapTLSF_SL_COUNT ];
+
+/* First block of the heap, and the zero sized block marking its end. */
+PRIVILEGED_DATA static TlsfBlock_t * pxFirstBlock = NULL;
+PRIVILEGED_DATA static TlsfBlock_t * pxLastBlock = NULL;
+
+/* Same statistics as heap_4.c, counting the bytes handed to the application. */
+PRIVILEGED_DATA static size_t xFreeBytesRemaining = 0U;
+PRIVILEGED_DATA static size_t xMinimumEverFreeBytesRemaining = 0U;
+PRIVILEGED_DATA static size_t xNumberOfSuccessfulAllocations = 0;
+PRIVILEGED_DATA static size_t xNumberOfSuccessfulFrees = 0;
+
+/*-----------------------------------------------------------*/
+
+void * pvPortMalloc( size_t xWantedSize )
+{
+    TlsfBlock_t * pxBlock = NULL;
+    TlsfBlock_t * pxRemainder;
+    TlsfBlock_t * pxNext;
+    size_t xSize;
+    void * pvReturn = NULL;
+
+    vTaskSuspendAll();
+    {
+        if( pxFirstBlock == NULL )
+        {
+            prvHeapInit();
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        if( ( xWantedSize > 0 ) && ( xWantedSize <= configTOTAL_HEAP_SIZE ) )
+        {
+            xSize = ( xWantedSize + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+            if( xSize < heapTLSF_MIN_BLOCK_SIZE )
+            {
+                xSize = heapTLSF_MIN_BLOCK_SIZE;
+            }
+
+            pxBlock = prvTakeSuitableBlock( xSize );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        if( pxBlock != NULL )
+        {
+            /* Give the tail back if it can hold a block on its own. */
+            if( ( pxBlock->xSize & ~heapTLSF_FLAGS_MASK ) >= ( xSize + heapTLSF_HEADER_SIZE + heapTLSF_MIN_BLOCK_SIZE ) )
+            {
+                pxRemainder = ( TlsfBlock_t * ) ( ( ( uint8_t * ) pxBlock ) + heapTLSF_HEADER_SIZE + xSize );
+                pxRemainder->xSize = ( ( pxBlock->xSize & ~heapTLSF_FLAGS_MASK ) - xSize - heapTLSF_HEADER_SIZE ) | heapTLSF_FREE_BIT;
+                pxRemainder->pxPrevPhysBlock = pxBlock;
+                pxBlock->xSize = xSize | ( pxBlock->xSize & heapTLSF_FLAGS_MASK );
+
+                pxNext = prvNextPhysBlock( pxRemainder );
+                pxNext->pxPrevPhysBlock = pxRemainder;
+                prvInsertFreeBlock( pxRemainder );
+                xFreeBytesRemaining -= heapTLSF_HEADER_SIZE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            /* The block now belongs to the application. */
+            pxBlock->xSize &= ~heapTLSF_FREE_BIT;
+            pxNext = prvNextPhysBlock( pxBlock );
+            pxNext->xSize &= ~heapTLSF_PREV_FREE_BIT;
+
+            xFreeBytesRemaining -= ( pxBlock->xSize & ~heapTLSF_FLAGS_MASK );
+
+            if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+            {
+                xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            xNumberOfSuccessfulAllocations++;
+            pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + heapTLSF_HEADER_SIZE );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        #if ( configHEAP_TLSF_CHECKS == 1 )
+            prvCheckHeap();
+        #endif
+
+        traceMALLOC( pvReturn, xWantedSize );
+    }
+    ( void ) xTaskResumeAll();
+
+    #if ( configUSE_MALLOC_FAILED_HOOK == 1 )
+        {
+            if( pvReturn == NULL )
+            {
+                extern void vApplicationMallocFailedHook( void );
+                vApplicationMallocFailedHook();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+    #endif /* if ( configUSE_MALLOC_FAILED_HOOK == 1 ) */
+
+    configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void * pv )
+{
+    TlsfBlock_t * pxBlock;
+    TlsfBlock_t * pxNeighbour;
+
+    if( pv != NULL )
+    {
+        pxBlock = ( TlsfBlock_t * ) ( ( ( uint8_t * ) pv ) - heapTLSF_HEADER_SIZE );
+
+        /* The pointer must come from pvPortMalloc() and not be freed yet. */
+        configASSERT( ( ( uint8_t * ) pxBlock >= ( uint8_t * ) pxFirstBlock ) && ( pxBlock < pxLastBlock ) );
+        configASSERT( ( pxBlock->xSize & heapTLSF_FREE_BIT ) == 0 );
+
+        vTaskSuspendAll();
+        {
+            xFreeBytesRemaining += ( pxBlock->xSize & ~heapTLSF_FLAGS_MASK );
+            traceFREE( pv, pxBlock->xSize & ~heapTLSF_FLAGS_MASK );
+            pxBlock->xSize |= heapTLSF_FREE_BIT;
+
+            /* Merge with the previous block. */
+            if( ( pxBlock->xSize & heapTLSF_PREV_FREE_BIT ) != 0 )
+            {
+                pxNeighbour = pxBlock->pxPrevPhysBlock;
+                prvRemoveFreeBlock( pxNeighbour );
+                pxNeighbour->xSize += heapTLSF_HEADER_SIZE + ( pxBlock->xSize & ~heapTLSF_FLAGS_MASK );
+                pxBlock = pxNeighbour;
+                xFreeBytesRemaining += heapTLSF_HEADER_SIZE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            /* Merge with the next block. */
+            pxNeighbour = prvNextPhysBlock( pxBlock );
+
+            if( ( pxNeighbour->xSize & heapTLSF_FREE_BIT ) != 0 )
+            {
+                prvRemoveFreeBlock( pxNeighbour );
+                pxBlock->xSize += heapTLSF_HEADER_SIZE + ( pxNeighbour->xSize & ~heapTLSF_FLAGS_MASK );
+                xFreeBytesRemaining += heapTLSF_HEADER_SIZE;
+                pxNeighbour = prvNextPhysBlock( pxBlock );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            pxNeighbour->pxPrevPhysBlock = pxBlock;
+            pxNeighbour->xSize |= heapTLSF_PREV_FREE_BIT;
+            prvInsertFreeBlock( pxBlock );
+            xNumberOfSuccessfulFrees++;
+
+            #if ( configHEAP_TLSF_CHECKS == 1 )
+                prvCheckHeap();
+            #endif
+        }
+        ( void ) xTaskResumeAll();
+    }
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+    return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+    return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+    /* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t * pxHeapStats )
+{
+    TlsfBlock_t * pxBlock;
+    size_t xBlocks = 0, xMaxSize = 0, xMinSize = portMAX_DELAY; /* portMAX_DELAY used as a portable way of getting the maximum value. */
+
+    vTaskSuspendAll();
+    {
+        /* pxBlock will be NULL if the heap has not been initialised.  The heap
+         * is initialised automatically when the first allocation is made. */
+        for( pxBlock = pxFirstBlock; ( pxBlock != NULL ) && ( pxBlock != pxLastBlock ); pxBlock = prvNextPhysBlock( pxBlock ) )
+        {
+            if( ( pxBlock->xSize & heapTLSF_FREE_BIT ) != 0 )
+            {
+                xBlocks++;
+
+                if( ( pxBlock->xSize & ~heapTLSF_FLAGS_MASK ) > xMaxSize )
+                {
+                    xMaxSize = pxBlock->xSize & ~heapTLSF_FLAGS_MASK;
+                }
+
+                if( ( pxBlock->xSize & ~heapTLSF_FLAGS_MASK ) < xMinSize )
+                {
+                    xMinSize = pxBlock->xSize & ~heapTLSF_FLAGS_MASK;
+                }
+            }
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    pxHeapStats->xSizeOfLargestFreeBlockInBytes = xMaxSize;
+    pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xMinSize;
+    pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+
+    taskENTER_CRITICAL();
+    {
+        pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+        pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+        pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+        pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void ) /* PRIVILEGED_FUNCTION */
+{
+    size_t uxAddress;
+    size_t xTotalHeapSize = configTOTAL_HEAP_SIZE;
+
+    /* Ensure the heap starts on a correctly aligned boundary. */
+    uxAddress = ( size_t ) ucHeap;
+
+    if( ( uxAddress & portBYTE_ALIGNMENT_MASK ) != 0 )
+    {
+        uxAddress += ( portBYTE_ALIGNMENT - 1 );
+        uxAddress &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+        xTotalHeapSize -= uxAddress - ( size_t ) ucHeap;
+    }
+
+    xTotalHeapSize &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+    configASSERT( xTotalHeapSize < ( ( size_t ) 1 << heapTLSF_FL_MAX ) );
+
+    /* One free block with all the heap, followed by a used zero sized block
+     * so the merge never goes past the end. */
+    pxFirstBlock = ( TlsfBlock_t * ) uxAddress;
+    pxFirstBlock->pxPrevPhysBlock = NULL;
+    pxFirstBlock->xSize = ( xTotalHeapSize - ( 2 * heapTLSF_HEADER_SIZE ) ) | heapTLSF_FREE_BIT;
+
+    pxLastBlock = prvNextPhysBlock( pxFirstBlock );
+    pxLastBlock->pxPrevPhysBlock = pxFirstBlock;
+    pxLastBlock->xSize = heapTLSF_PREV_FREE_BIT;
+
+    prvInsertFreeBlock( pxFirstBlock );
+
+    xFreeBytesRemaining = pxFirstBlock->xSize & ~heapTLSF_FLAGS_MASK;
+    xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingInsert( size_t xSize,
+                              BaseType_t * pxFl,
+                              BaseType_t * pxSl ) /* PRIVILEGED_FUNCTION */
+{
+    BaseType_t xFl;
+
+    if( xSize < heapTLSF_SMALL_BLOCK )
+    {
+        *pxFl = 0;
+        *pxSl = ( BaseType_t ) ( xSize >> heapTLSF_ALIGN_LOG2 );
+    }
+    else
+    {
+        xFl = heapTLSF_FLS( xSize );
+        *pxSl = ( BaseType_t ) ( ( xSize >> ( xFl - heapTLSF_SL_LOG2 ) ) ^ ( ( size_t ) 1 << heapTLSF_SL_LOG2 ) );
+        *pxFl = xFl - ( heapTLSF_FL_SHIFT - 1 );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingSearch( size_t xSize,
+                              BaseType_t * pxFl,
+                              BaseType_t * pxSl ) /* PRIVILEGED_FUNCTION */
+{
+    /* Round up to the next list, so any block found there is big enough. */
+    if( xSize >= heapTLSF_SMALL_BLOCK )
+    {
+        xSize += ( ( size_t ) 1 << ( heapTLSF_FLS( xSize ) - heapTLSF_SL_LOG2 ) ) - 1;
+    }
+
+    prvMappingInsert( xSize, pxFl, pxSl );
+}
+/*-----------------------------------------------------------*/
+
+static TlsfBlock_t * prvTakeSuitableBlock( size_t xSize ) /* PRIVILEGED_FUNCTION */
+{
+    BaseType_t xFl, xSl;
+    uint32_t ulSlMap, ulFlMap;
+    TlsfBlock_t * pxBlock;
+
+    prvMappingSearch( xSize, &xFl, &xSl );
+
+    if( xFl >= heapTLSF_FL_COUNT )
+    {
+        return NULL;
+    }
+
+    /* A non empty list in the same first level, or the first non empty list
+     * of a bigger first level. */
+    ulSlMap = ulSlBitmap[ xFl ] & ( ~( uint32_t ) 0 << xSl );
+
+    if( ulSlMap == 0 )
+    {
+        ulFlMap = ulFlBitmap & ( ~( uint32_t ) 0 << ( xFl + 1 ) );
+
+        if( ulFlMap == 0 )
+        {
+            return NULL;
+        }
+
+        xFl = heapTLSF_FFS( ulFlMap );
+        ulSlMap = ulSlBitmap[ xFl ];
+    }
+
+    xSl = heapTLSF_FFS( ulSlMap );
+    pxBlock = pxFreeLists[ xFl ][ xSl ];
+    prvRemoveFreeBlock( pxBlock );
+
+    return pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( TlsfBlock_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+{
+    BaseType_t xFl, xSl;
+
+    prvMappingInsert( pxBlock->xSize & ~heapTLSF_FLAGS_MASK, &xFl, &xSl );
+
+    pxBlock->pxPrevFree = NULL;
+    pxBlock->pxNextFree = pxFreeLists[ xFl ][ xSl ];
+
+    if( pxBlock->pxNextFree != NULL )
+    {
+        pxBlock->pxNextFree->pxPrevFree = pxBlock;
+    }
+
+    pxFreeLists[ xFl ][ xSl ] = pxBlock;
+    ulFlBitmap |= ( uint32_t ) 1 << xFl;
+    ulSlBitmap[ xFl ] |= ( uint32_t ) 1 << xSl;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( TlsfBlock_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+{
+    BaseType_t xFl, xSl;
+
+    prvMappingInsert( pxBlock->xSize & ~heapTLSF_FLAGS_MASK, &xFl, &xSl );
+
+    if( pxBlock->pxNextFree != NULL )
+    {
+        pxBlock->pxNextFree->pxPrevFree = pxBlock->pxPrevFree;
+    }
+
+    if( pxBlock->pxPrevFree != NULL )
+    {
+        pxBlock->pxPrevFree->pxNextFree = pxBlock->pxNextFree;
+    }
+    else
+    {
+        /* It was the head of the list. */
+        pxFreeLists[ xFl ][ xSl ] = pxBlock->pxNextFree;
+
+        if( pxFreeLists[ xFl ][ xSl ] == NULL )
+        {
+            ulSlBitmap[ xFl ] &= ~( ( uint32_t ) 1 << xSl );
+
+            if( ulSlBitmap[ xFl ] == 0 )
+            {
+                ulFlBitmap &= ~( ( uint32_t ) 1 << xFl );
+            }
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static TlsfBlock_t * prvNextPhysBlock( const TlsfBlock_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+{
+    return ( TlsfBlock_t * ) ( ( ( uint8_t * ) pxBlock ) + heapTLSF_HEADER_SIZE + ( pxBlock->xSize & ~heapTLSF_FLAGS_MASK ) );
+}
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_TLSF_CHECKS == 1 )
+
+    static void prvCheckHeap( void ) /* PRIVILEGED_FUNCTION */
+    {
+        TlsfBlock_t * pxBlock;
+        TlsfBlock_t * pxPrev = NULL;
+        size_t xFreeBytes = 0;
+        BaseType_t xFl, xSl, xFreeBlocks = 0, xListedBlocks = 0;
+
+        /* Physical chain: sizes aligned, flags consistent, no two free blocks
+         * next to each other and the chain ends at the last block. */
+        for( pxBlock = pxFirstBlock; pxBlock != pxLastBlock; pxBlock = prvNextPhysBlock( pxBlock ) )
+        {
+            configASSERT( pxBlock < pxLastBlock );
+            configASSERT( ( ( pxBlock->xSize & ~heapTLSF_FLAGS_MASK ) & portBYTE_ALIGNMENT_MASK ) == 0 );
+            configASSERT( ( pxBlock->xSize & ~heapTLSF_FLAGS_MASK ) >= heapTLSF_MIN_BLOCK_SIZE );
+
+            if( pxPrev != NULL )
+            {
+                configASSERT( ( ( pxBlock->xSize & heapTLSF_PREV_FREE_BIT ) != 0 ) == ( ( pxPrev->xSize & heapTLSF_FREE_BIT ) != 0 ) );
+
+                if( ( pxPrev->xSize & heapTLSF_FREE_BIT ) != 0 )
+                {
+                    configASSERT( ( pxBlock->xSize & heapTLSF_FREE_BIT ) == 0 );
+                    configASSERT( pxBlock->pxPrevPhysBlock == pxPrev );
+                }
+            }
+
+            if( ( pxBlock->xSize & heapTLSF_FREE_BIT ) != 0 )
+            {
+                xFreeBlocks++;
+                xFreeBytes += pxBlock->xSize & ~heapTLSF_FLAGS_MASK;
+            }
+
+            pxPrev = pxBlock;
+        }
+
+        configASSERT( ( ( pxLastBlock->xSize & heapTLSF_PREV_FREE_BIT ) != 0 ) == ( ( pxPrev->xSize & heapTLSF_FREE_BIT ) != 0 ) );
+        configASSERT( xFreeBytes == xFreeBytesRemaining );
+
+        /* Free lists: bitmaps match the heads, every block is free and sits
+         * in the list of its size. */
+        for( xFl = 0; xFl < heapTLSF_FL_COUNT; xFl++ )
+        {
+            configASSERT( ( ( ulFlBitmap & ( ( uint32_t ) 1 << xFl ) ) != 0 ) == ( ulSlBitmap[ xFl ] != 0 ) );
+
+            for( xSl = 0; xSl < heapTLSF_SL_COUNT; xSl++ )
+            {
+                BaseType_t xMapFl, xMapSl;
+
+                configASSERT( ( ( ulSlBitmap[ xFl ] & ( ( uint32_t ) 1 << xSl ) ) != 0 ) == ( pxFreeLists[ xFl ][ xSl ] != NULL ) );
+
+                for( pxBlock = pxFreeLists[ xFl ][ xSl ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFree )
+                {
+                    configASSERT( ( pxBlock->xSize & heapTLSF_FREE_BIT ) != 0 );
+                    configASSERT( ( pxBlock->pxNextFree == NULL ) || ( pxBlock->pxNextFree->pxPrevFree == pxBlock ) );
+                    prvMappingInsert( pxBlock->xSize & ~heapTLSF_FLAGS_MASK, &xMapFl, &xMapSl );
+                    configASSERT( ( xMapFl == xFl ) && ( xMapSl == xSl ) );
+                    xListedBlocks++;
+                }
+            }
+        }
+
+        configASSERT( xListedBlocks == xFreeBlocks );
+    }
+
+#endif /* configHEAP_TLSF_CHECKS */
+/*-----------------------------------------------------------*/